@@ -0,0 +1,143 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+#include <algorithm>
+
+/**
+ * 穴位索引：英文名、中文名、拼音三个键，穴位表加载完后建一次
+ *   精确查找：开放寻址哈希表（线性探测，槽数为键数 2 倍以上的 2 的幂），O(1)；
+ *             不同穴位键相同时保留穴位表中靠前的一个
+ *   前缀查找：按规范化键排序的数组，二分找到第一个不小于前缀的键后顺序扫描，供 /tcm 页面输入联想
+ * 规范化：ASCII 字母不分大小写，忽略空格、连字符、下划线与撇号（"zu san li" 与 "Zusanli" 相同），
+ * 其余字节（UTF-8 中文）原样比较，所以中文名也能按前几个字联想。
+ * 索引只保存穴位下标、字段号与哈希，字符串仍在穴位表里；穴位表改动后要重新 build()。
+ *
+ * 由 meridian_tcm.hpp 在 AcupointInfo 定义之后包含
+ */
+class AcupointIndex {
+public:
+  static const uint8_t FIELDS = 3; // 0 英文名，1 中文名，2 拼音
+
+  void build(const std::vector<AcupointInfo>& acupoints) {
+    aps_ = &acupoints;
+    entries_.clear();
+    for (size_t i = 0; i < acupoints.size(); i++) {
+      for (uint8_t f = 0; f < FIELDS; f++) {
+        const char* k = key(acupoints[i], f);
+        if (!*skip(k)) continue;
+        // 同一穴位的重复键（拼音与英文名规范化后相同）只收一次
+        bool dup = false;
+        for (uint8_t g = 0; g < f && !dup; g++) dup = compare(key(acupoints[i], g), k) == 0;
+        if (dup) continue;
+        Entry e = { hash(k), (uint16_t)i, f };
+        entries_.push_back(e);
+      }
+    }
+
+    std::sort(entries_.begin(), entries_.end(), [this](const Entry& a, const Entry& b) {
+      int d = compare(keyOf(a), keyOf(b));
+      return d != 0 ? d < 0 : a.acupoint < b.acupoint;
+    });
+
+    size_t cap = 16;
+    while (cap < entries_.size() * 2) cap <<= 1;
+    slots_.assign(cap, (uint16_t)EMPTY);
+    mask_ = cap - 1;
+    for (size_t e = 0; e < entries_.size(); e++) {
+      size_t s = entries_[e].hash & mask_;
+      bool taken = false;
+      while (slots_[s] != EMPTY && !taken) {
+        const Entry& o = entries_[slots_[s]];
+        taken = o.hash == entries_[e].hash && compare(keyOf(o), keyOf(entries_[e])) == 0;
+        s = (s + 1) & mask_;
+      }
+      if (!taken) slots_[s] = (uint16_t)e;
+    }
+    built_ = acupoints.size();
+  }
+
+  // 建索引时的穴位数：与穴位表不一致说明需要重建
+  size_t builtCount() const { return built_; }
+  size_t keyCount() const { return entries_.size(); }
+
+  // 精确查找，返回穴位下标，找不到返回 -1
+  int find(const char* q) const {
+    if (!q || slots_.empty()) return -1;
+    uint32_t h = hash(q);
+    for (size_t s = h & mask_; slots_[s] != EMPTY; s = (s + 1) & mask_) {
+      const Entry& e = entries_[slots_[s]];
+      if (e.hash == h && compare(keyOf(e), q) == 0) return e.acupoint;
+    }
+    return -1;
+  }
+
+  // 前缀查找：按键的字典序写入最多 max 个不重复的穴位下标，返回个数；空前缀不返回结果
+  uint8_t search(const char* prefix, uint16_t* out, uint8_t max) const {
+    if (!prefix || !*skip(prefix) || entries_.empty()) return 0;
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), prefix, [this](const Entry& e, const char* p) {
+      return compare(keyOf(e), p) < 0;
+    });
+    uint8_t n = 0;
+    for (; it != entries_.end() && n < max && compare(keyOf(*it), prefix, true) == 0; ++it) {
+      bool seen = false;
+      for (uint8_t i = 0; i < n && !seen; i++) seen = out[i] == it->acupoint;
+      if (!seen) out[n++] = it->acupoint;
+    }
+    return n;
+  }
+
+private:
+  struct Entry {
+    uint32_t hash;
+    uint16_t acupoint;
+    uint8_t field;
+  };
+
+  static const uint16_t EMPTY = 0xFFFF;
+
+  static const char* key(const AcupointInfo& ap, uint8_t field) {
+    const char* k = field == 0 ? ap.name : field == 1 ? ap.chineseName : ap.pinyin;
+    return k ? k : "";
+  }
+  const char* keyOf(const Entry& e) const { return key((*aps_)[e.acupoint], e.field); }
+
+  static bool ignorable(char c) { return c == ' ' || c == '-' || c == '_' || c == '\''; }
+  static const char* skip(const char* p) {
+    while (*p && ignorable(*p)) p++;
+    return p;
+  }
+  static uint8_t fold(char c) {
+    uint8_t u = (uint8_t)c;
+    return (u >= 'A' && u <= 'Z') ? (uint8_t)(u + 32) : u;
+  }
+
+  // 规范化后比较；prefix 为 true 时 b 走完即视为相等（a 以 b 开头）
+  static int compare(const char* a, const char* b, bool prefix = false) {
+    for (;;) {
+      a = skip(a);
+      b = skip(b);
+      if (!*b) return (prefix || !*a) ? 0 : 1;
+      if (!*a) return -1;
+      int d = (int)fold(*a) - (int)fold(*b);
+      if (d) return d;
+      a++;
+      b++;
+    }
+  }
+
+  // 规范化后的 FNV-1a
+  static uint32_t hash(const char* p) {
+    uint32_t h = 2166136261u;
+    for (p = skip(p); *p; p = skip(p + 1)) {
+      h ^= fold(*p);
+      h *= 16777619u;
+    }
+    return h;
+  }
+
+  const std::vector<AcupointInfo>* aps_ = nullptr;
+  std::vector<Entry> entries_;   // 按规范化键排序
+  std::vector<uint16_t> slots_;  // 哈希槽：entries_ 下标，EMPTY 为空
+  size_t mask_ = 0;
+  size_t built_ = 0;
+};
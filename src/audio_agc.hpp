@@ -0,0 +1,142 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * 直流偏置跟踪
+ * MAX9814 的输出偏置随供电和温度漂移，固定减 2048 会在频谱低端留下直流泄漏、抬高音量读数。
+ * 这里用一阶低通（时间常数 2^SHIFT 个样本，8kHz 下约 0.26s；开始的 128ms 内为 8ms）估计偏置，Q12 定点，每样本两次加减一次移位。
+ */
+class DcTracker {
+public:
+  static const uint8_t SHIFT = 11;
+  static const uint8_t WARMUP_SHIFT = 6;      // 开始的 WARMUP 个样本用更快的系数，尽快追上实际偏置
+  static const uint16_t WARMUP = 1024;
+  static const int32_t NOMINAL = 2048; // 12位ADC中点，作为初值
+
+  void reset() { dcQ12_ = NOMINAL << 12; warmup_ = WARMUP; }
+
+  int16_t process(int16_t raw) {
+    int32_t x = (int32_t)raw << 12;
+    if (warmup_) {
+      warmup_--;
+      dcQ12_ += (x - dcQ12_) >> WARMUP_SHIFT;
+    } else {
+      dcQ12_ += (x - dcQ12_) >> SHIFT;
+    }
+    int32_t s = (int32_t)raw - ((dcQ12_ + (1 << 11)) >> 12);
+    if (s > 32767) s = 32767;
+    if (s < -32768) s = -32768;
+    return (int16_t)s;
+  }
+
+  float offset() const { return (float)dcQ12_ / 4096.0f; } // 当前偏置（ADC计数）
+
+private:
+  int32_t dcQ12_ = NOMINAL << 12;
+  uint16_t warmup_ = WARMUP;
+};
+
+/**
+ * 自动增益与底噪（定点）
+ * 每个通道（总电平、低/中/高、N 段频谱）各自跟踪底噪：输入低于底噪时快速下降，高于时缓慢上升，
+ * 因此底噪停在安静间隙的水平。比底噪高 12dB 以上的输入视为信号，底噪几乎不动（约 2 分钟），
+ * 开机时就在播放的音乐不会被当成底噪；接近底噪的嗡声（风扇、工频）约 15s 并入底噪。
+ * 输出 = (输入 − 1.25×底噪) × 增益 × 灵敏度，限幅到 1.0。
+ *
+ * 增益只由总电平决定，所有通道共用：把减去底噪后的电平拉到 TARGET。
+ * 声音变大时快速降低增益（约 50ms，不削顶），变小时缓慢提高（约 4s，不随乐句间隙起伏），
+ * 且只有信号高出底噪约 7dB 时才提高，安静时保持不变，不会把底噪放大到满幅。
+ *
+ * 数值均为 Q16（1.0 = 65536），底噪内部多留 8 位小数（Q24），增益内部为 Q16；
+ * 时间常数在 configure() 中按帧率换算成 Q16 系数，每帧只做整数运算。
+ */
+class AutoGain {
+public:
+  enum Channel : uint8_t { CH_LEVEL, CH_LOW, CH_MID, CH_HIGH, CH_BAND0, CHANNELS = CH_BAND0 + 32 };
+
+  static const uint32_t ONE = 65536;                 // Q16 的 1.0
+  static const uint32_t TARGET = ONE * 6 / 10;       // 减去底噪后的电平目标
+  static const uint32_t GAIN_MIN = ONE / 4;          // -12dB
+  static const uint32_t GAIN_MAX = ONE * 64;         // +36dB
+  static const uint32_t INPUT_MAX = ONE * 8;         // 单通道输入上限，防止纯音把频段值推得过高
+  static const uint32_t FLOOR_INIT = ONE / 500;      // 底噪初值（约 -54dB），安静环境在一秒内落到实际水平
+
+  AutoGain() { resetFloors(); }
+
+  // 按每秒分析帧数换算时间常数
+  void configure(float frameHz) {
+    floorFall_ = alphaQ16(0.2f, frameHz);
+    floorRise_ = alphaQ16(15.0f, frameHz);
+    floorCreep_ = alphaQ16(120.0f, frameHz);
+    gainDown_ = alphaQ16(0.05f, frameHz);
+    gainUp_ = alphaQ16(4.0f, frameHz);
+  }
+
+  // 底噪回到初值，增益保留
+  void resetFloors(uint8_t first = 0, uint8_t count = CHANNELS) {
+    for (uint8_t c = first; c < first + count && c < CHANNELS; c++) floorQ24_[c] = FLOOR_INIT << 8;
+  }
+
+  void setEnabled(bool on) { enabled_ = on; }
+  bool enabled() const { return enabled_; }
+
+  // 用户灵敏度作为增益之后的微调（Q8）
+  void setTrim(float sensitivity) { trimQ8_ = (uint32_t)(sensitivity * 256.0f + 0.5f); }
+
+  /**
+   * 总电平：更新电平通道底噪与全局增益，返回归一化电平（Q16）
+   * 需在同一帧的其它通道之前调用
+   */
+  uint32_t level(uint32_t x) {
+    uint32_t above = track(CH_LEVEL, x);
+    uint64_t want = GAIN_MAX;
+    if (above) want = ((uint64_t)TARGET << 16) / above;
+    if (want < GAIN_MIN) want = GAIN_MIN;
+    if (want > GAIN_MAX) want = GAIN_MAX;
+    if (want < gainQ16_) {
+      gainQ16_ -= (uint32_t)(((gainQ16_ - want) * gainDown_) >> 16);
+    } else if (above > floorOf(CH_LEVEL)) {
+      gainQ16_ += (uint32_t)(((want - gainQ16_) * gainUp_) >> 16);
+    }
+    return scale(x, above);
+  }
+
+  // 其它通道：更新底噪并按当前增益归一化（Q16）
+  uint32_t channel(uint8_t ch, uint32_t x) { return scale(x, track(ch, x)); }
+
+  uint32_t gainQ16() const { return gainQ16_; }
+  uint32_t floorOf(uint8_t ch) const { return ch < CHANNELS ? floorQ24_[ch] >> 8 : 0; }
+
+private:
+  static uint32_t alphaQ16(float tauS, float frameHz) {
+    float a = 1.0f - expf(-1.0f / (tauS * frameHz));
+    uint32_t q = (uint32_t)(a * (float)ONE + 0.5f);
+    return q ? q : 1;
+  }
+
+  // 更新底噪，返回高出 1.25 倍底噪的部分
+  uint32_t track(uint8_t ch, uint32_t& x) {
+    if (x > INPUT_MAX) x = INPUT_MAX;
+    uint32_t xQ24 = x << 8;
+    uint32_t& f = floorQ24_[ch];
+    if (xQ24 < f) f -= (uint32_t)(((uint64_t)(f - xQ24) * floorFall_) >> 16);
+    else f += (uint32_t)(((uint64_t)(xQ24 - f) * (xQ24 > f * 4 ? floorCreep_ : floorRise_)) >> 16);
+    uint32_t fl = f >> 8;
+    fl += fl >> 2;
+    return x > fl ? x - fl : 0;
+  }
+
+  uint32_t scale(uint32_t x, uint32_t above) const {
+    uint64_t v = enabled_ ? ((uint64_t)above * gainQ16_) >> 16 : x;
+    v = (v * trimQ8_) >> 8;
+    if (v > ONE) v = ONE;
+    return (uint32_t)v;
+  }
+
+  uint32_t floorQ24_[CHANNELS];
+  uint32_t gainQ16_ = ONE;
+  uint32_t trimQ8_ = 256;
+  uint32_t floorFall_ = 1, floorRise_ = 1, floorCreep_ = 1, gainDown_ = 1, gainUp_ = 1;
+  bool enabled_ = true;
+};
@@ -0,0 +1,297 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "sample_source.hpp"
+#include "spsc_ring.hpp"
+#include "wav_file.hpp"
+
+/**
+ * 录音回放采样源：从 WAV 文件（见 wav_file.hpp）读取样本
+ * 实时模式按采样率限速，与麦克风的节奏一致；最快模式每次都填满请求，用于基准测试
+ */
+class ReplaySource : public SampleSource {
+public:
+  bool open(const char* path) {
+    close();
+    if (!file_.open(path, false)) return false;
+    if (!wav::readHeader(file_, info_) || info_.sampleRate == 0) {
+      file_.close();
+      return false;
+    }
+    remaining_ = info_.samples;
+    return true;
+  }
+
+  void close() { file_.close(); finished_ = false; }
+  bool isOpen() const { return file_.isOpen(); }
+
+  void setRealtime(bool realtime) { realtime_ = realtime; }
+  void setLoop(bool loop) { loop_ = loop; }
+
+  bool begin() override {
+    if (!file_.isOpen()) return false;
+    rewind();
+    finished_ = false;
+    delivered_ = 0;
+    loops_ = 0;
+    budget_ = 0;
+    lastUs_ = micros();
+    return true;
+  }
+
+  size_t read(int16_t* dst, size_t maxCount) override {
+    if (!file_.isOpen() || finished_) return 0;
+
+    if (realtime_) {
+      // 以“样本数 × 1e6”为单位累计可读额度，暂停后最多补 100ms，避免一次性涌入
+      uint32_t now = micros();
+      budget_ += (uint64_t)(now - lastUs_) * info_.sampleRate;
+      lastUs_ = now;
+      const uint64_t cap = (uint64_t)info_.sampleRate * 100000u;
+      if (budget_ > cap) budget_ = cap;
+      size_t allowed = (size_t)(budget_ / 1000000u);
+      if (maxCount > allowed) maxCount = allowed;
+      budget_ -= (uint64_t)maxCount * 1000000u;
+    }
+
+    // 文件为小端 16 位样本，与 ESP32 / x86 内存布局一致，直接读入
+    size_t got = 0;
+    bool rewound = false;
+    while (got < maxCount) {
+      if (remaining_ == 0) {
+        if (!loop_) { finished_ = true; break; }
+        if (rewound) break; // 空文件
+        rewind();
+        rewound = true;
+        loops_++;
+        continue;
+      }
+      size_t want = maxCount - got;
+      if (want > remaining_) want = remaining_;
+      size_t n = file_.read(dst + got, want * 2) / 2;
+      if (n == 0) { remaining_ = 0; continue; } // 文件比头里声明的短
+      rewound = false;
+      got += n;
+      remaining_ -= (uint32_t)n;
+      delivered_ += (uint32_t)n;
+    }
+    return got;
+  }
+
+  uint32_t sampleRate() const override { return info_.sampleRate; }
+  const char* name() const override { return "replay"; }
+
+  bool finished() const { return finished_; }
+  uint32_t delivered() const { return delivered_; } // 已读出的样本数
+  uint32_t loops() const { return loops_; }
+  uint32_t samples() const { return info_.samples; }
+
+private:
+  void rewind() {
+    file_.seek(info_.dataOffset);
+    remaining_ = info_.samples;
+  }
+
+  AudioFile file_;
+  wav::Info info_;
+  uint32_t remaining_ = 0;
+  uint32_t delivered_ = 0;
+  uint32_t loops_ = 0;
+  bool realtime_ = true;
+  bool loop_ = false;
+  bool finished_ = false;
+  uint64_t budget_ = 0;
+  uint32_t lastUs_ = 0;
+};
+
+/**
+ * 录音/回放开关采样源
+ * 包在实时采样源外面装进分析器：
+ *  - 录音：把分析器读到的样本原样复制进 SPSC 环形缓冲区，由 loop() 中的 service() 写入文件，
+ *    分析任务不直接碰 SPIFFS
+ *  - 回放：用 ReplaySource 替换实时样本（期间实时样本照常取走并丢弃，防止积压），
+ *    切换请求经邮箱交给分析任务，在下一次 read() 中生效
+ * 控制侧接口在 loop/网页中调用，read() 属于分析任务
+ */
+class CaptureSource : public SampleSource {
+public:
+  static const uint16_t RING_SIZE = 2048; // 8kHz 下约 256ms，覆盖 SPIFFS 写入的停顿
+
+  // 包装已经 begin() 过的实时采样源
+  void attach(SampleSource* live) { live_ = live; }
+
+  bool begin() override { return live_ != nullptr; }
+  uint32_t sampleRate() const override { return live_ ? live_->sampleRate() : 0; }
+  uint32_t dropped() const override { return live_ ? live_->dropped() : 0; }
+
+  // 回放时采样率以文件头为准（录音时写入的是实测值），时序统计仍来自实时源
+  float measuredRate() const override {
+    if (replaying()) return (float)replayRate_.load(std::memory_order_relaxed);
+    return live_ ? live_->measuredRate() : 0.0f;
+  }
+  bool timing(SamplerStats& out) const override { return live_ && live_->timing(out); }
+  const char* name() const override {
+    if (replaying()) return "replay";
+    return live_ ? live_->name() : "none";
+  }
+
+  // ---------- 控制侧 ----------
+
+  // 开始录音，最多 maxSamples 个样本；录满后由 service() 自动收尾
+  bool startRecording(const char* path, uint32_t maxSamples) {
+    stopRecording();
+    if (!live_ || maxSamples == 0) return false;
+    if (!recFile_.open(path, true)) return false;
+    // 文件头写实测采样率（取整），回放与主机端分析按实际频率换算
+    rate_ = (uint32_t)(live_->measuredRate() + 0.5f);
+    if (!wav::writeHeader(recFile_, rate_, 0)) {
+      recFile_.close();
+      return false;
+    }
+    int16_t scratch[128];
+    while (ring_.pop(scratch, 128) > 0) {} // 丢掉上一次停止后残留的样本
+    recorded_ = 0;
+    ringDropBase_ = ring_.dropped();
+    recording_ = true;
+    recordLeft_.store(maxSamples, std::memory_order_release);
+    return true;
+  }
+
+  // 立即停止：写完缓冲区中剩余样本并回写 WAV 头
+  void stopRecording() {
+    recordLeft_.store(0, std::memory_order_release);
+    if (!recording_) return;
+    drainToFile();
+    wav::writeHeader(recFile_, rate_, recorded_);
+    recFile_.close();
+    recording_ = false;
+  }
+
+  // 在 loop() 中周期调用
+  void service() {
+    if (!recording_) return;
+    drainToFile();
+    if (recordLeft_.load(std::memory_order_acquire) == 0 && ring_.available() == 0) stopRecording();
+  }
+
+  bool recording() const { return recording_; }
+  uint32_t recordedSamples() const { return recorded_; }
+  uint32_t recordDropped() const { return ring_.dropped() - ringDropBase_; } // 写文件不及时丢掉的样本
+
+  // 切换到文件回放；上一个切换请求尚未被分析任务处理时返回 false
+  bool startReplay(const char* path, bool realtime, bool loop) {
+    if (request_.load(std::memory_order_acquire) != REQ_NONE) return false;
+    strncpy(replayPath_, path, sizeof(replayPath_) - 1);
+    replayPath_[sizeof(replayPath_) - 1] = '\0';
+    replayRealtime_ = realtime;
+    replayLoop_ = loop;
+    request_.store(REQ_REPLAY, std::memory_order_release);
+    return true;
+  }
+
+  bool stopReplay() {
+    if (request_.load(std::memory_order_acquire) != REQ_NONE) return false;
+    request_.store(REQ_LIVE, std::memory_order_release);
+    return true;
+  }
+
+  bool replaying() const { return replayState_.load(std::memory_order_acquire) == STATE_REPLAY; }
+  bool replayFinished() const { return replayState_.load(std::memory_order_acquire) == STATE_FINISHED; }
+  bool replayFailed() const { return replayState_.load(std::memory_order_acquire) == STATE_FAILED; }
+  bool requestPending() const { return request_.load(std::memory_order_acquire) != REQ_NONE; }
+
+  // ---------- 分析侧 ----------
+
+  size_t read(int16_t* dst, size_t maxCount) override {
+    applyRequest();
+
+    size_t n;
+    if (replay_.isOpen()) {
+      // 实时样本照常取走，回到实时模式时没有积压；合成源与最快模式的回放源总有数据，
+      // 每次最多丢弃 RING_SIZE 个，免得分析任务卡在这里
+      int16_t scratch[64];
+      size_t drained = 0;
+      while (drained < RING_SIZE) {
+        size_t got = live_->read(scratch, 64);
+        if (got == 0) break;
+        drained += got;
+      }
+      n = replay_.read(dst, maxCount);
+      if (replay_.finished()) {
+        // 非循环回放结束后自动回到实时输入
+        replay_.close();
+        replayState_.store(STATE_FINISHED, std::memory_order_release);
+      }
+    } else {
+      n = live_->read(dst, maxCount);
+    }
+
+    uint32_t left = recordLeft_.load(std::memory_order_acquire);
+    if (n > 0 && left > 0) {
+      uint32_t take = n < left ? (uint32_t)n : left;
+      // 控制侧可能同时停止录音，CAS 失败说明已停止，不再写入
+      if (recordLeft_.compare_exchange_strong(left, left - take, std::memory_order_acq_rel)) {
+        ring_.push(dst, take);
+      }
+    }
+    return n;
+  }
+
+private:
+  enum Request : uint8_t { REQ_NONE, REQ_REPLAY, REQ_LIVE };
+  enum State : uint8_t { STATE_LIVE, STATE_REPLAY, STATE_FINISHED, STATE_FAILED };
+
+  void applyRequest() {
+    uint8_t req = request_.load(std::memory_order_acquire);
+    if (req == REQ_NONE) return;
+    replay_.close();
+    uint8_t state = STATE_LIVE;
+    if (req == REQ_REPLAY) {
+      // 回放文件的采样率须与实时源的标称值相差 5% 以内，分析器按文件头的采样率换算频率
+      if (replay_.open(replayPath_) && rateCompatible(replay_.sampleRate(), live_->sampleRate())) {
+        replayRate_.store(replay_.sampleRate(), std::memory_order_relaxed);
+        replay_.setRealtime(replayRealtime_);
+        replay_.setLoop(replayLoop_);
+        replay_.begin();
+        state = STATE_REPLAY;
+      } else {
+        replay_.close();
+        state = STATE_FAILED;
+      }
+    }
+    replayState_.store(state, std::memory_order_release);
+    request_.store(REQ_NONE, std::memory_order_release);
+  }
+
+  static bool rateCompatible(uint32_t file, uint32_t nominal) {
+    return (uint64_t)file * 20 >= (uint64_t)nominal * 19 && (uint64_t)file * 20 <= (uint64_t)nominal * 21;
+  }
+
+  void drainToFile() {
+    int16_t buf[256];
+    size_t n;
+    while ((n = ring_.pop(buf, 256)) > 0) {
+      recorded_ += (uint32_t)(recFile_.write(buf, n * 2) / 2);
+    }
+  }
+
+  SampleSource* live_ = nullptr;
+
+  // 录音：分析任务写环形缓冲区，控制侧写文件
+  SpscRing<int16_t, RING_SIZE> ring_;
+  std::atomic<uint32_t> recordLeft_{0};
+  AudioFile recFile_;
+  bool recording_ = false;
+  uint32_t rate_ = 0;
+  uint32_t recorded_ = 0;
+  uint32_t ringDropBase_ = 0;
+
+  // 回放：控制侧填好参数后置请求，分析任务打开文件并清除请求
+  ReplaySource replay_;
+  std::atomic<uint8_t> request_{REQ_NONE};
+  std::atomic<uint8_t> replayState_{STATE_LIVE};
+  std::atomic<uint32_t> replayRate_{0};
+  char replayPath_[48] = {};
+  bool replayRealtime_ = true;
+  bool replayLoop_ = false;
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+
+/**
+ * 音频特征快照
+ * 分析任务每处理完一批样本发布一次，渲染/网页/按钮等其它任务只读取快照，
+ * 不直接访问分析器内部状态。
+ */
+struct AudioFeatures {
+  static const uint8_t MAX_BANDS = 32;
+
+  // 特征需求位：消费者声明自己读取哪些字段，分析器只计算被需要的部分
+  enum Feature : uint8_t {
+    FEAT_LEVEL = 1 << 0,    // level（由增量平方和得到，几乎无开销）
+    FEAT_BANDS = 1 << 1,    // low / mid / high（需要 FFT）
+    FEAT_SPECTRUM = 1 << 2, // N 段频谱 bands[]（需要 FFT）
+    FEAT_ONSET = 1 << 3,    // 起音与节拍 beatCount / beatPhase / bpm（需要 FFT）
+    FEAT_PITCH = 1 << 4,    // pitchHz / pitchConf（时域音高估计）
+    FEAT_CHROMA = 1 << 5,   // 12 音级色度、主音与调性（需要 FFT）
+    FEAT_ALL = 0x3F
+  };
+
+  // 可跳过的分析阶段
+  enum Stage : uint8_t { STAGE_FFT, STAGE_BANDS, STAGE_SPECTRUM, STAGE_ONSET, STAGE_PITCH, STAGE_CHROMA, STAGE_COUNT };
+  static const char* stageName(uint8_t s) {
+    static const char* const names[STAGE_COUNT] = {"fft", "bands", "spectrum", "onset", "pitch", "chroma"};
+    return s < STAGE_COUNT ? names[s] : "?";
+  }
+
+  float level = 0.0f;            // 平滑后的RMS，经底噪扣除与自动增益，0..1
+  float low = 0.0f, mid = 0.0f, high = 0.0f;
+  float pitchHz = 0.0f;          // 0 表示未检测到
+  float pitchConf = 0.0f;
+
+  uint8_t bandCount = 0;
+  uint8_t bands[MAX_BANDS] = {}; // N 段频谱 0..255
+
+  uint32_t beatCount = 0;        // 节拍计数，消费者比较前后两次的值判断是否到达节拍
+  float beatPhase = 1.0f;        // 当前节拍内相位 0..1
+  float bpm = 0.0f;              // 未锁定时为 0
+
+  uint8_t chroma[12] = {};       // 12 音级强度（C=0 … B=11），最强约 255
+  int8_t note = -1;              // 主音音级 0..11，-1 表示安静或不确定（带迟滞，不随和弦内部起伏跳动）
+  float noteConf = 0.0f;
+  int8_t key = -1;               // 调性：0..11 为 C..B 大调，12..23 为小调，-1 表示尚未确定
+  float keyConf = 0.0f;
+
+  uint32_t pitchHits = 0;        // 目标音命中计数（Goertzel）
+  float pitchHitConf = 0.0f;     // 最近一次命中的置信度
+
+  // 自动增益（见 audio_agc.hpp），用于现场调试
+  bool agc = true;               // 是否启用；关闭时电平与频段只乘灵敏度
+  float agcGain = 1.0f;          // 当前增益（线性倍数）
+  float noiseFloor = 0.0f;       // 总电平底噪，满量程RMS为 1.0
+  float dcOffset = 0.0f;         // 跟踪到的直流偏置（ADC计数）
+  uint8_t bandFloor[MAX_BANDS] = {}; // N 段频谱各段底噪，与 bands[] 同量纲（增益之前）
+
+  float sampleRate = 0.0f;       // 分析器换算频率所用的采样率（跟随采样源实测值）
+
+  uint8_t demand = 0;            // 本快照计算了哪些特征（未计算的字段为 0）
+  uint32_t frames = 0;           // 已分析的帧数
+  uint32_t skipped[STAGE_COUNT] = {}; // 各阶段因无人需要而跳过的累计次数
+  uint32_t timestampUs = 0;      // 发布时刻 micros()
+
+  static const char* noteName(int8_t n) {
+    static const char* const names[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+    return (n >= 0 && n < 12) ? names[n] : "-";
+  }
+
+  static const char* keyName(int8_t k) {
+    static const char* const minor[12] = {"Cm", "C#m", "Dm", "D#m", "Em", "Fm", "F#m", "Gm", "G#m", "Am", "A#m", "Bm"};
+    if (k >= 12 && k < 24) return minor[k - 12];
+    return noteName(k);
+  }
+
+  // 音高到长度映射（对数刻度）
+  uint16_t mapPitchToLen(float minHz, float maxHz, float scale, uint16_t maxLen) const {
+    if (pitchHz <= 0 || maxHz <= minHz) return 0;
+    float num = logf(pitchHz / minHz) / logf(2.0f);
+    float den = logf(maxHz / minHz) / logf(2.0f);
+    float norm = (den > 0) ? (num / den) : 0.0f;
+    if (norm < 0) norm = 0;
+    if (norm > 1) norm = 1;
+    float s = scale;
+    if (s < 0.1f) s = 0.1f;
+    if (s > 2.0f) s = 2.0f;
+    float v = norm * s;
+    if (v > 1.0f) v = 1.0f;
+    return (uint16_t)(v * (float)maxLen + 0.5f);
+  }
+};
+
+/**
+ * 单写者双缓冲 seqlock
+ * 写者交替写两个槽：先登记“开始写第 n 次”，写完槽后再把已发布序号置为 n。
+ * 读者拷贝最新槽后检查写者是否已开始写下下次（会覆盖同一个槽），
+ * 因此只有写者在一次拷贝内发布两次以上时读者才需要重试；读者从不阻塞写者，也不需要锁。
+ */
+template <typename T>
+class SeqlockSnapshot {
+public:
+  // 写者调用（只能有一个写者）
+  void publish(const T& value) {
+    uint32_t next = seq_.load(std::memory_order_relaxed) + 1;
+    begun_.store(next, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slots_[next & 1] = value;
+    seq_.store(next, std::memory_order_release);
+  }
+
+  // 读者调用：返回 false 表示尚未发布过
+  bool read(T& out) const {
+    for (;;) {
+      uint32_t s1 = seq_.load(std::memory_order_acquire);
+      if (s1 == 0) return false;
+      out = slots_[s1 & 1];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      uint32_t b = begun_.load(std::memory_order_relaxed);
+      if (b - s1 < 2) return true; // 写者尚未开始覆盖被读的槽
+    }
+  }
+
+  // 已发布次数，可用于判断是否有新快照
+  uint32_t sequence() const { return seq_.load(std::memory_order_acquire); }
+
+private:
+  std::atomic<uint32_t> begun_{0};
+  std::atomic<uint32_t> seq_{0};
+  T slots_[2];
+};
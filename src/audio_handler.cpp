@@ -9,8 +9,12 @@ void updateAudioLog() {
 
   if (now - lastAudioLogAt >= 500) {
     lastAudioLogAt = now;
-    Serial.printf("audio level=%.3f low=%.3f mid=%.3f high=%.3f en=%d mode=%s\n",
-                  analyzer.level(), analyzer.low(), analyzer.mid(), analyzer.high(),
+    AudioFeatures f;
+    analyzer.readFeatures(f);
+    // 未被需求的特征不计算，对应字段为 0（demand 为 AudioFeatures::FEAT_* 位）
+    Serial.printf("audio level=%.3f low=%.3f mid=%.3f high=%.3f gain=%.2f floor=%.4f note=%s key=%s demand=0x%02x en=%d mode=%s\n",
+                  f.level, f.low, f.mid, f.high, f.agcGain, f.noiseFloor,
+                  AudioFeatures::noteName(f.note), AudioFeatures::keyName(f.key), (unsigned)f.demand,
                   controller.audioEnabled()?1:0, audioModeNames[currentAudioMode]);
   }
 }
@@ -21,10 +25,14 @@ void handleAudioEffects() {
     controller.setAudioMode(static_cast<AudioVisualizer::EffectType>(currentAudioMode));
   }
 
-  // 音高到长度映射
-  if (controller.audioEnabled() && gPitchMapEnable) {
+  // 音高到长度映射：只有启用时才需要分析器估计音高
+  bool pitchMap = controller.audioEnabled() && gPitchMapEnable;
+  analyzer.setDemand(OptimizedAudioAnalyzer::CONSUMER_PITCH_MAP, pitchMap ? AudioFeatures::FEAT_PITCH : 0);
+  if (pitchMap) {
+    AudioFeatures f;
+    analyzer.readFeatures(f);
     controller.setExternalLenEnabled(true);
-    controller.setExternalLen(analyzer.mapPitchToLen(gPitchMapMinHz, gPitchMapMaxHz, gPitchMapScale, LED_COUNT));
+    controller.setExternalLen(f.mapPitchToLen(gPitchMapMinHz, gPitchMapMaxHz, gPitchMapScale, LED_COUNT));
   } else {
     controller.setExternalLenEnabled(false);
   }
@@ -39,25 +47,23 @@ void handlePitchDetection() {
     gPitchPointActive = false;
   }
 
-  if (!gPitchArmed) return;
-  
-  float hz = analyzer.pitchHz();        // 获取当前音高（Hz）
-  float conf = analyzer.pitchConf();    // 获取音高置信度（0-1）
-  
-  // 检查是否满足音高检测条件
-  if (hz > 0 && conf >= gPitchConfThresh && (now - gPitchLastHit) > gPitchCooldownMs) {
-    // 计算音分差异（1200音分 = 1个八度）
-    float cents = 1200.0f * log(hz / gPitchTargetHz) / log(2.0f);
-    if (cents < 0) cents = -cents;  // 取绝对值，只关心差异大小
-    
-    // 如果在容差范围内
-    if (cents <= gPitchTolCents) {
-      gPitchLastHit = now;  // 更新上次呼应时间
-      
-      // 视觉反馈：在当前索引位置设置绿色点，并记录命中时间，短暂显示后自动熄灭
-      controller.point().setPoint(stepIndex, (0u<<16)|(255u<<8)|0u);  // RGB格式：绿色
-      gPitchPointActive = true;
-      gPitchPointLastOn = now;
-    }
+  // 目标音命中事件来自分析器中的 Goertzel 滤波器组（已按目标音和容差调谐），
+  // 快照中的命中计数增加即表示输入落在容差之内，这里只需检查置信度与冷却时间。
+  // 未布防时也同步计数，避免布防瞬间把旧命中当成新命中
+  static uint32_t seenHits = 0;
+  AudioFeatures f;
+  analyzer.readFeatures(f);
+  bool fresh = f.pitchHits != seenHits;
+  seenHits = f.pitchHits;
+
+  if (!gPitchArmed || !fresh) return;
+
+  if (f.pitchHitConf >= gPitchConfThresh && (now - gPitchLastHit) > gPitchCooldownMs) {
+    gPitchLastHit = now;  // 更新上次呼应时间
+
+    // 视觉反馈：在当前索引位置设置绿色点，并记录命中时间，短暂显示后自动熄灭
+    controller.point().setPoint(stepIndex, (0u<<16)|(255u<<8)|0u);  // RGB格式：绿色
+    gPitchPointActive = true;
+    gPitchPointLastOn = now;
   }
 }
@@ -58,10 +58,9 @@ void handleAudioEffects();
  * 
  * 工作流程：
  * 1. 检查音高检测是否启用
- * 2. 获取当前音高和置信度
- * 3. 检查是否满足触发条件（音高有效、置信度足够、超过冷却时间）
- * 4. 计算音高差异（以音分为单位）
- * 5. 如果差异在容差范围内，触发视觉反馈
+ * 2. 取走分析器中 Goertzel 滤波器组产生的目标音命中事件（已按容差判定）
+ * 3. 检查是否满足触发条件（置信度足够、超过冷却时间）
+ * 4. 触发视觉反馈
  * 
  * 音分(cents)是音乐中的小单位，1个半音等于100音分
  */
@@ -0,0 +1,83 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "optimized_audio.hpp"
+
+/**
+ * 音频分析任务
+ * 在独立的 FreeRTOS 任务中按固定周期调用 analyzer.tick()，采样与分析不再受
+ * loop() 中网页请求和灯带刷新的影响；渲染侧通过 analyzer.readFeatures() 读取快照。
+ *
+ * 每个周期最多连续分析 MAX_CATCHUP 帧来追赶积压的样本；
+ * 单周期耗时超过周期长度或追赶次数用尽都计为一次超时。
+ */
+class AudioTask {
+public:
+  static const uint8_t MAX_CATCHUP = 4;
+
+  explicit AudioTask(OptimizedAudioAnalyzer& analyzer) : analyzer_(analyzer) {}
+
+  // 优先级高于 loop()（1），低于 ADC 读取任务（5）
+  bool begin(uint32_t periodMs = 4, UBaseType_t priority = 3, uint32_t stackBytes = 6144) {
+    if (task_) return true;
+    periodMs_ = periodMs ? periodMs : 1;
+    if (xTaskCreate(taskEntry, "audio", stackBytes, this, priority, &task_) != pdPASS) {
+      task_ = nullptr;
+      Serial.println("音频分析任务创建失败");
+      return false;
+    }
+    Serial.printf("音频分析任务已启动: 周期 %u ms\n", (unsigned)periodMs_);
+    return true;
+  }
+
+  // 不需要音频功能时暂停分析：任务仍按周期唤醒，只取走并丢弃新样本，
+  // 采样源不会积压过期音频（恢复时第一帧就是新的），也不会把暂停期间计为丢样
+  void setActive(bool on) { active_.store(on, std::memory_order_relaxed); }
+  bool active() const { return active_.load(std::memory_order_relaxed); }
+
+  uint32_t periodMs() const { return periodMs_; }
+  uint32_t cycles() const { return cycles_.load(std::memory_order_relaxed); }      // 活动周期数
+  uint32_t overruns() const { return overruns_.load(std::memory_order_relaxed); }  // 超时周期数
+  uint32_t lastCycleUs() const { return lastUs_.load(std::memory_order_relaxed); }
+  uint32_t maxCycleUs() const { return maxUs_.load(std::memory_order_relaxed); }
+  void resetMax() { maxUs_.store(0, std::memory_order_relaxed); }
+
+private:
+  static void taskEntry(void* arg) { static_cast<AudioTask*>(arg)->run(); }
+
+  void run() {
+    const TickType_t period = pdMS_TO_TICKS(periodMs_) ? pdMS_TO_TICKS(periodMs_) : 1;
+    const uint32_t periodUs = periodMs_ * 1000;
+    TickType_t wake = xTaskGetTickCount();
+    for (;;) {
+      vTaskDelayUntil(&wake, period);
+      if (!active_.load(std::memory_order_relaxed)) {
+        analyzer_.discardInput();
+        continue;
+      }
+
+      uint32_t t0 = micros();
+      uint8_t n = 0;
+      while (n < MAX_CATCHUP && analyzer_.tick()) n++;
+      uint32_t dt = micros() - t0;
+
+      lastUs_.store(dt, std::memory_order_relaxed);
+      if (dt > maxUs_.load(std::memory_order_relaxed)) maxUs_.store(dt, std::memory_order_relaxed);
+      cycles_.store(cycles_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      if (dt > periodUs || n == MAX_CATCHUP) {
+        overruns_.store(overruns_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  OptimizedAudioAnalyzer& analyzer_;
+  TaskHandle_t task_ = nullptr;
+  uint32_t periodMs_ = 4;
+  std::atomic<bool> active_{false};
+
+  // 统计值只由分析任务写入，其它任务读取
+  std::atomic<uint32_t> cycles_{0};
+  std::atomic<uint32_t> overruns_{0};
+  std::atomic<uint32_t> lastUs_{0};
+  std::atomic<uint32_t> maxUs_{0};
+};
@@ -2,42 +2,45 @@
 #include <Arduino.h>
 #include <FastLED.h>
 #include "optimized_audio.hpp"
+#include "led_palette.hpp"
 
 /**
  * 音频可视化效果基类
+ * 渲染只读取分析任务发布的特征快照；需要调整分析参数（频谱段数、起音阈值）的效果
+ * 在 configure() 中通过分析器的控制接口提出，参数在分析任务的下一次 tick 生效
+ * features() 声明效果读取的特征，分析器据此跳过无人使用的阶段
  */
 class AudioEffect {
 public:
   virtual ~AudioEffect() {}
-  virtual void render(CRGB* leds, int numLeds, OptimizedAudioAnalyzer& analyzer) = 0;
+  virtual uint8_t features() const = 0;
+  virtual void configure(OptimizedAudioAnalyzer&, int) {}
+  virtual void render(CRGB* leds, int numLeds, const AudioFeatures& features) = 0;
 };
 
 /**
  * 音量条效果
- * 显示一个随音量变化的彩色条
+ * 显示一个随音量变化的彩色条；由蓝到红的渐变按灯数缓存，灯数不变时每帧只做拷贝
  */
 class VUMeterEffect : public AudioEffect {
 public:
   VUMeterEffect() {}
   
-  void render(CRGB* leds, int numLeds, OptimizedAudioAnalyzer& analyzer) override {
+  uint8_t features() const override { return AudioFeatures::FEAT_LEVEL; }
+
+  void render(CRGB* leds, int numLeds, const AudioFeatures& features) override {
     // 获取音量并应用敏感度
-    float level = analyzer.level() * sensitivity_;
+    float level = features.level * sensitivity_;
     if (level > 1.0f) level = 1.0f;
     
     // 计算要点亮的LED数量
     int activeLength = (int)(level * numLeds);
     
-    // 渐变色填充
+    // 渐变色填充 (从蓝到红的渐变，色相 160 → 0)
+    const CRGB* gradient = gradient_.get(LedPalette::rainbow(), 160, 0, (uint16_t)numLeds);
     for (int i = 0; i < numLeds; i++) {
-      if (i < activeLength) {
-        // 计算此LED的颜色 (从蓝到红的渐变)
-        float hue = 160.0f - (i * 160.0f / numLeds);
-        leds[i] = CHSV((int)hue, 255, 255);
-      } else {
-        // 不活跃的LED设为黑色
-        leds[i] = CRGB::Black;
-      }
+      // 不活跃的LED设为黑色
+      leds[i] = (i < activeLength) ? gradient[i] : CRGB::Black;
     }
   }
   
@@ -46,51 +49,47 @@ public:
   }
   
 private:
+  GradientCache gradient_;
   float sensitivity_ = 1.5f;
 };
 
 /**
  * 频谱显示效果
- * 将低、中、高频能量映射到不同区域
+ * 把分析器的 N 段对数频谱映射到灯带上的连续区段，每段按能量点亮一截，颜色随频率由蓝到红
  */
 class SpectrumEffect : public AudioEffect {
 public:
   SpectrumEffect() {}
   
-  void render(CRGB* leds, int numLeds, OptimizedAudioAnalyzer& analyzer) override {
-    // 将灯带分成三个区域
-    int lowSection = numLeds / 3;
-    int midSection = numLeds / 3;
-    int highSection = numLeds - lowSection - midSection;
-    
-    // 获取频段能量
-    float lowLevel = analyzer.low() * sensitivity_;
-    float midLevel = analyzer.mid() * sensitivity_;
-    float highLevel = analyzer.high() * sensitivity_;
-    
-    // 限制范围
-    lowLevel = constrain(lowLevel, 0.0f, 1.0f);
-    midLevel = constrain(midLevel, 0.0f, 1.0f);
-    highLevel = constrain(highLevel, 0.0f, 1.0f);
-    
-    // 计算活跃LED数量
-    int lowActive = (int)(lowLevel * lowSection);
-    int midActive = (int)(midLevel * midSection);
-    int highActive = (int)(highLevel * highSection);
-    
-    // 渲染低频区域 (蓝色)
-    for (int i = 0; i < lowSection; i++) {
-      leds[i] = (i < lowActive) ? CRGB::Blue : CRGB::Black;
-    }
-    
-    // 渲染中频区域 (绿色)
-    for (int i = 0; i < midSection; i++) {
-      leds[i + lowSection] = (i < midActive) ? CRGB::Green : CRGB::Black;
+  uint8_t features() const override { return AudioFeatures::FEAT_SPECTRUM; }
+
+  void configure(OptimizedAudioAnalyzer& analyzer, int numLeds) override {
+    analyzer.requestBands(bandCountFor(numLeds));
+  }
+
+  void render(CRGB* leds, int numLeds, const AudioFeatures& features) override {
+    // 段数切换后的头一两帧快照可能还是旧段数，按快照实际段数绘制
+    uint8_t count = features.bandCount;
+    if (count == 0) {
+      fill_solid(leds, numLeds, CRGB::Black);
+      return;
     }
-    
-    // 渲染高频区域 (红色)
-    for (int i = 0; i < highSection; i++) {
-      leds[i + lowSection + midSection] = (i < highActive) ? CRGB::Red : CRGB::Black;
+    const uint8_t* bands = features.bands;
+
+    int pos = 0;
+    for (uint8_t b = 0; b < count; b++) {
+      // 余数平均分配给前几段
+      int section = numLeds / count + (b < numLeds % count ? 1 : 0);
+
+      float level = bands[b] * sensitivity_ / 255.0f;
+      level = constrain(level, 0.0f, 1.0f);
+      int active = (int)(level * section + 0.5f);
+
+      CRGB color = LedPalette::rainbow()[(uint8_t)(160 - b * 160 / count)];
+      for (int i = 0; i < section; i++) {
+        leds[pos + i] = (i < active) ? color : CRGB::Black;
+      }
+      pos += section;
     }
   }
   
@@ -99,41 +98,47 @@ public:
   }
   
 private:
+  // 灯少时用 8 段，保证每段至少有几颗灯
+  static uint8_t bandCountFor(int numLeds) { return numLeds >= 64 ? 16 : 8; }
+
   float sensitivity_ = 1.5f;
 };
 
 /**
  * 节拍脉冲效果
- * 检测音频中的节拍并产生脉冲效果
+ * 节拍来自分析器的谱通量起音检测；速度锁定后按节拍相位安排亮度，
+ * 脉冲与预测的节拍点对齐，而不是晚一帧才对音量跳变做出反应
  */
 class BeatPulseEffect : public AudioEffect {
 public:
   BeatPulseEffect() {}
   
-  void render(CRGB* leds, int numLeds, OptimizedAudioAnalyzer& analyzer) override {
-    // 获取当前音量
-    float currentLevel = analyzer.level();
-    
-    // 检测节拍
+  uint8_t features() const override { return AudioFeatures::FEAT_ONSET; }
+
+  void configure(OptimizedAudioAnalyzer& analyzer, int) override {
+    analyzer.setOnsetThreshold(beatThreshold_ * 5.0f); // 0.3 对应默认的 1.5 倍偏差
+  }
+
+  void render(CRGB* leds, int numLeds, const AudioFeatures& features) override {
     unsigned long now = millis();
-    bool isBeat = false;
+    uint32_t count = features.beatCount;
     
-    if (now - lastBeatTime_ > beatCooldownMs_) {
-      if (currentLevel > lastLevel_ * (1.0f + beatThreshold_)) {
-        isBeat = true;
+    if (features.bpm > 0.0f) {
+      // 速度已锁定：节拍点最亮，在下一拍之前衰减完
+      float fade = 1.0f - features.beatPhase;
+      beatIntensity_ = fade * fade;
+    } else {
+      // 速度未知：每个起音触发一次脉冲，按时间衰减
+      if (count != lastBeatCount_ && now - lastBeatTime_ > beatCooldownMs_) {
         lastBeatTime_ = now;
         beatIntensity_ = 1.0f;
+      } else if (beatIntensity_ > 0) {
+        beatIntensity_ -= (now - lastRenderMs_) / 300.0f;
+        if (beatIntensity_ < 0) beatIntensity_ = 0;
       }
     }
-    
-    // 脉冲衰减
-    if (!isBeat && beatIntensity_ > 0) {
-      beatIntensity_ -= 0.05f;
-      if (beatIntensity_ < 0) beatIntensity_ = 0;
-    }
-    
-    // 更新上一帧的音量级别
-    lastLevel_ = currentLevel * 0.8f + lastLevel_ * 0.2f;
+    lastBeatCount_ = count;
+    lastRenderMs_ = now;
     
     // 根据脉冲强度渲染所有LED
     CRGB color;
@@ -155,73 +160,53 @@ public:
     }
   }
   
+  // 起音检测灵敏度：越大越不敏感（映射为自适应阈值的偏差倍数）
   void setBeatThreshold(float threshold) {
     beatThreshold_ = constrain(threshold, 0.1f, 1.0f);
   }
   
+  // 速度未锁定时两次脉冲的最小间隔
   void setBeatCooldown(unsigned long cooldownMs) {
     beatCooldownMs_ = cooldownMs;
   }
   
 private:
-  float lastLevel_ = 0.0f;
   float beatIntensity_ = 0.0f;
   float beatThreshold_ = 0.3f;
+  uint32_t lastBeatCount_ = 0;
   unsigned long lastBeatTime_ = 0;
+  unsigned long lastRenderMs_ = 0;
   unsigned long beatCooldownMs_ = 200;
 };
 
 /**
  * 音高颜色效果
- * 根据检测到的音高改变颜色
+ * 跟随和声而不是单一音高：颜色取色度主音（按五度圈排列，相近的和声颜色相近），
+ * 长度取主音在当前调性中的级数 1~7；主音与调性都带迟滞，和弦上不会闪烁
  */
 class PitchColorEffect : public AudioEffect {
 public:
   PitchColorEffect() {}
   
-  void render(CRGB* leds, int numLeds, OptimizedAudioAnalyzer& analyzer) override {
-    // 获取音高和置信度
-    float pitch = analyzer.pitchHz();
-    float confidence = analyzer.pitchConf();
-    
-    // 如果音高检测置信度太低，使用音量条模式
-    if (pitch <= 0 || confidence < 0.3f) {
-      renderFallback(leds, numLeds, analyzer);
+  uint8_t features() const override { return AudioFeatures::FEAT_CHROMA | AudioFeatures::FEAT_LEVEL; }
+
+  void render(CRGB* leds, int numLeds, const AudioFeatures& features) override {
+    // 安静或色度过于平坦时没有主音，使用音量条模式
+    if (features.note < 0) {
+      renderFallback(leds, numLeds, features);
       return;
     }
-    
-    // 将音高映射到色相角度 (0-360度)
-    float hue = 0;
-    if (pitch >= minHz_ && pitch <= maxHz_) {
-      // 对数映射更符合人耳感知
-      hue = 360.0f * log(pitch / minHz_) / log(maxHz_ / minHz_);
-    }
-    
-    // 根据音高在[minHz_, maxHz_]区间的位置决定显示长度（低音短，高音长）
-    float pitchNorm = 0.0f;
-    if (pitch > 0) {
-      if (pitch <= minHz_) pitchNorm = 0.0f;
-      else if (pitch >= maxHz_) pitchNorm = 1.0f;
-      else pitchNorm = log(pitch / minHz_) / log(maxHz_ / minHz_);
-    }
-    if (pitchNorm < 0.0f) pitchNorm = 0.0f;
-    if (pitchNorm > 1.0f) pitchNorm = 1.0f;
 
-    // 将 pitchNorm 量化为 1~7 级，表示类似 1 2 3 4 5 6 7
-    int degree = 1 + (int)(pitchNorm * 7.0f);
-    if (degree < 1) degree = 1;
-    if (degree > 7) degree = 7;
+    // 五度圈位置映射到色相：C→G→D… 每步 1/12 圈
+    uint8_t fifths = (uint8_t)((features.note * 7) % 12);
+    CRGB rgb = LedPalette::rainbow()[(uint8_t)(fifths * 256 / 12)];
 
+    int degree = scaleDegree(features.note, features.key);
     int activeLength = (numLeds * degree) / 7;
-    if (activeLength < 1 && pitch > 0) activeLength = 1; // 有有效音高时至少点亮1颗
-
-    // 转换为HSV颜色
-    CHSV hsv((uint8_t)(hue * 255.0f / 360.0f), 255, 255);
-    CRGB rgb;
-    hsv2rgb_rainbow(hsv, rgb);
+    if (activeLength < 1) activeLength = 1; // 有主音时至少点亮1颗
 
     // 用音量控制亮度，但亮度不超过100
-    float level = analyzer.level() * sensitivity_;
+    float level = features.level * sensitivity_;
     if (level < 0.0f) level = 0.0f;
     if (level > 1.0f) level = 1.0f;
     uint8_t brightness = (uint8_t)(level * 100.0f);
@@ -242,15 +227,24 @@ public:
     sensitivity_ = constrain(sensitivity, 0.1f, 5.0f);
   }
   
-  void setPitchRange(float minHz, float maxHz) {
-    minHz_ = minHz;
-    maxHz_ = maxHz;
-  }
-  
 private:
-  void renderFallback(CRGB* leds, int numLeds, OptimizedAudioAnalyzer& analyzer) {
+  // 主音相对调性主音的级数 1~7；调外音归到下方最近的音阶音，调性未定时按音级均分
+  static int scaleDegree(int8_t note, int8_t key) {
+    if (key < 0) return 1 + note * 7 / 12;
+    static const uint8_t MAJOR[7] = {0, 2, 4, 5, 7, 9, 11};
+    static const uint8_t MINOR[7] = {0, 2, 3, 5, 7, 8, 10};
+    const uint8_t* scale = key >= 12 ? MINOR : MAJOR;
+    int interval = (note - key % 12 + 12) % 12;
+    int degree = 1;
+    for (int i = 0; i < 7; i++) {
+      if (scale[i] <= interval) degree = i + 1;
+    }
+    return degree;
+  }
+
+  void renderFallback(CRGB* leds, int numLeds, const AudioFeatures& features) {
     // 简单的音量条作为后备效果
-    float level = analyzer.level() * sensitivity_;
+    float level = features.level * sensitivity_;
     if (level > 1.0f) level = 1.0f;
     int activeLength = (int)(level * numLeds);
     
@@ -267,8 +261,6 @@ private:
   }
   
   float sensitivity_ = 1.5f;
-  float minHz_ = 110.0f; // A2
-  float maxHz_ = 880.0f; // A5
 };
 
 /**
@@ -302,9 +294,14 @@ public:
     }
   }
   
+  // 每帧读取一次特征快照，再交给当前效果渲染；分析任务尚未发布快照时按静音处理
   void render(CRGB* leds, int numLeds, OptimizedAudioAnalyzer& analyzer) {
     if (enabled_ && effects_[currentEffect_]) {
-      effects_[currentEffect_]->render(leds, numLeds, analyzer);
+      analyzer.setDemand(OptimizedAudioAnalyzer::CONSUMER_EFFECT, effects_[currentEffect_]->features());
+      effects_[currentEffect_]->configure(analyzer, numLeds);
+      AudioFeatures features;
+      analyzer.readFeatures(features);
+      effects_[currentEffect_]->render(leds, numLeds, features);
     }
   }
   
@@ -341,10 +338,6 @@ public:
     ((BeatPulseEffect*)effects_[EFFECT_BEAT_PULSE])->setBeatCooldown(cooldownMs);
   }
   
-  void setPitchRange(float minHz, float maxHz) {
-    ((PitchColorEffect*)effects_[EFFECT_PITCH_COLOR])->setPitchRange(minHz, maxHz);
-  }
-  
 private:
   AudioEffect* effects_[EFFECT_COUNT];
   EffectType currentEffect_ = EFFECT_VU_METER;
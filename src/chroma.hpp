@@ -0,0 +1,276 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * 色度（音级）特征
+ * 每个分析帧输入一次幅度谱：
+ *   1. 找出谱峰并插值出分数 bin 位置，按预先建好的 bin→半音 表把峰的幅度分到 12 个音级
+ *      （落在两个半音之间时按距离线性分摊），和弦的每个音都留在各自的音级上，
+ *      不会像单一音高估计那样在和弦上塌成一个错误的频率
+ *   2. 每帧归一化到最强音级 = 255 后做 Q8.8 平滑，主音取最强音级，需超过当前主音 25% 并保持 NOTE_HOLD_S 才切换
+ *   3. 长时平均的色度与 Krumhansl–Kessler 调性轮廓做相关，得到 24 个大小调中的调性，同样带迟滞
+ * 频率分辨率取决于 FFT 长度：谱峰位置经插值，只使用 bin 宽度不超过 MAX_BIN_SEMIS 个半音的 bin
+ * （8kHz 下 512 点约 60Hz 以上，128 点约 250Hz 以上）。分析器在窗口短于 512 点时为色度单独做 512 点 FFT
+ */
+class ChromaAnalyzer {
+public:
+  static const uint8_t CLASSES = 12;
+
+  ChromaAnalyzer() { reset(); }
+
+  /**
+   * 建立 bin→音级 表并换算平滑系数；不清空状态（采样率微调时保留主音与调性），窗口变化时由调用方 reset()
+   * @param bins    bin 数（窗口长度的一半）
+   * @param binHz   bin 间隔
+   * @param frameHz 每秒分析帧数
+   */
+  void configure(uint16_t bins, float binHz, float frameHz) {
+    if (bins > MAX_BINS) bins = MAX_BINS;
+    first_ = 0;
+    last_ = 0;
+    const float maxWidth = powf(2.0f, MAX_BIN_SEMIS / 12.0f) - 1.0f;
+    for (uint16_t k = 2; k + 1 < bins; k++) {
+      float f = k * binHz;
+      if (f < MIN_HZ || f > MAX_HZ || binHz > f * maxWidth) continue;
+      // 半音数 = 12·log2(f/C0)，在 bin 附近线性化：每偏移一个 bin 变化 12/(ln2·k) 个半音
+      semisQ8_[k] = (uint16_t)(12.0f * log2f(f / C0_HZ) * 256.0f + 0.5f);
+      slopeQ8_[k] = (uint16_t)(12.0f / (0.693147f * (float)k) * 256.0f + 0.5f);
+      if (first_ == 0) first_ = k;
+      last_ = k;
+    }
+    alpha_ = alphaQ16(CHROMA_TAU_S, frameHz);
+    keyAlpha_ = alphaQ16(KEY_TAU_S, frameHz);
+    frameDt_ = 1.0f / frameHz;
+  }
+
+  void reset() {
+    memset(smooth_, 0, sizeof(smooth_));
+    memset(keyAcc_, 0, sizeof(keyAcc_));
+    memset(chroma_, 0, sizeof(chroma_));
+    note_ = -1;
+    noteConf_ = 0.0f;
+    noteHold_ = 0.0f;
+    key_ = -1;
+    keyConf_ = 0.0f;
+    keyCandidate_ = -1;
+    keyHold_ = 0.0f;
+    activeTime_ = 0.0f;
+    sinceKey_ = 0.0f;
+  }
+
+  /**
+   * 处理一帧幅度谱
+   * @param mag    幅度谱（bin 0 为直流）
+   * @param active 是否有高于底噪的声音；安静时色度衰减、主音清空，调性保持
+   */
+  void process(const uint32_t* mag, bool active) {
+    uint8_t frame[CLASSES] = {};
+    if (active && last_ > 0) {
+      uint64_t acc[CLASSES] = {};
+      accumulatePeaks(mag, acc);
+      normalize(acc, frame);
+    }
+
+    // Q8.8 平滑：安静时输入为 0，色度自然衰减
+    for (uint8_t c = 0; c < CLASSES; c++) {
+      int64_t d = ((int64_t)frame[c] << 8) - smooth_[c];
+      smooth_[c] = (uint16_t)(smooth_[c] + ((d * alpha_) >> 16));
+      chroma_[c] = (uint8_t)(smooth_[c] >> 8);
+    }
+
+    if (!active) {
+      note_ = -1;
+      noteConf_ = 0.0f;
+      noteHold_ = 0.0f;
+      return;
+    }
+    updateNote();
+
+    // 调性：只累计有声的帧
+    for (uint8_t c = 0; c < CLASSES; c++) {
+      int64_t d = ((int64_t)frame[c] << 16) - keyAcc_[c];
+      keyAcc_[c] = (uint32_t)(keyAcc_[c] + ((d * keyAlpha_) >> 16));
+    }
+    activeTime_ += frameDt_;
+    sinceKey_ += frameDt_;
+    if (sinceKey_ >= KEY_INTERVAL_S && activeTime_ >= KEY_MIN_S) {
+      updateKey(sinceKey_);
+      sinceKey_ = 0.0f;
+    }
+  }
+
+  // 平滑后的 12 音级强度（C=0 … B=11），最强约 255
+  const uint8_t* chroma() const { return chroma_; }
+
+  // 主音 0..11，-1 表示安静或尚未确定
+  int8_t note() const { return note_; }
+  float noteConfidence() const { return noteConf_; } // 主音相对平均值的突出程度 0..1
+
+  // 调性 0..11 为 C..B 大调，12..23 为 C..B 小调，-1 表示尚未确定
+  int8_t key() const { return key_; }
+  float keyConfidence() const { return keyConf_; }   // 与调性轮廓的相关系数
+
+  // 表中实际使用的 bin 范围（调试用）
+  uint16_t firstBin() const { return first_; }
+  uint16_t lastBin() const { return last_; }
+
+private:
+  static const uint16_t MAX_BINS = 256;
+  static constexpr float C0_HZ = 16.3516f;       // C0，音级 0
+  static constexpr float MIN_HZ = 60.0f;
+  static constexpr float MAX_HZ = 2100.0f;       // 约 C7，更高处主要是泛音与噪声
+  static constexpr float MAX_BIN_SEMIS = 4.0f;   // bin 宽度上限（半音数），峰位置经插值，不要求 bin 窄于半音
+  static constexpr float CHROMA_TAU_S = 0.15f;
+  static constexpr float NOTE_HOLD_S = 0.12f;    // 新主音需保持的时间
+  static constexpr float MIN_NOTE_CONF = 0.25f;  // 色度过于平坦（噪声）时不给出主音
+  static constexpr float KEY_TAU_S = 8.0f;       // 调性统计的时间常数
+  static constexpr float KEY_INTERVAL_S = 0.5f;
+  static constexpr float KEY_MIN_S = 2.0f;       // 累计有声时间不足时不估计调性
+  static constexpr float KEY_HOLD_S = 2.0f;      // 新调性需持续领先的时间
+  static constexpr float KEY_MARGIN = 0.05f;     // 新调性需领先当前调性的相关系数差
+
+  static uint32_t alphaQ16(float tauS, float frameHz) {
+    float a = 1.0f - expf(-1.0f / (tauS * frameHz));
+    uint32_t q = (uint32_t)(a * 65536.0f + 0.5f);
+    return q ? q : 1;
+  }
+
+  /**
+   * 只累计谱峰：用汉宁窗的 Grandke 插值 δ = (2α−1)/(α+1)（α 为较大邻 bin 与峰值之比）求出峰的
+   * 分数 bin 位置，再查表换算为半音，按到两侧半音的距离分摊。相邻 bin 的泄漏不再各自落到错误的音级上。
+   * 低于本帧最强峰 -36dB 的峰视为噪声
+   */
+  void accumulatePeaks(const uint32_t* mag, uint64_t* acc) const {
+    uint32_t top = 0;
+    for (uint16_t k = first_; k <= last_; k++) {
+      if (mag[k] > top) top = mag[k];
+    }
+    uint32_t gate = top >> 6;
+    for (uint16_t k = first_; k <= last_; k++) {
+      uint32_t c = mag[k], a = mag[k - 1], b = mag[k + 1];
+      if (c <= gate || c < a || c <= b) continue;
+      uint32_t nb = a > b ? a : b;
+      int32_t alpha = (int32_t)(((uint64_t)nb << 8) / c);             // Q8，0..256
+      int32_t delta = ((2 * alpha - 256) << 8) / (alpha + 256);        // Q8，约 -128..128
+      if (delta < 0) delta = 0;
+      if (a > b) delta = -delta;
+      int32_t semis = (int32_t)semisQ8_[k] + ((delta * (int32_t)slopeQ8_[k]) >> 8);
+      if (semis < 0) continue;
+      uint8_t pc = (uint8_t)((semis >> 8) % CLASSES);
+      uint32_t w = (uint32_t)semis & 0xFF;
+      acc[pc] += (uint64_t)c * (256u - w);
+      acc[pc == CLASSES - 1 ? 0 : pc + 1] += (uint64_t)c * w;
+    }
+  }
+
+  // 归一化到最强音级 = 255：先右移到 24 位以内，之后只需一次 32 位除法
+  static void normalize(const uint64_t* acc, uint8_t* out) {
+    uint64_t peak = 0;
+    for (uint8_t c = 0; c < CLASSES; c++) {
+      if (acc[c] > peak) peak = acc[c];
+    }
+    if (peak == 0) return;
+    uint8_t shift = 0;
+    while ((peak >> shift) > 0xFFFFFFu) shift++;
+    uint32_t p = (uint32_t)(peak >> shift);
+    uint32_t inv = (255u << 24) / p;
+    for (uint8_t c = 0; c < CLASSES; c++) {
+      out[c] = (uint8_t)(((uint32_t)(acc[c] >> shift) * inv) >> 24);
+    }
+  }
+
+  void updateNote() {
+    uint8_t best = 0;
+    uint32_t sum = 0;
+    for (uint8_t c = 0; c < CLASSES; c++) {
+      sum += smooth_[c];
+      if (smooth_[c] > smooth_[best]) best = c;
+    }
+    float peak = (float)smooth_[best];
+    noteConf_ = peak > 0.0f ? (peak - (float)sum / CLASSES) / peak : 0.0f;
+
+    if (note_ < 0) {
+      if (noteConf_ >= MIN_NOTE_CONF) note_ = (int8_t)best;
+      noteHold_ = 0.0f;
+      return;
+    }
+    // 迟滞：新音级比当前主音强 25% 以上并保持一段时间才切换，和弦内部的起伏不会来回跳
+    if (best != (uint8_t)note_ && (uint32_t)smooth_[best] * 4 > (uint32_t)smooth_[note_] * 5) {
+      noteHold_ += frameDt_;
+      if (noteHold_ >= NOTE_HOLD_S) {
+        note_ = (int8_t)best;
+        noteHold_ = 0.0f;
+      }
+    } else {
+      noteHold_ = 0.0f;
+    }
+  }
+
+  // 与 24 个调性轮廓做皮尔逊相关
+  void updateKey(float elapsed) {
+    static const float MAJOR[CLASSES] = {6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f};
+    static const float MINOR[CLASSES] = {6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f};
+
+    float x[CLASSES];
+    float mean = 0.0f;
+    for (uint8_t c = 0; c < CLASSES; c++) { x[c] = (float)keyAcc_[c]; mean += x[c]; }
+    mean /= CLASSES;
+    float xx = 0.0f;
+    for (uint8_t c = 0; c < CLASSES; c++) { x[c] -= mean; xx += x[c] * x[c]; }
+    if (xx <= 0.0f) return;
+
+    float score[24];
+    for (uint8_t mode = 0; mode < 2; mode++) {
+      const float* prof = mode ? MINOR : MAJOR;
+      float pm = 0.0f;
+      for (uint8_t c = 0; c < CLASSES; c++) pm += prof[c];
+      pm /= CLASSES;
+      float pp = 0.0f;
+      for (uint8_t c = 0; c < CLASSES; c++) pp += (prof[c] - pm) * (prof[c] - pm);
+      for (uint8_t tonic = 0; tonic < CLASSES; tonic++) {
+        float xp = 0.0f;
+        for (uint8_t c = 0; c < CLASSES; c++) xp += x[(tonic + c) % CLASSES] * (prof[c] - pm);
+        score[mode * CLASSES + tonic] = xp / sqrtf(xx * pp);
+      }
+    }
+
+    uint8_t best = 0;
+    for (uint8_t k = 1; k < 24; k++) {
+      if (score[k] > score[best]) best = k;
+    }
+    if (key_ < 0) {
+      key_ = (int8_t)best;
+    } else if (best != (uint8_t)key_ && score[best] > score[key_] + KEY_MARGIN) {
+      // 同一个候选需连续领先 KEY_HOLD_S 才切换
+      if (keyCandidate_ != (int8_t)best) { keyCandidate_ = (int8_t)best; keyHold_ = 0.0f; }
+      keyHold_ += elapsed;
+      if (keyHold_ >= KEY_HOLD_S) { key_ = (int8_t)best; keyCandidate_ = -1; keyHold_ = 0.0f; }
+    } else {
+      keyCandidate_ = -1;
+      keyHold_ = 0.0f;
+    }
+    keyConf_ = score[key_] > 0.0f ? score[key_] : 0.0f;
+  }
+
+  // bin→半音 表（Q8，C0 为 0）与每个 bin 的局部斜率；入选条件随频率单调，使用的 bin 是连续的 first_..last_
+  uint16_t semisQ8_[MAX_BINS] = {};
+  uint16_t slopeQ8_[MAX_BINS] = {};
+  uint16_t first_ = 0, last_ = 0;
+  uint32_t alpha_ = 1, keyAlpha_ = 1;
+  float frameDt_ = 0.004f;
+
+  uint16_t smooth_[CLASSES];   // Q8.8
+  uint32_t keyAcc_[CLASSES];   // Q16.16
+  uint8_t chroma_[CLASSES];
+  int8_t note_;
+  float noteConf_;
+  float noteHold_;
+  int8_t key_;
+  float keyConf_;
+  int8_t keyCandidate_;
+  float keyHold_;
+  float activeTime_;
+  float sinceKey_;
+};
@@ -4,42 +4,109 @@
 #include <vector>
 #include "optimized_audio.hpp"
 #include "audio_visualizer.hpp"
+#include "led_palette.hpp"
+#include "led_transmitter.hpp"
+#include "led_output.hpp"
+#include "led_power.hpp"
 
-// 定义最大LED数量
-#define MAX_LEDS 300
+// 画布容量（灯珠数上限）：按构建环境在 platformio.ini 的 build_flags 中设置（-DLED_CAPACITY=160），
+// 与入口文件的 LED_COUNT（各灯带总长）一致即可；控制器的画布、发送缓冲、映射表与各效果图层都按它在编译期定长分配
+#ifndef LED_CAPACITY
+#define LED_CAPACITY 300
+#endif
+
+/**
+ * 灯带输出通道：一条物理灯带的引脚、长度与颜色顺序
+ * 画布的逻辑编号按通道表的顺序首尾相接（经络的 startIndex 也按逻辑编号计）；
+ * reversed 表示灯带从远端接线，逻辑编号在该通道内倒序。
+ * 入口文件的 LED_CHANNELS 表多条灯带时逐行添加并让 LED_COUNT 等于总长，例如左右各一条、右侧从远端接线：
+ *   { 0, 80, RGB, false }, { 4, 80, RGB, true }
+ */
+struct LedChannelConfig {
+  uint8_t pin;
+  uint16_t length;
+  EOrder order;   // 颜色顺序，WS2812B 灯珠大多为 GRB；单引脚构造沿用原来的 RGB
+  bool reversed;
+};
 
 /**
  * FastLED版本的灯带画布类
+ * 多通道：画布可以跨多条灯带（每条一个 FastLED 控制器，各自的引脚、长度与颜色顺序），
+ * 一次 FastLED.show() 由 ESP32 的 RMT 驱动把各通道并行发出（C3 有 2 个发送通道，更多的灯带排队等通道空闲），
+ * 发送时间取最长的一条而不是各条之和。逻辑编号到发送缓冲位置的映射在构造时算好，没有反向通道时直接整块拷贝。
+ *
+ * 双缓冲：效果渲染到 leds_（后台），FastLED 绑定前台缓冲 front_；show() 把要发送的帧拷到前台后交给
+ * LedTransmitter 的发送任务，不等发完就返回，下一帧的渲染与这一帧的传输重叠。
+ * 拷贝经过输出级（LedOutputStage）：伽马、亮度与功率缩放、时间抖动与逻辑→物理映射在同一遍里完成，
+ * FastLED 以亮度 255 原样发送。shown_ 保存上次发送的渲染帧（逻辑顺序、输出级之前）：
+ * show() 只在帧内容或有效亮度与它不同才传输（WS2812 每次传输 160 灯约 5ms），输出带小数时为时间抖动逐帧发送，
+ * 另外每 REFRESH_MS 强制发送一次，纠正线上干扰造成的错色；外部直接写过 leds() 后调用 requestRefresh()。
+ * 经络系统不直接写画布，而是写控制器的外部图层，与灯效共用这里的亮度、限流与帧统计
+ *
+ * 缓冲由派生的 FixedLEDCanvas<N> 按编译期容量提供，本类只持有指针，路径、效果与网页接口都用本类引用
  */
 class EnhancedLEDCanvas {
 public:
-  explicit EnhancedLEDCanvas(uint16_t count, uint8_t pin) : numLeds_(count), pin_(pin) {
-    // 初始化FastLED
-    switch(pin) {
-      case 0: FastLED.addLeds<WS2812B, 0>(leds_, numLeds_); break;  // 添加GPIO0支持
-      case 2: FastLED.addLeds<WS2812B, 2>(leds_, numLeds_); break;
-      case 3: FastLED.addLeds<WS2812B, 3>(leds_, numLeds_); break;
-      case 4: FastLED.addLeds<WS2812B, 4>(leds_, numLeds_); break;
-      case 5: FastLED.addLeds<WS2812B, 5>(leds_, numLeds_); break;
-      case 6: FastLED.addLeds<WS2812B, 6>(leds_, numLeds_); break;
-      case 7: FastLED.addLeds<WS2812B, 7>(leds_, numLeds_); break;
-      case 8: FastLED.addLeds<WS2812B, 8>(leds_, numLeds_); break;
-      case 9: FastLED.addLeds<WS2812B, 9>(leds_, numLeds_); break;
-      case 10: FastLED.addLeds<WS2812B, 10>(leds_, numLeds_); break;
-      default: FastLED.addLeds<WS2812B, 0>(leds_, numLeds_); break; // 默认使用GPIO0
-    }
-    clear();
-  }
+  static const uint8_t MAX_CHANNELS = 4;
 
   void begin() { 
+    power_.setLedFull(ledFull_mA());
+    clear();
     FastLED.clear();
     FastLED.show();
+    tx_.begin(transmit, this);
   }
 
   uint16_t length() const { return numLeds_; }
+  uint16_t capacity() const { return capacity_; }
+
+  // 输出通道：offset 为该通道在发送缓冲中的起点
+  struct Channel {
+    LedChannelConfig config;
+    uint16_t offset;
+  };
+  uint8_t channelCount() const { return channelCount_; }
+  const Channel& channel(uint8_t i) const { return channels_[i < channelCount_ ? i : 0]; }
+
+  // 逻辑编号 → 发送缓冲位置
+  uint16_t physicalIndex(uint16_t logical) const { return logical < numLeds_ ? map_[logical] : logical; }
+
+  static const char* orderName(EOrder order) {
+    switch (order) {
+      case RGB: return "RGB";
+      case RBG: return "RBG";
+      case GRB: return "GRB";
+      case GBR: return "GBR";
+      case BRG: return "BRG";
+      case BGR: return "BGR";
+      default: return "?";
+    }
+  }
 
   void clear() { 
-    FastLED.clear();
+    fill_solid(leds_, numLeds_, CRGB::Black);
+    damage(litLo_, litHi_);
+    litLo_ = litHi_ = 0;
+  }
+
+  /**
+   * 脏区：自上次 show() 以来改写过的逻辑区间，功率模型只对这一段增量更新负载。
+   * 只是提示：show() 会检查脏区外的内容，发现未登记的写入（外部直接写 leds()）就整帧重算
+   */
+  void damage(uint16_t lo, uint16_t hi) {
+    if (hi > numLeds_) hi = numLeds_;
+    if (lo >= hi) return;
+    if (dirtyLo_ >= dirtyHi_) { dirtyLo_ = lo; dirtyHi_ = hi; return; }
+    if (lo < dirtyLo_) dirtyLo_ = lo;
+    if (hi > dirtyHi_) dirtyHi_ = hi;
+  }
+
+  // 合成器写了 [lo, hi)、其余置黑：改动的范围是上次与这次非黑区间的并集
+  void damageComposed(uint16_t lo, uint16_t hi) {
+    damage(litLo_, litHi_);
+    damage(lo, hi);
+    if (lo < hi) { litLo_ = lo; litHi_ = hi; }
+    else litLo_ = litHi_ = 0;
   }
 
   void blendPixel(uint16_t idx, uint32_t c) {
@@ -52,6 +119,7 @@ public:
     
     // 使用FastLED的颜色混合
     leds_[idx] |= CRGB(r, g, b);
+    damagePixel(idx);
   }
 
   void setPixel(uint16_t idx, uint32_t c) {
@@ -64,8 +132,42 @@ public:
     
     // 设置像素颜色
     leds_[idx] = CRGB(r, g, b);
+    damagePixel(idx);
   }
 
+  static const uint16_t REFRESH_MS = 1000;
+
+  // 关闭静止抖动时，内容不变后为时间抖动继续发送的帧数上限（约 0.5 秒），之后发一帧四舍五入的结果，静止画面不再逐帧发送
+  static const uint8_t DITHER_FRAMES = 32;
+
+  // 静止抖动（默认开）：内容不变时只要输出还带小数就一直逐帧发送，暗的静止画面（如经络静态显示）保持 8 位以下的亮度级，
+  // 代价是每帧一次传输（160 灯约 5ms）；关闭后按 DITHER_FRAMES 收敛，静止画面只剩定时刷新，暗处回到 8 位台阶
+  void setStaticDither(bool on) {
+    staticDither_ = on;
+    refresh_ = true;
+  }
+  bool staticDither() const { return staticDither_; }
+
+  // 下一次 show() 无论内容是否变化都发送
+  void requestRefresh() { refresh_ = true; }
+
+  uint32_t framesTransmitted() const { return transmitted_; }
+  uint32_t framesChanged() const { return changed_; }      // 内容或缩放变化而发送的帧
+  uint32_t framesUnchanged() const { return unchanged_; }  // 内容未变、未发送的帧
+  uint32_t framesRefreshed() const { return refreshed_; }  // 内容未变、因强制刷新而发送的帧
+  uint32_t framesDithered() const { return dithered_; }    // 内容未变、为时间抖动继续发送的帧（含收敛帧）
+
+  // 输出级：伽马校正与时间抖动开关
+  LedOutputStage& output() { return output_; }
+
+  // 功率模型：通道校准、限流状态与电流/能量历史
+  LedPowerModel& power() { return power_; }
+  uint32_t loadFullScans() const { return fullScans_; }        // 整帧重算负载的次数
+  uint32_t loadPartialScans() const { return partialScans_; }  // 只按脏区增量更新的次数
+
+  // 发送统计：发送耗时、等待上一帧的时间与重叠率
+  const LedTransmitter::Stats& txStats() { return tx_.stats(); }
+
   // 全局参数访问器
   static uint8_t& globalBrightness();
   static uint16_t& powerLimit_mA();
@@ -73,73 +175,415 @@ public:
   static uint32_t& lastCurrentEst_mA();
 
   void show() {
-    uint32_t sum = 0;
-    for (uint16_t i = 0; i < numLeds_; ++i) {
-      sum += leds_[i].r + leds_[i].g + leds_[i].b;
-    }
+    uint32_t now = millis();
+    bool due = refresh_ || now - lastShowMs_ >= REFRESH_MS;
+
+    // 与上次发送的帧分段比较：脏区内不同是正常的改写，脏区外不同说明有未登记的写入
+    uint16_t lo = dirtyLo_, hi = dirtyHi_;
+    if (hi > numLeds_) hi = numLeds_;
+    if (lo >= hi) lo = hi = 0;
+    dirtyLo_ = dirtyHi_ = 0;
+    bool outsideSame = sameAsShown(0, lo) && sameAsShown(hi, numLeds_);
+    bool insideSame = sameAsShown(lo, hi);
+    updateLoad(outsideSame, insideSame, lo, hi, due);
+
+    // 功率模型按请求亮度下的估计限流，返回亮度与限流合成的 16 位缩放，交给输出级一次完成
+    uint16_t requested = (uint16_t)(globalBrightness() * 257u);
+    uint16_t effScale = power_.update(load_, numLeds_, requested, powerLimit_mA(), now);
+    lastCurrentEst_mA() = (uint32_t)(power_.estimate_mA() + 0.5f);
     
-    float currentEst = (float)ledFull_mA() * (float)sum / (255.0f * 3.0f);
-    if (currentEst < 0) currentEst = 0;
-    lastCurrentEst_mA() = (uint32_t)(currentEst + 0.5f);
-    
-    // 增强的功率管理和自动亮度调节
-    float scale = 1.0f;
-    if (powerLimit_mA() > 0) {
-      // 当估计电流超过限制的90%时开始逐渐降低亮度
-      if (currentEst > (float)powerLimit_mA() * 0.9f) {
-        // 渐进缩放，避免突然变暗
-        scale = (float)powerLimit_mA() / currentEst;
-        // 添加平滑过渡
-        static float lastScale = 1.0f;
-        scale = lastScale * 0.7f + scale * 0.3f;
-        lastScale = scale;
-      }
+    // 内容与缩放都相同则跳过传输；输出带小数（dithering()）时继续发送：静止抖动开启时一直发送，
+    // 关闭时变化后最多 DITHER_FRAMES 帧，然后发一帧不抖动的四舍五入结果，dithering() 变为 false，只剩定时刷新
+    bool same = effScale == shownScale_ && outsideSame && insideSame;
+    // 只为抖动或定时刷新而发的帧不等上一帧发完：同一帧里第二次 show()（经络系统同步发送后）直接跳过
+    if (same && ((!due && !output_.dithering()) || tx_.busy())) {
+      unchanged_++;
+      return;
     }
-    
-    uint16_t effBrightness = (uint16_t)((float)globalBrightness() * scale);
-    if (effBrightness > 255) effBrightness = 255;
-    
-    // 设置FastLED亮度并显示
-    FastLED.setBrightness((uint8_t)effBrightness);
-    FastLED.show();
+    if (!same) {
+      changed_++;
+      staticFrames_ = 0;
+    } else {
+      if (due) refreshed_++;
+      else dithered_++;
+    }
+    bool dither = staticDither_ || staticFrames_ < DITHER_FRAMES;
+    if (same && staticFrames_ < DITHER_FRAMES) staticFrames_++;
+
+    // 等上一帧发完才能改写前台缓冲，然后交给发送任务，不等这一帧发完
+    tx_.waitIdle();
+    output_.process(leds_, front_, identity_ ? nullptr : map_, numLeds_, effScale, dither);
+    if (!outsideSame || !insideSame) memcpy(shown_, leds_, numLeds_ * sizeof(CRGB));
+    shownScale_ = effScale;
+    lastShowMs_ = now;
+    refresh_ = false;
+    transmitted_++;
+    tx_.submit(255);
   }
 
   // 获取LED数组的直接访问
   CRGB* leds() { return leds_; }
 
+protected:
+  // 缓冲由派生类提供：leds、front 与 shown 各 capacity 颗，map 为 capacity 项，err 为 3 × capacity 字节
+  EnhancedLEDCanvas(CRGB* leds, CRGB* front, CRGB* shown, uint16_t* map, uint8_t* err, uint16_t capacity,
+                    const LedChannelConfig* channels, uint8_t count)
+  : capacity_(capacity), map_(map), leds_(leds), front_(front), shown_(shown) {
+    output_.attach(err, capacity);
+    init(channels, count);
+  }
+
+  // 单条灯带，沿用原来的 RGB 顺序
+  EnhancedLEDCanvas(CRGB* leds, CRGB* front, CRGB* shown, uint16_t* map, uint8_t* err, uint16_t capacity,
+                    uint16_t count, uint8_t pin)
+  : capacity_(capacity), map_(map), leds_(leds), front_(front), shown_(shown) {
+    output_.attach(err, capacity);
+    LedChannelConfig c = { pin, count, RGB, false };
+    init(&c, 1);
+  }
+
 private:
-  uint16_t numLeds_;
-  uint8_t pin_;
-  CRGB leds_[MAX_LEDS]; // 使用静态数组避免动态内存分配
+  void init(const LedChannelConfig* channels, uint8_t count) {
+    numLeds_ = 0;
+    channelCount_ = 0;
+    identity_ = true;
+    for (uint8_t i = 0; i < count && channelCount_ < MAX_CHANNELS; i++) {
+      LedChannelConfig c = channels[i];
+      if (c.length > capacity_ - numLeds_) c.length = capacity_ - numLeds_;
+      if (c.length == 0) continue;
+      // 初始化FastLED：每个通道绑定前台（发送）缓冲的一段
+      attach(c.pin, c.order, front_ + numLeds_, c.length);
+      Channel& ch = channels_[channelCount_++];
+      ch.config = c;
+      ch.offset = numLeds_;
+      for (uint16_t j = 0; j < c.length; j++) {
+        map_[numLeds_ + j] = ch.offset + (c.reversed ? c.length - 1 - j : j);
+      }
+      if (c.reversed) identity_ = false;
+      numLeds_ += c.length;
+    }
+    clear();
+    fill_solid(shown_, numLeds_, CRGB::Black);
+  }
+
+  template <uint8_t PIN>
+  static void attachPin(EOrder order, CRGB* data, uint16_t n) {
+    switch (order) {
+      case GRB: FastLED.addLeds<WS2812B, PIN, GRB>(data, n); break;
+      case RBG: FastLED.addLeds<WS2812B, PIN, RBG>(data, n); break;
+      case GBR: FastLED.addLeds<WS2812B, PIN, GBR>(data, n); break;
+      case BRG: FastLED.addLeds<WS2812B, PIN, BRG>(data, n); break;
+      case BGR: FastLED.addLeds<WS2812B, PIN, BGR>(data, n); break;
+      default: FastLED.addLeds<WS2812B, PIN, RGB>(data, n); break;
+    }
+  }
+
+  static void attach(uint8_t pin, EOrder order, CRGB* data, uint16_t n) {
+    switch (pin) {
+      case 0: attachPin<0>(order, data, n); break;  // 添加GPIO0支持
+      case 2: attachPin<2>(order, data, n); break;
+      case 3: attachPin<3>(order, data, n); break;
+      case 4: attachPin<4>(order, data, n); break;
+      case 5: attachPin<5>(order, data, n); break;
+      case 6: attachPin<6>(order, data, n); break;
+      case 7: attachPin<7>(order, data, n); break;
+      case 8: attachPin<8>(order, data, n); break;
+      case 9: attachPin<9>(order, data, n); break;
+      case 10: attachPin<10>(order, data, n); break;
+      default: attachPin<0>(order, data, n); break; // 默认使用GPIO0
+    }
+  }
+
+  // 两块都是逻辑顺序，与通道映射无关
+  bool sameAsShown(uint16_t lo, uint16_t hi) const {
+    return lo >= hi || memcmp(shown_ + lo, leds_ + lo, (hi - lo) * sizeof(CRGB)) == 0;
+  }
+
+  void damagePixel(uint16_t idx) {
+    damage(idx, idx + 1);
+    if (litLo_ >= litHi_) { litLo_ = idx; litHi_ = idx + 1; return; }
+    if (idx < litLo_) litLo_ = idx;
+    if (idx + 1 > litHi_) litHi_ = idx + 1;
+  }
+
+  /**
+   * 通道负载（伽马域）与 leds_ 同步：shown_ 总等于上次 show() 时的 leds_，
+   * 脏区内先减去旧像素再加上新像素；首次、伽马切换、脏区外有改动或到了强制刷新时整帧重算
+   */
+  void updateLoad(bool outsideSame, bool insideSame, uint16_t lo, uint16_t hi, bool due) {
+    if (!loadValid_ || !outsideSame || due || output_.gamma() != loadGamma_) {
+      load_[0] = load_[1] = load_[2] = 0;
+      output_.addLoad(leds_, 0, numLeds_, load_);
+      loadValid_ = true;
+      loadGamma_ = output_.gamma();
+      fullScans_++;
+      return;
+    }
+    if (insideSame) return;
+    output_.subLoad(shown_, lo, hi, load_);
+    output_.addLoad(leds_, lo, hi, load_);
+    partialScans_++;
+  }
+
+  // 在发送任务中运行：亮度作为参数传入（输出级已缩放，固定为 255），不改 FastLED 的全局亮度
+  static void transmit(void* ctx, uint8_t brightness) {
+    (void)ctx;
+    FastLED.show(brightness);
+  }
+
+  uint16_t numLeds_ = 0;
+  uint16_t capacity_;
+  Channel channels_[MAX_CHANNELS];
+  uint8_t channelCount_ = 0;
+  bool identity_ = true;     // 没有反向通道：逻辑编号即发送缓冲位置
+  uint16_t* map_;            // 逻辑编号 → 发送缓冲位置
+  CRGB* leds_;               // 渲染缓冲（逻辑顺序）
+  CRGB* front_;              // 发送缓冲（物理顺序），输出级的结果
+  CRGB* shown_;              // 上次发送的渲染帧（逻辑顺序）
+  LedOutputStage output_;
+  LedPowerModel power_;
+  uint32_t load_[3] = { 0, 0, 0 };  // 当前 leds_ 的通道负载
+  bool loadValid_ = false;
+  bool loadGamma_ = true;
+  uint16_t dirtyLo_ = 0, dirtyHi_ = 0;
+  uint16_t litLo_ = 0, litHi_ = 0;   // 合成器与 setPixel 写过的非黑区间，区间外为黑
+  uint32_t fullScans_ = 0;
+  uint32_t partialScans_ = 0;
+  LedTransmitter tx_;
+  uint16_t shownScale_ = 0;
+  uint32_t lastShowMs_ = 0;
+  bool refresh_ = true;
+  uint32_t transmitted_ = 0;
+  uint32_t changed_ = 0;
+  uint32_t unchanged_ = 0;
+  uint32_t refreshed_ = 0;
+  uint32_t dithered_ = 0;
+  uint8_t staticFrames_ = 0;  // 上次内容变化后为抖动发送的帧数（到 DITHER_FRAMES 为止）
+  bool staticDither_ = true;
+};
+
+// FixedLEDCanvas 的缓冲：作为第一个基类先于 EnhancedLEDCanvas 构造，基类构造时即可写入
+template <uint16_t N>
+struct FixedLEDCanvasStorage {
+  CRGB renderBuf[N];
+  CRGB sendBuf[N];
+  CRGB shownBuf[N];
+  uint16_t mapBuf[N];
+  uint8_t ditherBuf[N * 3];
+};
+
+/**
+ * 编译期定长的画布：N 颗灯的渲染缓冲、发送缓冲、上次发送的帧、映射表与抖动误差都是成员数组（使用静态数组避免动态内存分配），
+ * 不再按固定的 300 颗预留；N 一般取 LED_CAPACITY
+ */
+template <uint16_t N>
+class FixedLEDCanvas : private FixedLEDCanvasStorage<N>, public EnhancedLEDCanvas {
+  typedef FixedLEDCanvasStorage<N> Storage;
+
+public:
+  // 单条灯带（原接口）
+  FixedLEDCanvas(uint16_t count, uint8_t pin)
+  : EnhancedLEDCanvas(Storage::renderBuf, Storage::sendBuf, Storage::shownBuf, Storage::mapBuf, Storage::ditherBuf, N, count, pin) {}
+
+  // 多条灯带：逻辑编号按表中顺序首尾相接，总长不超过 N
+  FixedLEDCanvas(const LedChannelConfig* channels, uint8_t count)
+  : EnhancedLEDCanvas(Storage::renderBuf, Storage::sendBuf, Storage::shownBuf, Storage::mapBuf, Storage::ditherBuf, N, channels, count) {}
 };
 
+// 路线表中的灯号都小于 count（编译期检查 constexpr 路线表：static_assert(ledRouteFits(ROUTE, n, LED_COUNT), "...")）
+constexpr bool ledRouteFits(const uint16_t* nodes, uint16_t n, uint16_t count) {
+  return n == 0 || (nodes[n - 1] < count && ledRouteFits(nodes, n - 1, count));
+}
+
 /**
  * 路径类 - 定义LED灯带上的节点路径
+ * 恒等路径（默认）：第 i 个节点就是第 i 颗灯，node() 不查表；效果可用 identity() 直接跳过映射。
+ * 固定路线：setTable() 指向常量表（constexpr 数组放在 flash，不占 RAM）；运行时生成的路线用 FixedLEDPath<N> 存放。
+ * node(i) 要求 i < size()，不再逐像素取模，调用者自己回绕
  */
 class EnhancedLEDPath {
 public:
-  explicit EnhancedLEDPath(EnhancedLEDCanvas& canvas) : canvas_(canvas) {}
-  
-  void setNodes(const std::vector<uint16_t>& nodes) { nodes_ = nodes; }
+  explicit EnhancedLEDPath(EnhancedLEDCanvas& canvas) : canvas_(canvas) { setIdentity(); }
+
+  // 恒等路径，长度跟随画布
+  void setIdentity() {
+    nodes_ = nullptr;
+    size_ = canvas_.length();
+  }
+
+  // 固定路线表：表的生存期须覆盖路径的使用期
+  void setTable(const uint16_t* nodes, uint16_t count) {
+    if (!nodes) {
+      setIdentity();
+      return;
+    }
+    nodes_ = nodes;
+    size_ = count;
+  }
+
+  template <uint16_t M>
+  void setTable(const uint16_t (&nodes)[M]) { setTable(nodes, M); }
+
+  bool identity() const { return nodes_ == nullptr; }
   
-  uint16_t size() const { return (uint16_t)nodes_.size(); }
+  uint16_t size() const { return size_; }
   
-  uint16_t node(uint16_t i) const { return nodes_[i % nodes_.size()]; }
+  uint16_t node(uint16_t i) const { return nodes_ ? nodes_[i] : i; }
   
   EnhancedLEDCanvas& canvas() { return canvas_; }
 
 private:
   EnhancedLEDCanvas& canvas_;
-  std::vector<uint16_t> nodes_;
+  const uint16_t* nodes_ = nullptr;
+  uint16_t size_ = 0;
+};
+
+/**
+ * 带 N 项路线存储的路径：运行时生成的路线（如按配置排列的经络顺序）拷贝到内部表
+ */
+template <uint16_t N>
+class FixedLEDPath : public EnhancedLEDPath {
+public:
+  explicit FixedLEDPath(EnhancedLEDCanvas& canvas) : EnhancedLEDPath(canvas) {}
+
+  // 超过 N 项的部分丢弃，返回实际保存的节点数
+  uint16_t setNodes(const uint16_t* nodes, uint16_t count) {
+    if (count > N) count = N;
+    memcpy(table_, nodes, count * sizeof(uint16_t));
+    setTable(table_, count);
+    return count;
+  }
+
+private:
+  uint16_t table_[N];
+};
+
+/**
+ * 图层：每个效果渲染到自己的图层，由效果管理器合成到画布
+ * 图层只记录本帧写过的区间 [lo, hi)（损坏区间），合成时只有区间内的像素参与混合，
+ * 重新渲染前也只清零上一帧的区间（点效果只占一个像素，流动效果只占拖尾所在的一段）
+ *
+ * 混合模式（opacity 为图层不透明度 0..255）：
+ *   ALPHA     下层 + (本层 - 下层) × 不透明度；区间内的黑色像素同样覆盖下层
+ *   ADD       下层 + 本层 × 不透明度，饱和到 255
+ *   MAX       逐通道取较大值（原 blendPixel 的 |= 语义）
+ *   MULTIPLY  下层 × 本层（不透明度为 0 时不改变下层）
+ *
+ * 像素缓冲由持有效果的一方按画布容量提供（attach），未挂缓冲的图层忽略所有写入
+ */
+class EnhancedLEDLayer {
+public:
+  enum BlendMode : uint8_t { BLEND_ALPHA, BLEND_ADD, BLEND_MAX, BLEND_MULTIPLY };
+
+  void attach(CRGB* px, uint16_t capacity) {
+    px_ = px;
+    capacity_ = px ? capacity : 0;
+    if (px_) fill_solid(px_, capacity_, CRGB::Black);
+    lo_ = hi_ = 0;
+  }
+
+  void setBlend(BlendMode mode, uint8_t opacity) { mode_ = mode; opacity_ = opacity; }
+  BlendMode blendMode() const { return mode_; }
+  uint8_t opacity() const { return opacity_; }
+
+  static const char* blendName(BlendMode m) {
+    switch (m) {
+      case BLEND_ADD: return "add";
+      case BLEND_MAX: return "max";
+      case BLEND_MULTIPLY: return "multiply";
+      default: return "alpha";
+    }
+  }
+
+  void setPixel(uint16_t idx, uint32_t c) {
+    if (idx >= capacity_) return;
+    px_[idx] = CRGB((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+    damage(idx, idx + 1);
+  }
+
+  void setPixel(uint16_t idx, const CRGB& c) {
+    if (idx >= capacity_) return;
+    px_[idx] = c;
+    damage(idx, idx + 1);
+  }
+
+  void blendPixel(uint16_t idx, uint32_t c) {
+    if (idx >= capacity_) return;
+    px_[idx] |= CRGB((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+    damage(idx, idx + 1);
+  }
+
+  // 直接写 leds() 之后声明写过的区间
+  CRGB* leds() { return px_; }
+  void damage(uint16_t lo, uint16_t hi) {
+    if (hi > capacity_) hi = capacity_;
+    if (lo >= hi) return;
+    if (lo_ >= hi_) { lo_ = lo; hi_ = hi; return; }
+    if (lo < lo_) lo_ = lo;
+    if (hi > hi_) hi_ = hi;
+  }
+
+  // 清零上一帧写过的区间
+  void clear() {
+    if (hi_ > lo_) fill_solid(px_ + lo_, hi_ - lo_, CRGB::Black);
+    lo_ = hi_ = 0;
+  }
+
+  bool empty() const { return lo_ >= hi_; }
+  uint16_t capacity() const { return capacity_; }
+  uint16_t lo() const { return lo_; }
+  uint16_t hi() const { return hi_; }
+  const CRGB& at(uint16_t idx) const { return px_[idx]; }
+
+private:
+  CRGB* px_ = nullptr;
+  uint16_t capacity_ = 0;
+  uint16_t lo_ = 0, hi_ = 0;
+  BlendMode mode_ = BLEND_ALPHA;
+  uint8_t opacity_ = 255;
 };
 
 /**
  * 效果基类
+ * render() 把效果画到自己的图层 layer_（画之前管理器已清零上一帧的区间），不直接写画布。
+ * changed() 报告输出是否可能与上一帧不同：参数变化后由 markDirty() 标记一帧，
+ * 持续动画的效果覆盖 animating()；未变化的效果保留上一帧的图层，不重新渲染
  */
 class EnhancedLEDEffect {
 public:
+  explicit EnhancedLEDEffect(EnhancedLEDPath& path) : path_(path) {}
   virtual ~EnhancedLEDEffect() {}
   virtual void render(unsigned long now) = 0;
+
+  bool changed(unsigned long now) const { return dirty_ || animating(now); }
+  void clearDirty() { dirty_ = false; }
+  void invalidate() { dirty_ = true; }  // 下一次 tick 重新渲染
+
+  // 图层内容由外部维护：渲染前管理器不清空图层
+  virtual bool retained() const { return false; }
+  // 只在被设为独占时渲染与合成，平时不参与
+  virtual bool exclusive() const { return false; }
+
+  // 图层混合模式与不透明度
+  void setBlend(EnhancedLEDLayer::BlendMode mode, uint8_t opacity) {
+    if (mode == layer_.blendMode() && opacity == layer_.opacity()) return;
+    layer_.setBlend(mode, opacity);
+    markDirty();
+  }
+
+  EnhancedLEDLayer& layer() { return layer_; }
+  const EnhancedLEDLayer& layer() const { return layer_; }
+  EnhancedLEDCanvas& canvas() { return path_.canvas(); }
+
+protected:
+  virtual bool animating(unsigned long now) const { (void)now; return false; }
+  void markDirty() { dirty_ = true; }
+
+  EnhancedLEDPath& path_;
+  EnhancedLEDLayer layer_;
+
+private:
+  bool dirty_ = true;
 };
 
 /**
@@ -148,70 +592,64 @@ public:
 class EnhancedFlowEffect : public EnhancedLEDEffect {
 public:
   EnhancedFlowEffect(EnhancedLEDPath& path, uint32_t color, uint8_t tail, uint16_t interval_ms)
-  : path_(path), color_(color), tail_(tail), interval_(interval_ms) {}
+  : EnhancedLEDEffect(path), color_(color), interval_(interval_ms) { setTail(tail); }
   
-  void start() { running_ = true; }
-  void stop() { running_ = false; }
+  void start() { running_ = true; markDirty(); }
+  void stop() { running_ = false; markDirty(); }
   bool running() const { return running_; }
   
-  void setColor(uint32_t c) { color_ = c; }
-  void setTail(uint8_t t) { tail_ = t; }
-  void setInterval(uint16_t ms) { interval_ = ms; }
-  
-  // 生成彩虹色
-  uint32_t wheel(byte wheelPos) {
-    wheelPos = 255 - wheelPos;
-    if(wheelPos < 85) {
-      return ((uint32_t)(255 - wheelPos * 3) << 16) | ((uint32_t)(wheelPos * 3) << 8);
-    } else if(wheelPos < 170) {
-      wheelPos -= 85;
-      return ((uint32_t)(wheelPos * 3) << 8) | (255 - wheelPos * 3);
-    } else {
-      wheelPos -= 170;
-      return ((uint32_t)(255 - wheelPos * 3) | ((uint32_t)wheelPos * 3 << 16));
-    }
+  void setColor(uint32_t c) { color_ = c; markDirty(); }
+  void setTail(uint8_t t) {
+    tail_ = t;
+    // 拖尾第 k 颗的亮度
+    for (uint16_t k = 0; k <= tail_; k++) fade_[k] = (uint8_t)(255 - (255 * k) / (tail_ + 1));
+    markDirty();
   }
-
+  void setInterval(uint16_t ms) { interval_ = ms; markDirty(); }
+  
   void render(unsigned long now) override {
     if (!running_ || path_.size() == 0) return;
     
-    // 使用时间戳计算颜色变化，而不是步进
-    static uint8_t hue = 0;
-    hue++;
+    // 使用时间戳计算颜色变化，而不是步进：色相每 8ms 前进 1（约 2 秒一圈），与帧率无关
+    uint8_t hue = (uint8_t)(now >> 3);
     
     // 更新头部位置，基于时间而不是固定步进
+    uint16_t n = path_.size();
+    if (head_ >= n) head_ = 0;
     if (now - lastStepAt_ >= interval_) {
       lastStepAt_ = now;
-      head_ = (head_ + 1) % path_.size();
+      if (++head_ >= n) head_ = 0;
     }
     
-    // 清除画布
-    path_.canvas().clear();
-    
-    // 绘制流动效果
-    for (uint8_t k = 0; k <= tail_; ++k) {
-      uint16_t idxInPath = (head_ + path_.size() - k) % path_.size();
-      uint16_t ledIdx = path_.node(idxInPath);
-      
-      // 计算拖尾亮度
-      uint8_t brightness = 255 - (255 * k) / (tail_ + 1);
+    // 绘制流动效果（图层已由管理器清零，其它效果的内容不受影响）
+    // 颜色查色轮调色板，拖尾亮度查 setTail() 时生成的表，每颗灯只剩查表和三次缩放
+    // 拖尾从头部往回走，到路径起点时回绕到末尾，不做取模；恒等路径不查节点表
+    const LedPalette& wheel = LedPalette::wheel();
+    bool identity = path_.identity();
+    uint16_t idxInPath = head_;
+    for (uint16_t k = 0; k <= tail_; ++k) {
+      uint16_t ledIdx = identity ? idxInPath : path_.node(idxInPath);
+      idxInPath = idxInPath ? idxInPath - 1 : n - 1;
       
-      // 计算颜色，使用色相偏移创建彩虹效果
-      uint32_t color = wheel(hue + (k * 2));
+      // 色相偏移创建彩虹效果，再按拖尾亮度缩放
+      CRGB c = wheel[(uint8_t)(hue + k * 2)];
+      uint8_t brightness = fade_[k];
+      c.r = c.r * brightness / 255;
+      c.g = c.g * brightness / 255;
+      c.b = c.b * brightness / 255;
       
-      // 应用亮度
-      uint8_t r = ((color >> 16) & 0xFF) * brightness / 255;
-      uint8_t g = ((color >> 8) & 0xFF) * brightness / 255;
-      uint8_t b = (color & 0xFF) * brightness / 255;
-      
-      path_.canvas().setPixel(ledIdx, (r << 16) | (g << 8) | b);
+      layer_.setPixel(ledIdx, c);
     }
   }
 
+protected:
+  // 色相随时间推进，运行中每帧都不同
+  bool animating(unsigned long) const override { return running_; }
+
 private:
-  EnhancedLEDPath& path_;
   uint32_t color_;
   uint8_t tail_ = 8;
+  uint8_t fade_[256];
   uint16_t interval_ = 40;
   bool running_ = false;
   uint16_t head_ = 0;
@@ -223,24 +661,32 @@ private:
  */
 class EnhancedPointEffect : public EnhancedLEDEffect {
 public:
-  EnhancedPointEffect(EnhancedLEDPath& path) : path_(path) {}
+  EnhancedPointEffect(EnhancedLEDPath& path) : EnhancedLEDEffect(path) {
+    layer_.setBlend(EnhancedLEDLayer::BLEND_MAX, 255); // 指示点叠加在其它效果之上
+  }
   
+  // 音高命中时每帧都会重复设置同一个点，只有真正变化才标记
   void setPoint(uint16_t idxInPath, uint32_t color) { 
+    if (hasPoint_ && point_ == idxInPath && color_ == color) return;
     point_ = idxInPath; 
     color_ = color; 
     hasPoint_ = true; 
+    markDirty();
   }
   
-  void clearPoint() { hasPoint_ = false; }
+  void clearPoint() {
+    if (!hasPoint_) return;
+    hasPoint_ = false;
+    markDirty();
+  }
   
   void render(unsigned long) override {
     if (!hasPoint_ || path_.size() == 0) return;
     uint16_t ledIdx = path_.node(point_ % path_.size());
-    path_.canvas().blendPixel(ledIdx, color_);
+    layer_.setPixel(ledIdx, color_);
   }
 
 private:
-  EnhancedLEDPath& path_;
   uint16_t point_ = 0;
   uint32_t color_ = 0;
   bool hasPoint_ = false;
@@ -252,17 +698,19 @@ private:
 class EnhancedAudioEffect : public EnhancedLEDEffect {
 public:
   EnhancedAudioEffect(EnhancedLEDPath& path, OptimizedAudioAnalyzer& analyzer)
-  : path_(path), analyzer_(analyzer) {
+  : EnhancedLEDEffect(path), analyzer_(analyzer) {
     // 初始化可视化器
     visualizer_.setSensitivity(1.5f);
     visualizer_.setBeatThreshold(0.3f);
     visualizer_.setBeatCooldown(200);
-    visualizer_.setPitchRange(110.0f, 880.0f);
   }
 
   void setEnabled(bool en) { 
+    if (en != enabled_) markDirty();
     enabled_ = en; 
     visualizer_.setEnabled(en);
+    // 关闭后不再声明特征需求；开启后由可视化器在首帧按当前效果声明
+    if (!en) analyzer_.setDemand(OptimizedAudioAnalyzer::CONSUMER_EFFECT, 0);
   }
   
   bool enabled() const { return enabled_; }
@@ -272,6 +720,7 @@ public:
   }
   
   void setMode(AudioVisualizer::EffectType mode) {
+    if (mode != visualizer_.getCurrentEffect()) markDirty();
     visualizer_.setEffect(mode);
   }
   
@@ -283,14 +732,20 @@ public:
   void setExternalLen(uint16_t v) { externalLen_ = v; }
 
   void render(unsigned long) override {
-    if (!enabled_ || path_.size() == 0) return;
+    uint16_t n = path_.size();
+    if (n > layer_.capacity()) n = layer_.capacity();
+    if (!enabled_ || n == 0) return;
     
-    // 使用音频可视化器渲染效果
-    visualizer_.render(path_.canvas().leds(), path_.size(), analyzer_);
+    // 使用音频可视化器渲染效果：可视化器写满前 n 个像素
+    visualizer_.render(layer_.leds(), n, analyzer_);
+    layer_.damage(0, n);
   }
 
+protected:
+  // 音频效果随特征与时间衰减持续变化；静音时画面不变由画布的帧比较跳过
+  bool animating(unsigned long) const override { return enabled_; }
+
 private:
-  EnhancedLEDPath& path_;
   OptimizedAudioAnalyzer& analyzer_;
   AudioVisualizer visualizer_;
   bool enabled_ = false;
@@ -298,50 +753,202 @@ private:
   uint16_t externalLen_ = 0;
 };
 
+/**
+ * 外部图层效果：图层缓冲交给外部（经络系统）直接改写，写完调用 touch()；
+ * 渲染时不清空也不重画，只声明整段已写，由管理器合成后经画布统一发送
+ */
+class EnhancedExternalEffect : public EnhancedLEDEffect {
+public:
+  explicit EnhancedExternalEffect(EnhancedLEDPath& path) : EnhancedLEDEffect(path) {}
+
+  void touch() { markDirty(); }
+  bool retained() const override { return true; }
+  bool exclusive() const override { return true; }
+
+  void render(unsigned long) override { layer_.damage(0, path_.canvas().length()); }
+};
+
 /**
  * 效果管理器类
+ * 按添加顺序从下到上合成各效果的图层：只重新渲染有变化的效果，
+ * 然后对每块画布做一次逐像素的融合遍历（各图层按自己的混合模式与不透明度叠加），不做整帧拷贝
  */
 class EnhancedEffectManager {
 public:
   void addCanvas(EnhancedLEDCanvas* c) { canvases_.push_back(c); }
   void addEffect(EnhancedLEDEffect* e) { effects_.push_back(e); }
   
+  // 有效果变化时才重新渲染与合成；show() 每次都调用，由画布决定是否发送（内容变化或到了强制刷新时间）
   void tick() {
     unsigned long now = millis();
-    for (auto* c : canvases_) c->clear();
-    for (auto* e : effects_) e->render(now);
+    ticks_++;
+    bool dirty = invalid_;
+    for (auto* e : effects_) {
+      if (skipped(e)) continue;
+      if (!e->changed(now)) continue;
+      if (!e->retained()) e->layer().clear();
+      e->render(now);
+      e->clearDirty();
+      dirty = true;
+    }
+    if (dirty) {
+      invalid_ = false;
+      for (auto* c : canvases_) compose(*c);
+      rendered_++;
+    }
     for (auto* c : canvases_) c->show();
   }
 
+  // 画布被外部改写过：下一次 tick 无论效果是否变化都重新渲染
+  void invalidate() { invalid_ = true; }
+
+  // 独占：只渲染与合成这一个效果（经络模式），其余效果暂停；切换时所有效果重新渲染
+  void setSolo(EnhancedLEDEffect* e) {
+    if (e == solo_) return;
+    solo_ = e;
+    for (auto* x : effects_) x->invalidate();
+    invalid_ = true;
+  }
+  EnhancedLEDEffect* solo() const { return solo_; }
+
+  uint32_t ticks() const { return ticks_; }
+  uint32_t framesRendered() const { return rendered_; }
+
 private:
+  static const uint8_t MAX_LAYERS = 8;
+
+  bool skipped(const EnhancedLEDEffect* e) const { return solo_ ? e != solo_ : e->exclusive(); }
+
+  // 融合合成：区间外的像素置黑，区间内每个像素依次叠加覆盖它的图层
+  void compose(EnhancedLEDCanvas& canvas) {
+    const EnhancedLEDLayer* layers[MAX_LAYERS];
+    uint8_t count = 0;
+    uint16_t n = canvas.length();
+    uint16_t lo = n, hi = 0;
+    for (auto* e : effects_) {
+      if (&e->canvas() != &canvas || count >= MAX_LAYERS) continue;
+      if (skipped(e)) continue;
+      const EnhancedLEDLayer& l = e->layer();
+      if (l.empty() || l.lo() >= n) continue;
+      if (l.opacity() == 0 && l.blendMode() != EnhancedLEDLayer::BLEND_MULTIPLY) continue;
+      layers[count++] = &l;
+      if (l.lo() < lo) lo = l.lo();
+      if (l.hi() > hi) hi = l.hi();
+    }
+    if (hi > n) hi = n;
+
+    CRGB* out = canvas.leds();
+    canvas.damageComposed(lo, hi);
+    if (lo >= hi) {
+      fill_solid(out, n, CRGB::Black);
+      return;
+    }
+    fill_solid(out, lo, CRGB::Black);
+    fill_solid(out + hi, n - hi, CRGB::Black);
+    for (uint16_t i = lo; i < hi; i++) {
+      CRGB c = CRGB::Black;
+      for (uint8_t k = 0; k < count; k++) {
+        const EnhancedLEDLayer& l = *layers[k];
+        if (i < l.lo() || i >= l.hi()) continue;
+        blend(c, l.at(i), l.blendMode(), l.opacity());
+      }
+      out[i] = c;
+    }
+  }
+
+  static void blend(CRGB& d, const CRGB& s, EnhancedLEDLayer::BlendMode mode, uint8_t opacity) {
+    uint16_t a = opacity + (opacity >> 7); // 0..256
+    for (uint8_t k = 0; k < 3; k++) {
+      int16_t x = d.raw[k], y = s.raw[k];
+      switch (mode) {
+        case EnhancedLEDLayer::BLEND_ADD: {
+          int16_t v = x + ((y * a) >> 8);
+          d.raw[k] = v > 255 ? 255 : (uint8_t)v;
+          break;
+        }
+        case EnhancedLEDLayer::BLEND_MAX: {
+          int16_t v = (y * a) >> 8;
+          if (v > x) d.raw[k] = (uint8_t)v;
+          break;
+        }
+        case EnhancedLEDLayer::BLEND_MULTIPLY: {
+          int16_t f = 256 - ((((int16_t)256 - (y + (y >> 7))) * a) >> 8); // 按不透明度在 1 与本层之间插值
+          d.raw[k] = (uint8_t)((x * f) >> 8);
+          break;
+        }
+        default:
+          d.raw[k] = (uint8_t)(x + (((y - x) * (int16_t)a) >> 8));
+          break;
+      }
+    }
+  }
+
   std::vector<EnhancedLEDCanvas*> canvases_;
   std::vector<EnhancedLEDEffect*> effects_;
+  bool invalid_ = true;
+  EnhancedLEDEffect* solo_ = nullptr;
+  uint32_t ticks_ = 0;
+  uint32_t rendered_ = 0;
 };
 
 /**
  * 增强型LED控制器类
+ * N 为画布容量（编译期），画布与三个效果图层都按 N 定长分配；固件用 EnhancedLEDController（N = LED_CAPACITY）
  */
-class EnhancedLEDController {
+template <uint16_t N>
+class EnhancedLEDControllerT {
 public:
-  EnhancedLEDController(uint16_t ledCount, uint8_t ledPin, OptimizedAudioAnalyzer& analyzer)
+  EnhancedLEDControllerT(uint16_t ledCount, uint8_t ledPin, OptimizedAudioAnalyzer& analyzer)
   : canvas_(ledCount, ledPin), path_(canvas_),
     flow_(path_, /*color*/((uint32_t)255<<16), /*tail*/8, /*interval*/40),
-    point_(path_), audioEff_(path_, analyzer) {}
+    point_(path_), audioEff_(path_, analyzer), external_(path_) { attachLayers(); }
+
+  // 多条灯带：默认路径按逻辑编号贯穿所有通道
+  EnhancedLEDControllerT(const LedChannelConfig* channels, uint8_t channelCount, OptimizedAudioAnalyzer& analyzer)
+  : canvas_(channels, channelCount), path_(canvas_),
+    flow_(path_, /*color*/((uint32_t)255<<16), /*tail*/8, /*interval*/40),
+    point_(path_), audioEff_(path_, analyzer), external_(path_) { attachLayers(); }
 
   void begin() {
     canvas_.begin();
-    // 默认路径: 0..N-1
-    std::vector<uint16_t> nodes; nodes.reserve(canvas_.length());
-    for (uint16_t i=0;i<canvas_.length();++i) nodes.push_back(i);
-    path_.setNodes(nodes);
+    // 默认路径: 恒等 0..N-1（构造时已设置），自定义路线用 path().setTable()
     mgr_.addCanvas(&canvas_);
+    // 图层从下到上：流动、音频、指示点（MAX 叠加，音频模式下也能看到音高命中点）
     mgr_.addEffect(&flow_);
-    mgr_.addEffect(&point_);
     mgr_.addEffect(&audioEff_);
+    mgr_.addEffect(&point_);
+    // 经络系统的外部图层：只在外部模式下独占合成
+    mgr_.addEffect(&external_);
   }
 
   void tick() { mgr_.tick(); }
 
+  // 外部（如经络模式）直接写过灯带后调用，保证下一帧照常发送
+  void requestRefresh() {
+    mgr_.invalidate();
+    canvas_.requestRefresh();
+  }
+
+  /**
+   * 外部图层（经络系统）：外部按逻辑编号直接写 externalLeds()，写完调用 presentExternal()，
+   * 合成后与灯效走同一个 show()，亮度、限流、伽马/抖动与帧统计都一样。
+   * 外部模式下只合成这一层，流动/音频/指示点暂停；退出后它们重新渲染
+   */
+  CRGB* externalLeds() { return external_.layer().leds(); }
+  void setExternalMode(bool on) { mgr_.setSolo(on ? &external_ : nullptr); }
+  bool externalMode() const { return mgr_.solo() == &external_; }
+
+  // 同步合成并发送：经络系统的静态显示在 HTTP 处理中立即可见，同一帧里随后的 tick() 不会重复发送
+  void presentExternal() {
+    external_.touch();
+    mgr_.tick();
+  }
+
+  // 帧统计：tick 次数、重新渲染的帧、实际发送的帧
+  uint32_t ticks() const { return mgr_.ticks(); }
+  uint32_t framesRendered() const { return mgr_.framesRendered(); }
+  uint32_t framesTransmitted() const { return canvas_.framesTransmitted(); }
+
   // Flow controls
   void startFlow() { flow_.start(); }
   void stopFlow() { flow_.stop(); }
@@ -372,10 +979,21 @@ public:
   EnhancedLEDCanvas& canvas() { return canvas_; }
 
 private:
-  EnhancedLEDCanvas canvas_;
+  void attachLayers() {
+    flow_.layer().attach(layerPx_[0], N);
+    audioEff_.layer().attach(layerPx_[1], N);
+    point_.layer().attach(layerPx_[2], N);
+    external_.layer().attach(layerPx_[3], N);
+  }
+
+  FixedLEDCanvas<N> canvas_;
   EnhancedLEDPath path_;
   EnhancedFlowEffect flow_;
   EnhancedPointEffect point_;
   EnhancedAudioEffect audioEff_;
+  EnhancedExternalEffect external_;
   EnhancedEffectManager mgr_;
+  CRGB layerPx_[4][N]; // 流动、音频、指示点、外部图层
 };
+
+typedef EnhancedLEDControllerT<LED_CAPACITY> EnhancedLEDController;
@@ -0,0 +1,148 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * 定点FFT引擎
+ * ESP32-C3 没有硬件浮点单元，ArduinoFFT 的 double 运算全部走软件模拟，
+ * 这里用 Q15 旋转因子/窗函数表 + int32 数据通路实现实数输入FFT。
+ *
+ * - 旋转因子表按 MAX_N 预先计算一次，任意 n <= MAX_N 的变换按步长取表
+ * - 实数FFT 通过 n/2 点复数FFT + 拆分（split）实现，计算量减半
+ * - 输出幅度与 ArduinoFFT Windowing(HANN) + Compute + ComplexToMagnitude 同量纲
+ * - 用汉宁窗而不是汉明窗：远端旁瓣衰减快，响亮的持续音不会在高频 bin 上留下随相位起伏的泄漏
+ */
+template <uint16_t MAX_N>
+class FixedRealFFT {
+public:
+  // 窗函数后保留的额外精度位，避免小信号在 Q15 乘法中被截断
+  static const int GUARD_BITS = 4;
+
+  FixedRealFFT() {
+    for (uint16_t k = 0; k < MAX_N / 2; k++) {
+      float a = 2.0f * (float)M_PI * (float)k / (float)MAX_N;
+      cos_[k] = toQ15(cosf(a));
+      sin_[k] = toQ15(sinf(a));
+    }
+  }
+
+  // 配置实数FFT长度（2的幂，8..MAX_N），并生成对应的汉宁窗表
+  bool begin(uint16_t n) {
+    if (n < 8 || n > MAX_N || (n & (n - 1)) != 0) return false;
+    n_ = n;
+    for (uint16_t i = 0; i < n_ / 2; i++) {
+      float w = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * (float)i / (float)(n_ - 1));
+      win_[i] = toQ15(w);
+    }
+    return true;
+  }
+
+  uint16_t size() const { return n_; }
+
+  /**
+   * 对 n 个有符号样本（已去直流的ADC计数）加窗并计算幅度谱
+   * @param x   输入样本，长度 n
+   * @param mag 输出幅度，长度 n/2
+   */
+  void magnitude(const int16_t* x, uint32_t* mag) {
+    const uint16_t m = n_ / 2;
+
+    // 加窗，同时把偶/奇样本打包成 m 点复数序列
+    for (uint16_t i = 0; i < m; i++) {
+      uint16_t a = 2 * i, b = 2 * i + 1;
+      re_[i] = windowed(x[a], a);
+      im_[i] = windowed(x[b], b);
+    }
+
+    complexTransform(re_, im_, m, false);
+
+    // 拆分：X[k] = Fe[k] + W_n^k * Fo[k]
+    const uint16_t step = MAX_N / n_;
+    for (uint16_t k = 0; k < m; k++) {
+      uint16_t mk = (k == 0) ? 0 : (m - k);
+      int32_t zr = re_[k], zi = im_[k];
+      int32_t cr = re_[mk], ci = -im_[mk];        // conj(Z[m-k])
+
+      int32_t er = (zr + cr) >> 1, ei = (zi + ci) >> 1;   // Fe
+      int32_t orr = (zi - ci) >> 1, oi = (cr - zr) >> 1;  // Fo = -i(Z - conj)/2
+
+      int32_t wr = cos_[k * step], wi = -sin_[k * step];
+      int32_t tr = mulQ15(orr, wr) - mulQ15(oi, wi);
+      int32_t ti = mulQ15(orr, wi) + mulQ15(oi, wr);
+
+      int32_t xr = er + tr, xi = ei + ti;
+      mag[k] = isqrt64((uint64_t)((int64_t)xr * xr) + (uint64_t)((int64_t)xi * xi)) >> GUARD_BITS;
+    }
+  }
+
+  /**
+   * 原地 m 点复数FFT（基2，DIT），m 为2的幂且 <= MAX_N
+   * 正变换不做缩放；逆变换同样不除以 m，由调用方按需归一化
+   */
+  void complexTransform(int32_t* re, int32_t* im, uint16_t m, bool inverse) const {
+    // 位反转重排
+    for (uint16_t i = 1, j = 0; i < m; i++) {
+      uint16_t bit = m >> 1;
+      for (; j & bit; bit >>= 1) j ^= bit;
+      j ^= bit;
+      if (i < j) {
+        int32_t t = re[i]; re[i] = re[j]; re[j] = t;
+        t = im[i]; im[i] = im[j]; im[j] = t;
+      }
+    }
+
+    for (uint16_t len = 2; len <= m; len <<= 1) {
+      const uint16_t half = len >> 1;
+      const uint16_t step = MAX_N / len;
+      for (uint16_t i = 0; i < m; i += len) {
+        for (uint16_t j = 0; j < half; j++) {
+          int32_t wr = cos_[j * step];
+          int32_t wi = inverse ? sin_[j * step] : -sin_[j * step];
+          uint16_t p = i + j, q = p + half;
+          int32_t tr = mulQ15(re[q], wr) - mulQ15(im[q], wi);
+          int32_t ti = mulQ15(re[q], wi) + mulQ15(im[q], wr);
+          re[q] = re[p] - tr; im[q] = im[p] - ti;
+          re[p] += tr;        im[p] += ti;
+        }
+      }
+    }
+  }
+
+  static uint32_t isqrt64(uint64_t v) {
+    // 先把数值缩到32位以内，减少64位循环次数
+    int shift = 0;
+    while (v >> 32) { v >>= 2; shift++; }
+    uint32_t x = (uint32_t)v, res = 0, bit = 1UL << 30;
+    while (bit > x) bit >>= 2;
+    while (bit) {
+      if (x >= res + bit) { x -= res + bit; res = (res >> 1) + bit; }
+      else res >>= 1;
+      bit >>= 2;
+    }
+    return res << shift;
+  }
+
+private:
+  static int16_t toQ15(float v) {
+    int32_t q = (int32_t)lroundf(v * 32768.0f);
+    if (q > 32767) q = 32767;
+    if (q < -32768) q = -32768;
+    return (int16_t)q;
+  }
+
+  static int32_t mulQ15(int32_t a, int32_t b) {
+    return (int32_t)(((int64_t)a * b) >> 15);
+  }
+
+  int32_t windowed(int16_t s, uint16_t i) const {
+    uint16_t wi = (i < n_ / 2) ? i : (n_ - 1 - i);   // 窗函数对称，只存一半
+    return ((int32_t)s * win_[wi]) >> (15 - GUARD_BITS);
+  }
+
+  uint16_t n_ = 0;
+  int16_t cos_[MAX_N / 2];
+  int16_t sin_[MAX_N / 2];
+  int16_t win_[MAX_N / 2];
+  int32_t re_[MAX_N / 2];
+  int32_t im_[MAX_N / 2];
+};
@@ -0,0 +1,231 @@
+#pragma once
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#endif
+
+/**
+ * 固定步长帧调度器
+ * loop() 每圈调用 service()：未到下一帧时精确睡眠（esp_timer 单次定时唤醒 loop 任务，不忙等），
+ * 到期时按注册顺序运行各帧作业（灯带渲染、经络动画等），记录帧耗时并与渲染期限比较。
+ *
+ * 睡眠最长 MAX_SLEEP_US，到点即使帧未到期也返回，让 loop 继续处理按钮和网页请求。
+ * 某一帧开始得太晚（落后一个周期以上）时丢弃错过的帧位、不连续补帧；
+ * 动画都以 millis() 计时，下一帧按当前时间绘制，相当于在丢弃的帧之间插值。
+ *
+ * 统计按约 STATS_WINDOW_US 的窗口汇总：实际帧率、帧耗时 p50/p95/p99/最大值（100µs 分辨率的直方图）、
+ * 超过期限的帧与丢弃的帧位；只在 loop 任务中读写，网页处理也在 loop 中，无需同步。
+ */
+class FrameScheduler {
+public:
+  typedef void (*JobFn)();
+
+  static const uint8_t MAX_JOBS = 4;
+  static const uint32_t MAX_SLEEP_US = 5000;       // 单次睡眠上限，按钮与网页至少 200Hz 处理一次
+  static const uint32_t STATS_WINDOW_US = 2000000;
+  static const uint16_t HIST_BUCKETS = 256;        // 帧耗时直方图：每格 100µs，最后一格收集 25.5ms 以上
+  static const uint16_t HIST_US = 100;
+
+  struct Stats {
+    float fps = 0.0f;        // 最近一个窗口的实际帧率
+    uint32_t p50Us = 0, p95Us = 0, p99Us = 0, maxUs = 0; // 最近一个窗口的帧耗时（所有作业合计）
+    uint32_t frames = 0;     // 累计帧数
+    uint32_t missed = 0;     // 累计：耗时超过渲染期限的帧
+    uint32_t skipped = 0;    // 累计：因开始太晚而丢弃的帧位
+    uint32_t maxLateUs = 0;  // 最近一个窗口内帧开始的最大延迟
+  };
+
+  // 目标帧率（1..500），渲染期限默认等于帧周期
+  void setTargetFps(uint16_t fps) {
+    if (fps < 1) fps = 1;
+    if (fps > 500) fps = 500;
+    fps_ = fps;
+    periodUs_ = 1000000u / fps;
+    if (!customDeadline_) deadlineUs_ = periodUs_;
+  }
+  uint16_t targetFps() const { return fps_; }
+  uint32_t periodUs() const { return periodUs_; }
+
+  // 单帧渲染期限（µs），0 表示回到帧周期
+  void setDeadlineUs(uint32_t us) {
+    customDeadline_ = us != 0;
+    deadlineUs_ = us ? us : periodUs_;
+  }
+  uint32_t deadlineUs() const { return deadlineUs_; }
+
+  // 注册帧作业，divider 为每几帧运行一次；返回作业编号，满了返回 -1
+  int8_t addJob(const char* name, JobFn fn, uint8_t divider = 1) {
+    if (jobCount_ >= MAX_JOBS || !fn) return -1;
+    Job& j = jobs_[jobCount_];
+    j.name = name;
+    j.fn = fn;
+    j.divider = divider ? divider : 1;
+    j.enabled = true;
+    return (int8_t)jobCount_++;
+  }
+
+  void setJobEnabled(int8_t id, bool on) {
+    if (id >= 0 && id < jobCount_) jobs_[id].enabled = on;
+  }
+
+  uint8_t jobCount() const { return jobCount_; }
+  const char* jobName(uint8_t id) const { return id < jobCount_ ? jobs_[id].name : ""; }
+  bool jobEnabled(uint8_t id) const { return id < jobCount_ && jobs_[id].enabled; }
+  uint32_t jobLastUs(uint8_t id) const { return id < jobCount_ ? jobs_[id].lastUs : 0; }
+  uint32_t jobMaxUs(uint8_t id) const { return id < jobCount_ ? jobs_[id].maxUs : 0; }
+
+  void begin() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (!timer_) {
+      waiter_ = xTaskGetCurrentTaskHandle();
+      esp_timer_create_args_t args = {};
+      args.callback = onTimer;
+      args.arg = this;
+      args.dispatch_method = ESP_TIMER_TASK;
+      args.name = "frame";
+      if (esp_timer_create(&args, &timer_) != ESP_OK) timer_ = nullptr;
+    }
+#endif
+    next_ = micros();
+    windowStartUs_ = next_;
+    clearWindow();
+  }
+
+  /**
+   * 在 loop() 末尾调用（替代原来的 delay(2)）
+   * 返回 true 表示本次运行了一帧
+   */
+  bool service() {
+    uint32_t now = micros();
+    int32_t until = (int32_t)(next_ - now);
+    if (until > 0) {
+      uint32_t us = (uint32_t)until;
+      if (us > MAX_SLEEP_US) us = MAX_SLEEP_US;
+      sleepFor(us);
+      now = micros();
+      if ((int32_t)(next_ - now) > 0) return false;
+    }
+    runFrame(now);
+    return true;
+  }
+
+  // 最近一个完整窗口的统计（第一个窗口结束前只有累计值）
+  const Stats& stats() const { return stats_; }
+
+private:
+  struct Job {
+    const char* name = "";
+    JobFn fn = nullptr;
+    uint8_t divider = 1;
+    bool enabled = false;
+    uint32_t lastUs = 0;
+    uint32_t maxUs = 0;
+  };
+
+  void runFrame(uint32_t now) {
+    uint32_t late = now - next_;
+    if (late >= periodUs_) {
+      // 落后一个周期以上：丢弃错过的帧位，按当前时间重新对齐
+      uint32_t slots = late / periodUs_;
+      stats_.skipped += slots;
+      next_ += slots * periodUs_;
+      late -= slots * periodUs_;
+    }
+    next_ += periodUs_;
+    if (late > winMaxLate_) winMaxLate_ = late;
+
+    uint32_t t0 = micros();
+    for (uint8_t i = 0; i < jobCount_; i++) {
+      Job& j = jobs_[i];
+      if (!j.enabled || frameIndex_ % j.divider != 0) continue;
+      uint32_t s = micros();
+      j.fn();
+      j.lastUs = micros() - s;
+      if (j.lastUs > j.maxUs) j.maxUs = j.lastUs;
+    }
+    uint32_t end = micros();
+    uint32_t dt = end - t0;
+    frameIndex_++;
+    stats_.frames++;
+    if (dt > deadlineUs_) stats_.missed++;
+
+    uint32_t b = dt / HIST_US;
+    if (b >= HIST_BUCKETS) b = HIST_BUCKETS - 1;
+    hist_[b]++;
+    winFrames_++;
+    if (dt > winMax_) winMax_ = dt;
+
+    uint32_t span = end - windowStartUs_;
+    if (span >= STATS_WINDOW_US) {
+      stats_.fps = (float)winFrames_ * 1e6f / (float)span;
+      stats_.p50Us = percentile(50);
+      stats_.p95Us = percentile(95);
+      stats_.p99Us = percentile(99);
+      stats_.maxUs = winMax_;
+      stats_.maxLateUs = winMaxLate_;
+      windowStartUs_ = end;
+      clearWindow();
+    }
+  }
+
+  // 直方图第 pct 百分位所在格的上沿
+  uint32_t percentile(uint8_t pct) const {
+    uint32_t want = (winFrames_ * pct + 99) / 100;
+    uint32_t acc = 0;
+    for (uint16_t i = 0; i < HIST_BUCKETS; i++) {
+      acc += hist_[i];
+      if (acc >= want) return (uint32_t)(i + 1) * HIST_US;
+    }
+    return (uint32_t)HIST_BUCKETS * HIST_US;
+  }
+
+  void clearWindow() {
+    memset(hist_, 0, sizeof(hist_));
+    winFrames_ = 0;
+    winMax_ = 0;
+    winMaxLate_ = 0;
+  }
+
+#if defined(ARDUINO_ARCH_ESP32)
+  static void onTimer(void* arg) { xTaskNotifyGive(static_cast<FrameScheduler*>(arg)->waiter_); }
+
+  // 单次定时器唤醒 loop 任务，精度为几十微秒；超时保护防止定时器失效时永久阻塞
+  void sleepFor(uint32_t us) {
+    if (!timer_ || us < MIN_TIMER_US) {
+      delayMicroseconds(us);
+      return;
+    }
+    esp_timer_stop(timer_);
+    ulTaskNotifyTake(pdTRUE, 0); // 清掉上一次超时后才到达的通知
+    if (esp_timer_start_once(timer_, us) != ESP_OK) {
+      delayMicroseconds(us);
+      return;
+    }
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(us / 1000 + 2));
+  }
+
+  static const uint32_t MIN_TIMER_US = 100; // 更短的等待直接忙等
+
+  esp_timer_handle_t timer_ = nullptr;
+  TaskHandle_t waiter_ = nullptr;
+#else
+  void sleepFor(uint32_t us) { delayMicroseconds(us); }
+#endif
+
+  Job jobs_[MAX_JOBS];
+  uint8_t jobCount_ = 0;
+  uint16_t fps_ = 60;
+  uint32_t periodUs_ = 1000000u / 60;
+  uint32_t deadlineUs_ = 1000000u / 60;
+  bool customDeadline_ = false;
+  uint32_t next_ = 0;
+  uint32_t frameIndex_ = 0;
+
+  Stats stats_;
+  uint32_t windowStartUs_ = 0;
+  uint16_t hist_[HIST_BUCKETS];
+  uint32_t winFrames_ = 0;
+  uint32_t winMax_ = 0;
+  uint32_t winMaxLate_ = 0;
+};
@@ -0,0 +1,180 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * Goertzel 目标音检测滤波器组
+ * 仅在目标音附近放置少量频点：目标基频、左右各偏 2×容差 的两个“邻居”、以及 2/3 次谐波。
+ * 每个样本只做 K 次整数乘加，分块结束时比较各频点能量：
+ *   - 基频能量大于两个邻居 => 输入落在 ±容差 之内（判决边界正好在容差处）
+ *   - 目标音及其谐波能量占整块能量的比例作为置信度
+ * 与完整 FFT + 音高估计相比，音高武装模式只需很小一部分CPU，且每块（数十毫秒）即可给出结果。
+ */
+class GoertzelBank {
+public:
+  // 命中事件
+  struct Hit {
+    float confidence = 0.0f; // 目标音（含谐波）能量占比 0..1
+    float centsHint = 0.0f;  // 由邻居能量差粗略估计的偏差方向（负=偏低，正=偏高）
+  };
+
+  /**
+   * 重新调谐
+   * @param targetHz 目标音高
+   * @param tolCents 容差（音分）
+   * @param fs       采样率
+   */
+  bool tune(float targetHz, float tolCents, float fs) {
+    active_ = false;
+    if (targetHz <= 0 || fs <= 0 || targetHz >= fs * 0.5f) return false;
+    if (tolCents < 5.0f) tolCents = 5.0f;
+    targetHz_ = targetHz;
+    tolCents_ = tolCents;
+    fs_ = fs;
+
+    const float spread = powf(2.0f, 2.0f * tolCents / 1200.0f);
+    float freqs[MAX_FILTERS];
+    freqs[TARGET] = targetHz;
+    freqs[BELOW] = targetHz / spread;
+    freqs[ABOVE] = targetHz * spread;
+    freqs[HARM2] = targetHz * 2.0f;
+    freqs[HARM3] = targetHz * 3.0f;
+
+    // 块长需要足以分辨目标与邻居：主瓣宽度 fs/N 不大于两者间距
+    float gap = freqs[ABOVE] - targetHz;
+    if (targetHz - freqs[BELOW] < gap) gap = targetHz - freqs[BELOW];
+    float n = fs / gap;
+    if (n < MIN_BLOCK) n = MIN_BLOCK;
+    if (n > MAX_BLOCK) n = MAX_BLOCK;
+    blockLen_ = (uint16_t)(n + 0.5f);
+
+    for (uint8_t k = 0; k < MAX_FILTERS; k++) {
+      // 超过奈奎斯特频率的谐波不参与
+      enabled_[k] = freqs[k] < fs * 0.5f;
+      float w = 2.0f * (float)M_PI * freqs[k] / fs;
+      coeff_[k] = (int32_t)(2.0f * cosf(w) * (float)(1 << COEFF_BITS) + 0.5f);
+      cosW_[k] = cosf(w);
+    }
+    reset();
+    active_ = true;
+    return true;
+  }
+
+  // 最低电平（去直流后的 RMS，ADC计数），低于此值的块不触发命中，避免静音时误报
+  void setMinLevel(uint16_t rms) { minLevel_ = rms; }
+
+  bool active() const { return active_; }
+  void disable() {
+    active_ = false;
+    hitHead_ = 0;
+    hitCount_ = 0;
+  }
+
+  float targetHz() const { return targetHz_; }
+  float tolCents() const { return tolCents_; }
+  uint16_t blockLen() const { return blockLen_; }
+
+  // 逐样本处理（去直流后的有符号样本）
+  void push(int16_t x) {
+    if (!active_) return;
+    for (uint8_t k = 0; k < MAX_FILTERS; k++) {
+      int32_t s = x + (int32_t)(((int64_t)coeff_[k] * s1_[k]) >> COEFF_BITS) - s2_[k];
+      s2_[k] = s1_[k];
+      s1_[k] = s;
+    }
+    energy_ += (uint64_t)((int32_t)x * x);
+    if (++count_ >= blockLen_) finishBlock();
+  }
+
+  // 按发生顺序取走一个命中事件，没有时返回 false；一次处理多块时可能积压多个，调用方应循环取空
+  bool takeHit(Hit& out) {
+    if (hitCount_ == 0) return false;
+    out = hitQueue_[hitHead_];
+    hitHead_ = (uint8_t)((hitHead_ + 1) % HIT_QUEUE);
+    hitCount_--;
+    return true;
+  }
+
+  // 最近一块的置信度（无论是否命中）
+  float lastConfidence() const { return lastConf_; }
+  uint32_t blocks() const { return blocks_; }
+  uint32_t hits() const { return hits_; }           // 累计命中块数（含队列满时丢掉的事件）
+  uint32_t hitsDropped() const { return hitsDropped_; }
+
+private:
+  enum { TARGET = 0, BELOW, ABOVE, HARM2, HARM3, MAX_FILTERS };
+  static const int COEFF_BITS = 20;
+  static const uint16_t MIN_BLOCK = 128;
+  static const uint16_t MAX_BLOCK = 2048;
+  // 命中队列：分析器每次 tick 最多处理 MAX_WINDOW（512）个样本，最短块 128 个，最多 4 次命中，留一倍余量
+  static const uint8_t HIT_QUEUE = 8;
+
+  void reset() {
+    for (uint8_t k = 0; k < MAX_FILTERS; k++) { s1_[k] = 0; s2_[k] = 0; }
+    energy_ = 0;
+    count_ = 0;
+  }
+
+  // 分块结束：计算各频点能量 |X|² = s1² + s2² - 2cos(w)·s1·s2
+  void finishBlock() {
+    float p[MAX_FILTERS];
+    for (uint8_t k = 0; k < MAX_FILTERS; k++) {
+      if (!enabled_[k]) { p[k] = 0.0f; continue; }
+      float a = (float)s1_[k], b = (float)s2_[k];
+      p[k] = a * a + b * b - 2.0f * cosW_[k] * a * b;
+      if (p[k] < 0.0f) p[k] = 0.0f;
+    }
+    blocks_++;
+
+    // 纯正弦在整块上的 |X|² ≈ (A·N/2)²，整块能量 ≈ A²·N/2，故 2|X|²/(N·E) ≈ 1
+    float e = (float)energy_ * (float)count_;
+    float conf = e > 0.0f ? 2.0f * (p[TARGET] + p[HARM2] + p[HARM3]) / e : 0.0f;
+    if (conf > 1.0f) conf = 1.0f;
+    lastConf_ = conf;
+
+    const bool loudEnough = energy_ >= (uint64_t)minLevel_ * minLevel_ * count_;
+    if (loudEnough && p[TARGET] > p[BELOW] && p[TARGET] > p[ABOVE]) {
+      Hit hit;
+      hit.confidence = conf;
+      float side = p[ABOVE] + p[BELOW];
+      hit.centsHint = side > 0.0f ? tolCents_ * (p[ABOVE] - p[BELOW]) / side : 0.0f;
+      pushHit(hit);
+    }
+    reset();
+  }
+
+  // 队列满时丢掉最早的事件，保留最新的
+  void pushHit(const Hit& hit) {
+    hits_++;
+    if (hitCount_ == HIT_QUEUE) {
+      hitHead_ = (uint8_t)((hitHead_ + 1) % HIT_QUEUE);
+      hitCount_--;
+      hitsDropped_++;
+    }
+    hitQueue_[(hitHead_ + hitCount_) % HIT_QUEUE] = hit;
+    hitCount_++;
+  }
+
+  bool active_ = false;
+  float targetHz_ = 0.0f;
+  float tolCents_ = 50.0f;
+  float fs_ = 8000.0f;
+  uint16_t blockLen_ = MIN_BLOCK;
+  uint16_t count_ = 0;
+  uint16_t minLevel_ = 40; // 约满量程的 2%
+
+  bool enabled_[MAX_FILTERS] = {};
+  int32_t coeff_[MAX_FILTERS] = {};   // 2cos(w)，Q20（低频处 Q14 会带来数音分的调谐误差）
+  float cosW_[MAX_FILTERS] = {};
+  int32_t s1_[MAX_FILTERS] = {};
+  int32_t s2_[MAX_FILTERS] = {};
+  uint64_t energy_ = 0;
+
+  Hit hitQueue_[HIT_QUEUE];
+  uint8_t hitHead_ = 0;
+  uint8_t hitCount_ = 0;
+  uint32_t hits_ = 0;
+  uint32_t hitsDropped_ = 0;
+  float lastConf_ = 0.0f;
+  uint32_t blocks_ = 0;
+};
@@ -0,0 +1,166 @@
+#pragma once
+#include <FastLED.h>
+
+/**
+ * 灯带输出级：伽马校正 + 亮度/功率缩放 + 时间抖动，一次整数遍历写入发送缓冲
+ *
+ * 原来由 FastLED.show(亮度) 在 8 位域里做 scale8：亮度 60 时输入 0..255 只剩约 60 级，
+ * 流动拖尾和经络渐变的暗端出现明显台阶，也没有伽马校正（输入值与人眼亮度不成比例）。
+ *
+ * 这里每个通道先查 16 位线性表（8.8 定点，gamma16[v] = 255.0 × (v/255)^γ，编译期生成），
+ * 乘以 16 位缩放（亮度 × 功率缩放），得到 8.8 定点的输出值；
+ * 小数部分进每颗灯每个通道的误差累加器（一阶 sigma-delta）：累加溢出时这一帧输出高一级，
+ * 多帧平均后等于精确值，暗处也能分出 8 位以下的亮度。发送时 FastLED 亮度固定为 255。
+ *
+ * 静止画面里只要还有像素带小数，dithering() 为 true，画布就继续逐帧发送让抖动生效：低亮度的静止画面
+ * （经络静态显示）几乎总带小数，所以默认一直发送。画布关闭静止抖动（setStaticDither(false)）时只在内容变化后
+ * 发送有限的几帧，之后以 dither = false 发一帧四舍五入的结果收敛（dithering() 变为 false），省下传输，
+ * 但静止的暗部回到 8 位台阶——两者是画质与每帧传输之间的取舍。
+ * 各通道的 γ（×100）可在 platformio.ini 的 build_flags 中用 LED_GAMMA_R/G/B 覆盖
+ */
+#ifndef LED_GAMMA_R
+#define LED_GAMMA_R 220
+#endif
+#ifndef LED_GAMMA_G
+#define LED_GAMMA_G 220
+#endif
+#ifndef LED_GAMMA_B
+#define LED_GAMMA_B 220
+#endif
+
+// 编译期 x^γ：ln 先把 x 折到 [0.5, 1) 再用 atanh 级数，exp 先对半缩小到 |z| ≤ 0.5 再用泰勒级数
+struct LedGammaMath {
+  static constexpr double LN2 = 0.69314718055994530942;
+
+  static constexpr uint16_t FULL = 255 << 8; // 8.8 定点的 255.0
+
+  static constexpr double sq(double x) { return x * x; }
+
+  static constexpr double atanhSeries(double y2, double p, int k) {
+    return k > 30 ? 0.0 : p / (2 * k + 1) + atanhSeries(y2, p * y2, k + 1);
+  }
+  static constexpr double lnReduced(double y) { return 2.0 * atanhSeries(y * y, y, 0); }
+  // x ∈ (0, 1]
+  static constexpr double ln(double x) { return x < 0.5 ? ln(x * 2.0) - LN2 : lnReduced((x - 1.0) / (x + 1.0)); }
+
+  static constexpr double expSeries(double z, double term, int k) {
+    return k > 20 ? 0.0 : term + expSeries(z, term * z / (k + 1), k + 1);
+  }
+  // z ≤ 0
+  static constexpr double exp(double z) { return z < -0.5 ? sq(exp(z * 0.5)) : expSeries(z, 1.0, 0); }
+
+  static constexpr uint16_t gamma16(uint16_t v, uint16_t g100) {
+    return v == 0 ? 0 : v >= 255 ? FULL : (uint16_t)(FULL * exp(g100 / 100.0 * ln(v / 255.0)) + 0.5);
+  }
+};
+
+template <uint16_t... I> struct LedIndexSeq {};
+template <uint16_t N, uint16_t... I> struct LedMakeIndexSeq : LedMakeIndexSeq<N - 1, N - 1, I...> {};
+template <uint16_t... I> struct LedMakeIndexSeq<0, I...> { typedef LedIndexSeq<I...> type; };
+
+// 256 项 16 位伽马表，G100 = γ × 100（100 为线性表 v × 256）；常量表，放在 flash
+template <uint16_t G100, typename Seq = typename LedMakeIndexSeq<256>::type> struct LedGammaTable;
+template <uint16_t G100, uint16_t... I> struct LedGammaTable<G100, LedIndexSeq<I...> > {
+  static constexpr uint16_t table[256] = { LedGammaMath::gamma16(I, G100)... };
+};
+template <uint16_t G100, uint16_t... I>
+constexpr uint16_t LedGammaTable<G100, LedIndexSeq<I...> >::table[256];
+
+class LedOutputStage {
+public:
+  LedOutputStage() { setGamma(true); }
+
+  // 误差累加器：每颗灯 3 字节，由画布按容量提供
+  void attach(uint8_t* err, uint16_t capacity) {
+    err_ = err;
+    capacity_ = err ? capacity : 0;
+    if (err_) memset(err_, 0, capacity_ * 3);
+  }
+
+  void setGamma(bool on) {
+    gamma_ = on;
+    if (on) {
+      r_ = LedGammaTable<LED_GAMMA_R>::table;
+      g_ = LedGammaTable<LED_GAMMA_G>::table;
+      b_ = LedGammaTable<LED_GAMMA_B>::table;
+    } else {
+      r_ = g_ = b_ = LedGammaTable<100>::table;
+    }
+  }
+  bool gamma() const { return gamma_; }
+
+  void setDither(bool on) {
+    dither_ = on;
+    if (!on) dithering_ = false;
+  }
+  bool dither() const { return dither_; }
+
+  // 上一次输出有像素带小数：静止画面也需要继续发送，抖动才能生效
+  bool dithering() const { return dithering_; }
+
+  // 伽马校正后的通道负载（8.8 线性值之和，每颗灯每通道满幅 LedGammaMath::FULL），用于电流估计：
+  // addLoad 把 [lo, hi) 的像素加进 sum[3]，subLoad 减掉，画布据此按脏区增量维护
+  void addLoad(const CRGB* src, uint16_t lo, uint16_t hi, uint32_t sum[3]) const {
+    for (uint16_t i = lo; i < hi; i++) {
+      sum[0] += r_[src[i].r];
+      sum[1] += g_[src[i].g];
+      sum[2] += b_[src[i].b];
+    }
+  }
+
+  void subLoad(const CRGB* src, uint16_t lo, uint16_t hi, uint32_t sum[3]) const {
+    for (uint16_t i = lo; i < hi; i++) {
+      sum[0] -= r_[src[i].r];
+      sum[1] -= g_[src[i].g];
+      sum[2] -= b_[src[i].b];
+    }
+  }
+
+  /**
+   * src（逻辑顺序）→ dst（发送缓冲）：map 为空时按原位置写，否则写到 dst[map[i]]
+   * scale 为 16 位缩放，65535 = 满亮度（亮度 b 对应 b × 257）；dither 为 false 时这一帧四舍五入、不抖动
+   */
+  void process(const CRGB* src, CRGB* dst, const uint16_t* map, uint16_t n, uint16_t scale, bool dither = true) {
+    uint8_t frac = 0;
+    dither = dither && dither_ && err_;
+    if (dither && n > capacity_) n = capacity_;
+    for (uint16_t i = 0; i < n; i++) {
+      const CRGB& s = src[i];
+      CRGB& d = dst[map ? map[i] : i];
+      if (dither) {
+        uint8_t* e = err_ + i * 3;
+        d.r = ditherOut(r_[s.r], scale, e[0], frac);
+        d.g = ditherOut(g_[s.g], scale, e[1], frac);
+        d.b = ditherOut(b_[s.b], scale, e[2], frac);
+      } else {
+        d.r = roundOut(r_[s.r], scale);
+        d.g = roundOut(g_[s.g], scale);
+        d.b = roundOut(b_[s.b], scale);
+      }
+    }
+    dithering_ = dither && frac != 0;
+  }
+
+private:
+  // 8.8 定点：高字节是输出，低字节是小数；scale 取 65535 时原样输出（最大 255.0），加误差后也不会溢出 8 位
+  static uint16_t scaled(uint16_t lin, uint16_t scale) { return (uint16_t)(((uint32_t)lin * (scale + 1u)) >> 16); }
+
+  static uint8_t roundOut(uint16_t lin, uint16_t scale) { return (uint8_t)((scaled(lin, scale) + 0x80u) >> 8); }
+
+  static uint8_t ditherOut(uint16_t lin, uint16_t scale, uint8_t& err, uint8_t& frac) {
+    uint16_t v = scaled(lin, scale);
+    frac |= (uint8_t)v;
+    v += err;
+    err = (uint8_t)v;
+    return (uint8_t)(v >> 8);
+  }
+
+  const uint16_t* r_ = nullptr;
+  const uint16_t* g_ = nullptr;
+  const uint16_t* b_ = nullptr;
+  uint8_t* err_ = nullptr;
+  uint16_t capacity_ = 0;
+  bool gamma_ = true;
+  bool dither_ = true;
+  bool dithering_ = false;
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <FastLED.h>
+#include <vector>
+
+/**
+ * 256 项调色板
+ * 把逐像素的颜色计算（色轮分支、CHSV 转换、浮点除法）换成一次查表。
+ * 调色板在第一次使用或参数变化时由生成函数填满，version() 随每次重建递增，
+ * 依赖它的渐变缓存据此判断是否需要重建。
+ *
+ * 共享调色板（函数内静态对象，第一次调用时生成，约 0.8KB）：
+ *   rainbow()  CHSV(i, 255, 255) 经 hsv2rgb_rainbow 的结果，与直接写 CHSV 的颜色完全相同
+ *   wheel()    流动效果原来的三段色轮（红→绿→蓝→红）
+ */
+class LedPalette {
+public:
+  typedef CRGB (*Generator)(uint8_t index);
+
+  LedPalette() {}
+  explicit LedPalette(Generator g) { build(g); }
+
+  void build(Generator g) {
+    for (uint16_t i = 0; i < 256; i++) entries_[i] = g((uint8_t)i);
+    version_++;
+  }
+
+  const CRGB& operator[](uint8_t index) const { return entries_[index]; }
+  uint16_t version() const { return version_; }
+
+  static const LedPalette& rainbow() {
+    static const LedPalette p(rainbowAt);
+    return p;
+  }
+
+  static const LedPalette& wheel() {
+    static const LedPalette p(wheelAt);
+    return p;
+  }
+
+  static CRGB rainbowAt(uint8_t hue) {
+    CRGB rgb;
+    hsv2rgb_rainbow(CHSV(hue, 255, 255), rgb);
+    return rgb;
+  }
+
+  static CRGB wheelAt(uint8_t pos) {
+    pos = 255 - pos;
+    if (pos < 85) return CRGB(255 - pos * 3, pos * 3, 0);
+    if (pos < 170) {
+      pos -= 85;
+      return CRGB(0, pos * 3, 255 - pos * 3);
+    }
+    pos -= 170;
+    return CRGB(pos * 3, 0, 255 - pos * 3);
+  }
+
+private:
+  CRGB entries_[256];
+  uint16_t version_ = 0;
+};
+
+/**
+ * 按灯带长度展开的渐变缓存
+ * 第 i 颗灯取 palette[⌊from + (to - from) × i / n⌋]（与原来逐灯计算的浮点截断一致），
+ * 只有长度、调色板（或其版本）、起止索引变化时才重建，其余帧直接返回缓存
+ */
+class GradientCache {
+public:
+  const CRGB* get(const LedPalette& palette, uint8_t from, uint8_t to, uint16_t n) {
+    if (n != n_ || &palette != palette_ || palette.version() != version_ || from != from_ || to != to_) {
+      rebuild(palette, from, to, n);
+    }
+    return colors_.empty() ? nullptr : colors_.data();
+  }
+
+  uint32_t rebuilds() const { return rebuilds_; }
+
+private:
+  void rebuild(const LedPalette& palette, uint8_t from, uint8_t to, uint16_t n) {
+    colors_.resize(n);
+    int32_t span = (int32_t)to - (int32_t)from;
+    for (uint16_t i = 0; i < n; i++) {
+      int32_t num = span * (int32_t)i;
+      int32_t step = num >= 0 ? num / n : -((-num + n - 1) / n); // 向下取整
+      colors_[i] = palette[(uint8_t)(from + step)];
+    }
+    palette_ = &palette;
+    version_ = palette.version();
+    from_ = from;
+    to_ = to;
+    n_ = n;
+    rebuilds_++;
+  }
+
+  std::vector<CRGB> colors_;
+  const LedPalette* palette_ = nullptr;
+  uint16_t version_ = 0;
+  uint16_t n_ = 0;
+  uint8_t from_ = 0, to_ = 0;
+  uint32_t rebuilds_ = 0;
+};
@@ -0,0 +1,152 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * 灯带功率模型
+ * 电流 = 静态电流 × 灯数 + Σ 通道满占空比电流 × 通道负载 × 输出缩放
+ *   通道负载：该通道伽马校正后的线性亮度之和（LedOutputStage 的 8.8 定点，满幅 LedGammaMath::FULL），
+ *             由画布按脏区增量维护，这里只拿三个总和
+ *   输出缩放：亮度与限流合成的 16 位系数，估计值按实际发送的亮度计算（原来按亮度 255 估计）
+ *   静态电流：WS2812 驱动芯片全黑时也有约 0.6mA，160 颗就是近 100mA
+ *
+ * 限流：请求亮度下的估计超过 limit 时，按 (limit − 静态) / 动态 求出允许的缩放。
+ * 变暗立即生效（保护电源），恢复每帧走剩余差距的 30%，避免在限值附近来回跳。
+ *
+ * 历史：每秒一个样本（平均/峰值 mA，保留 60 秒）、每分钟一个样本（保留 60 分钟），
+ * 另累计电荷与能量（按供电电压换算 Wh）
+ */
+class LedPowerModel {
+public:
+  static const uint8_t HISTORY = 60;
+
+  struct Sample {
+    uint16_t avg_mA;
+    uint16_t peak_mA;
+  };
+
+  // 单颗灯 R/G/B 满占空比电流与静态电流（µA）
+  void setCalibration(uint16_t r_uA, uint16_t g_uA, uint16_t b_uA, uint16_t idle_uA) {
+    channel_uA_[0] = r_uA;
+    channel_uA_[1] = g_uA;
+    channel_uA_[2] = b_uA;
+    idle_uA_ = idle_uA;
+  }
+
+  // 原来的单一参数：全白时每颗灯的电流，三个通道平分（静态电流不变）
+  void setLedFull(uint8_t mA) {
+    uint16_t each = (uint16_t)((uint32_t)mA * 1000u / 3u);
+    setCalibration(each, each, each, idle_uA_);
+  }
+
+  uint16_t channel_uA(uint8_t c) const { return channel_uA_[c < 3 ? c : 0]; }
+  uint16_t idle_uA() const { return idle_uA_; }
+
+  void setSupply_mV(uint16_t mV) { supply_mV_ = mV ? mV : 5000; }
+  uint16_t supply_mV() const { return supply_mV_; }
+
+  /**
+   * 每帧调用一次：load 为三个通道的负载，requested 为亮度换算的 16 位缩放（亮度 b 对应 b × 257）
+   * 返回限流后实际使用的缩放
+   */
+  uint16_t update(const uint32_t load[3], uint16_t leds, uint16_t requested, uint16_t limit_mA, uint32_t nowMs) {
+    float idle = (float)idle_uA_ * leds / 1000.0f;
+    float dyn = 0;
+    for (uint8_t c = 0; c < 3; c++) dyn += (float)channel_uA_[c] * (float)load[c];
+    dyn /= 1000.0f * (float)(255u << 8);
+
+    float k = (requested + 1.0f) / 65536.0f;
+    float target = k;
+    requested_mA_ = idle + dyn * k;
+    if (limit_mA > 0 && requested_mA_ > (float)limit_mA) {
+      target = dyn > 0 ? ((float)limit_mA - idle) / dyn : k;
+      if (target < 0) target = 0;
+      if (target > k) target = k;
+    }
+
+    if (target <= applied_) {
+      applied_ = target;
+    } else {
+      applied_ += (target - applied_) * 0.3f;
+      if ((target - applied_) * 65536.0f < 32.0f) applied_ = target;
+    }
+    limited_ = applied_ < k;
+    estimate_mA_ = idle + dyn * applied_;
+
+    record(nowMs);
+
+    float s = applied_ * 65536.0f - 0.5f;
+    if (s < 0) s = 0;
+    if (s > 65535.0f) s = 65535.0f;
+    return (uint16_t)s;
+  }
+
+  float estimate_mA() const { return estimate_mA_; }    // 本帧（按实际缩放）
+  float requested_mA() const { return requested_mA_; }  // 本帧在请求亮度下（限流前）
+  bool limited() const { return limited_; }
+
+  // 开机以来累计
+  float mAh() const { return (float)(charge_uAms_ / 3600000ull) / 1000.0f; }
+  float Wh() const { return mAh() * supply_mV_ / 1000000.0f; }
+
+  // age = 0 为最近一个完整的秒/分钟
+  uint8_t secondCount() const { return secCount_; }
+  uint8_t minuteCount() const { return minCount_; }
+  const Sample& second(uint8_t age) const { return seconds_[(uint8_t)(secHead_ + HISTORY - 1 - age) % HISTORY]; }
+  const Sample& minute(uint8_t age) const { return minutes_[(uint8_t)(minHead_ + HISTORY - 1 - age) % HISTORY]; }
+
+private:
+  void record(uint32_t nowMs) {
+    uint32_t dt = started_ ? nowMs - lastMs_ : 0;
+    started_ = true;
+    lastMs_ = nowMs;
+    charge_uAms_ += (uint64_t)(estimate_mA_ * 1000.0f) * dt;
+
+    secSum_ += estimate_mA_ * dt;
+    secMs_ += dt;
+    if (estimate_mA_ > secPeak_) secPeak_ = estimate_mA_;
+    if (secMs_ < 1000) return;
+
+    push(seconds_, secHead_, secCount_, secSum_ / secMs_, secPeak_);
+    minSum_ += secSum_;
+    minMs_ += secMs_;
+    if (secPeak_ > minPeak_) minPeak_ = secPeak_;
+    secSum_ = 0;
+    secMs_ = 0;
+    secPeak_ = 0;
+    if (minMs_ < 60000) return;
+
+    push(minutes_, minHead_, minCount_, minSum_ / minMs_, minPeak_);
+    minSum_ = 0;
+    minMs_ = 0;
+    minPeak_ = 0;
+  }
+
+  static void push(Sample* ring, uint8_t& head, uint8_t& count, float avg, float peak) {
+    ring[head].avg_mA = clamp16(avg);
+    ring[head].peak_mA = clamp16(peak);
+    head = (uint8_t)((head + 1) % HISTORY);
+    if (count < HISTORY) count++;
+  }
+
+  static uint16_t clamp16(float v) { return v >= 65535.0f ? 65535 : (uint16_t)(v + 0.5f); }
+
+  uint16_t channel_uA_[3] = { 20000, 20000, 20000 };
+  uint16_t idle_uA_ = 600;
+  uint16_t supply_mV_ = 5000;
+
+  float applied_ = 1.0f;      // 当前缩放（0..1），限流状态随画布保存
+  float estimate_mA_ = 0;
+  float requested_mA_ = 0;
+  bool limited_ = false;
+
+  bool started_ = false;
+  uint32_t lastMs_ = 0;
+  uint64_t charge_uAms_ = 0;
+  float secSum_ = 0, minSum_ = 0;   // mA·ms
+  uint32_t secMs_ = 0, minMs_ = 0;
+  float secPeak_ = 0, minPeak_ = 0;
+  Sample seconds_[HISTORY];
+  Sample minutes_[HISTORY];
+  uint8_t secHead_ = 0, secCount_ = 0;
+  uint8_t minHead_ = 0, minCount_ = 0;
+};
@@ -0,0 +1,134 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * 灯带异步发送
+ * WS2812 每颗灯 30µs，160 颗一帧约 5ms；FastLED.show() 在调用任务里一直等到 RMT 发完。
+ * 这里把发送交给单独的 led_tx 任务：画布把渲染好的帧拷进发送缓冲（FastLED 绑定的前台缓冲）后 submit()，
+ * 立即返回继续渲染下一帧；发送任务在 RMT 中断补数据期间阻塞，CPU 让给 loop 与音频任务。
+ *
+ * 交接协议（单生产者：loop 任务；单消费者：发送任务）：
+ *   1. 生产者改写前台缓冲之前调用 waitIdle()，等上一帧发完（busy_ 为 false）
+ *   2. 填好前台缓冲后 submit(亮度)：busy_ 置 true，通知发送任务
+ *   3. 发送任务调用 sink 发送，记下耗时，busy_ 置 false，释放 done_ 唤醒可能在等待的生产者
+ * 前台缓冲在 busy_ 期间只读，生产者可以拿它和新帧比较（判断是否需要发送），但不能写。
+ *
+ * 非 ESP32（主机端）没有发送任务，submit() 直接同步调用 sink。
+ * 重叠率 = 1 − 等待时间 / 发送时间：100% 表示发送完全藏在渲染后面，0% 相当于同步发送。
+ */
+class LedTransmitter {
+public:
+  // 发送一帧：把前台缓冲按 brightness 缩放后送出，返回时数据已发完
+  typedef void (*SinkFn)(void* ctx, uint8_t brightness);
+
+  struct Stats {
+    uint32_t frames = 0;       // 已提交的帧
+    uint32_t lastTxUs = 0;     // 最近一帧的发送耗时
+    uint32_t maxTxUs = 0;
+    uint32_t lastWaitUs = 0;   // 最近一次提交前等待上一帧的时间
+    uint32_t maxWaitUs = 0;
+    uint32_t waits = 0;        // 提交时上一帧仍在发送、需要等待的次数
+    uint64_t txUs = 0;         // 累计发送时间（已完成的帧）
+    uint64_t waitUs = 0;       // 累计等待时间
+    float overlap() const { return txUs ? 1.0f - (float)waitUs / (float)txUs : 0.0f; }
+  };
+
+  bool begin(SinkFn sink, void* ctx) {
+    sink_ = sink;
+    ctx_ = ctx;
+#if defined(ARDUINO_ARCH_ESP32)
+    if (task_) return true;
+    done_ = xSemaphoreCreateBinary();
+    if (!done_) return false;
+    if (xTaskCreate(taskEntry, "led_tx", 3072, this, 2, &task_) != pdPASS) {
+      task_ = nullptr;
+      Serial.println("灯带发送任务创建失败，改为同步发送");
+      return false;
+    }
+#endif
+    return true;
+  }
+
+  bool busy() const { return busy_.load(std::memory_order_acquire); }
+
+  // 阻塞到上一帧发完，返回等待的微秒数
+  uint32_t waitIdle() {
+    if (!busy()) return 0;
+    uint32_t t0 = micros();
+#if defined(ARDUINO_ARCH_ESP32)
+    // 超时只是保护：done_ 里可能残留上一次未等待时的释放，醒来后以 busy_ 为准
+    while (busy()) xSemaphoreTake(done_, pdMS_TO_TICKS(50));
+#endif
+    uint32_t waited = micros() - t0;
+    stats_.waits++;
+    stats_.waitUs += waited;
+    stats_.lastWaitUs = waited;
+    if (waited > stats_.maxWaitUs) stats_.maxWaitUs = waited;
+    return waited;
+  }
+
+  // 前台缓冲已填好：交给发送任务（调用前必须 waitIdle()）
+  void submit(uint8_t brightness) {
+    if (!sink_) return;
+    collect();
+    stats_.frames++;
+#if defined(ARDUINO_ARCH_ESP32)
+    if (task_) {
+      xSemaphoreTake(done_, 0); // 清掉残留的释放
+      brightness_ = brightness;
+      pending_ = true;
+      busy_.store(true, std::memory_order_release);
+      xTaskNotifyGive(task_);
+      return;
+    }
+#endif
+    uint32_t t0 = micros();
+    sink_(ctx_, brightness);
+    lastTxUs_.store(micros() - t0, std::memory_order_relaxed);
+    pending_ = true;
+  }
+
+  // 统计只在生产者（loop）一侧累计：发送任务只写最近一帧的耗时
+  const Stats& stats() {
+    if (!busy()) collect();
+    return stats_;
+  }
+
+private:
+  // 把已完成帧的发送耗时并入累计值
+  void collect() {
+    if (!pending_) return;
+    pending_ = false;
+    uint32_t tx = lastTxUs_.load(std::memory_order_relaxed);
+    stats_.lastTxUs = tx;
+    stats_.txUs += tx;
+    if (tx > stats_.maxTxUs) stats_.maxTxUs = tx;
+  }
+
+#if defined(ARDUINO_ARCH_ESP32)
+  static void taskEntry(void* arg) {
+    LedTransmitter* self = static_cast<LedTransmitter*>(arg);
+    for (;;) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      if (!self->busy()) continue;
+      uint32_t t0 = micros();
+      self->sink_(self->ctx_, self->brightness_);
+      self->lastTxUs_.store(micros() - t0, std::memory_order_relaxed);
+      self->busy_.store(false, std::memory_order_release);
+      xSemaphoreGive(self->done_);
+    }
+  }
+
+  TaskHandle_t task_ = nullptr;
+  SemaphoreHandle_t done_ = nullptr;
+#endif
+
+  SinkFn sink_ = nullptr;
+  void* ctx_ = nullptr;
+  uint8_t brightness_ = 255;
+  std::atomic<bool> busy_{false};
+  std::atomic<uint32_t> lastTxUs_{0};
+  bool pending_ = false; // 有已提交、耗时尚未并入统计的帧（只在生产者一侧读写）
+  Stats stats_;
+};
@@ -25,6 +25,8 @@
 #include "webui.hpp"
 #include "control.hpp"
 #include "enhanced_led_controller.hpp"
+#include "audio_task.hpp"
+#include "frame_scheduler.hpp"
 
 // 引入拆分后的模块
 #include "audio_handler.h"
@@ -43,6 +45,8 @@ const uint8_t AUDIO_PIN = 3; // MAX9814 OUT to ADC pin (moved from 4)
 static const uint16_t FLOW_INTERVAL_MS = 40;
 static const uint8_t FLOW_TAIL = 8;
 
+static const uint16_t FRAME_FPS = 60; // 灯带与经络动画的目标帧率（可经 /api/frame?fps= 调整）
+
 static const unsigned long DEBOUNCE_MS = 40;
 static const unsigned long LONG_PRESS_MS = 600;
 
@@ -90,9 +94,18 @@ Mode mode = FLOW; // 初始模式为FLOW
 
 // 音频分析器 - 使用优化的音频分析器
 OptimizedAudioAnalyzer analyzer(AUDIO_PIN);
+AudioTask audioTask(analyzer); // 分析器在独立任务中运行
+CaptureSource capture;         // 录音/回放，包在麦克风采样源外面
+FrameScheduler frameScheduler; // 固定步长帧调度：灯带渲染与经络动画按目标帧率运行
+static int8_t tcmJob = -1;
 
 // LED灯带控制器 - 使用增强的LED控制器
-EnhancedLEDController controller(LED_COUNT, LED_PIN, analyzer);
+// 灯带输出通道（写法见 enhanced_led_controller.hpp 的 LedChannelConfig）
+static const LedChannelConfig LED_CHANNELS[] = {
+  { LED_PIN, LED_COUNT, RGB, false },
+};
+static_assert(LED_COUNT <= LED_CAPACITY, "LED_COUNT 超过画布容量，调整 platformio.ini 中的 -DLED_CAPACITY");
+EnhancedLEDController controller(LED_CHANNELS, sizeof(LED_CHANNELS) / sizeof(LED_CHANNELS[0]), analyzer);
 static EnhancedFlowEffect &flow = controller.flow();             // 流动效果引用
 static EnhancedPointEffect &point = controller.point();          // 点效果引用
 static EnhancedAudioEffect &audioEff = controller.audioEffect(); // 音频效果引用
@@ -134,6 +147,9 @@ void setup()
   // 初始化按钮、音频分析器和灯带控制器
   button.begin();
   analyzer.begin(); // 初始化音频分析器
+  capture.attach(analyzer.source());
+  analyzer.setSource(&capture); // 分析任务启动前替换，之后经 /api/audio/capture 录音或回放
+  audioTask.begin(); // 启动音频分析任务（默认暂停，需要音频功能时由 loop 激活）
 
   // 设置全局亮度
   gBrightness = 60; // 设置亮度为60
@@ -160,10 +176,13 @@ void setup()
 
   // 注册Web界面和控制API
   registerWeb(server, apSsid, mode, gBrightness, gPowerLimit_mA, gLedFull_mA, gLastCurrentEst_mA,
-              controller, analyzer, stepIndex, gPitchArmed, gPitchTargetHz, gPitchConfThresh,
+              controller, analyzer, audioTask, stepIndex, gPitchArmed, gPitchTargetHz, gPitchConfThresh,
               gPitchTolCents, gPitchMapEnable, gPitchMapScale, gPitchMapMinHz, gPitchMapMaxHz,
               FLOW_INTERVAL_MS, FLOW_TAIL);
 
+  registerAudioCaptureRoutes(server, capture);
+  registerFrameRoutes(server, frameScheduler);
+
   // 注册 TCM 模式控制 API：/api/tcm?enable=0/1
   server.on("/api/tcm", HTTP_GET, []() {
     if (!server.hasArg("enable")) {
@@ -174,7 +193,7 @@ void setup()
     bool newMode = (en != 0);
 
     if (!newMode && gTcmMode) {
-      // 关闭 TCM 模式时，停止任何正在进行的经络动画
+      // 关闭 TCM 模式时，停止任何正在进行的经络动画；loop 中切回灯效图层后所有效果重新渲染
       stopTcmFlow();
     }
 
@@ -185,6 +204,13 @@ void setup()
   // 注册经络相关HTTP接口，使 /tcm 页面可以通过同一 WebServer 控制经络系统
   registerTcmRoutes(server);
 
+  // 帧作业：TCM 模式先推进非阻塞经络动画（写外部图层），随后控制器合成并经画布发送；
+  // 控制器两种模式都运行，亮度、限流、抖动与帧统计不随模式变化
+  frameScheduler.setTargetFps(FRAME_FPS);
+  tcmJob = frameScheduler.addJob("tcm", tcmTick);
+  frameScheduler.addJob("led", []() { controller.tick(); });
+  frameScheduler.begin();
+
   Serial.println("Setup complete, entering main loop");
 }
 
@@ -205,9 +231,9 @@ void setup()
  * 1. 输入处理：检测按钮状态和采集音频数据
  * 2. 功能模块处理：处理音频、音高检测和按钮交互
  * 3. Web服务器处理：响应Web请求
- * 4. 渲染处理：更新LED灯带状态
+ * 4. 渲染处理：由帧调度器按目标帧率运行灯带渲染或经络动画
  *
- * 整个循环设计为非阻塞式，确保各个模块能够平滑运行。
+ * 整个循环设计为非阻塞式，确保各个模块能够平滑运行；帧之间的空闲时间由帧调度器精确睡眠。
  */
 void loop()
 {
@@ -222,10 +248,11 @@ void loop()
     // 2) 已武装音高检测，或
     // 3) 启用了音高映射到长度功能
     bool audioNeeded = controller.audioEnabled() || gPitchArmed || gPitchMapEnable;
+    audioTask.setActive(audioNeeded || capture.recording()); // 采集和分析在音频任务中进行，录音时也需要采样
 
     if (audioNeeded)
     {
-      analyzer.tick();      // 采集和分析音频数据
+      // 分析器只计算各消费者声明需要的特征（见 AudioEffect::features 与 handleAudioEffects）
       updateAudioLog();     // 音频状态日志（内部已再次判断是否启用音频）
       handleAudioEffects(); // 音频效果处理
       handlePitchDetection(); // 音高检测
@@ -237,18 +264,16 @@ void loop()
 
   // 3. Web服务器处理
   server.handleClient(); // 响应Web请求
+  capture.service();     // 录音时把缓冲的样本写入 SPIFFS
 
-  // 4. 渲染处理：只有在非 TCM 模式下才使用增强控制器驱动灯带
-  if (!gTcmMode)
-  {
-    controller.tick(); // 更新灯带状态
-  }
-  else
+  // 4. 渲染处理：TCM 模式下控制器只合成经络系统的外部图层，并推进非阻塞经络动画
+  if (gTcmMode)
   {
-    // TCM 模式下通过 tcmTick() 推进非阻塞经络动画
-    tcmTick();
+    audioTask.setActive(false);
   }
+  controller.setExternalMode(gTcmMode);
+  frameScheduler.setJobEnabled(tcmJob, gTcmMode);
 
-  // 小延时以减轻 CPU 负载并稳定帧率
-  delay(2);
+  // 到帧时间时运行帧作业，否则精确睡眠到下一帧（最长 5ms，按钮和网页仍被及时处理）
+  frameScheduler.service();
 }
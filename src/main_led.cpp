@@ -5,6 +5,8 @@
 #include "webui.hpp"
 #include "control.hpp"
 #include "enhanced_led_controller.hpp"
+#include "audio_task.hpp"
+#include "frame_scheduler.hpp"
 
 // 拆分后的模块
 #include "audio_handler.h"
@@ -21,6 +23,7 @@ const uint8_t AUDIO_PIN = 3;     // MAX9814 OUT to ADC
 
 static const uint16_t FLOW_INTERVAL_MS = 40;
 static const uint8_t FLOW_TAIL = 8;
+static const uint16_t FRAME_FPS = 60; // 灯带目标帧率（可经 /api/frame?fps= 调整）
 
 static const unsigned long DEBOUNCE_MS = 40;
 static const unsigned long LONG_PRESS_MS = 600;
@@ -72,9 +75,17 @@ Mode mode = FLOW; // 初始模式为 FLOW
 
 // 音频分析器
 OptimizedAudioAnalyzer analyzer(AUDIO_PIN);
+AudioTask audioTask(analyzer); // 分析器在独立任务中运行
+CaptureSource capture;         // 录音/回放，包在麦克风采样源外面
+FrameScheduler frameScheduler; // 固定步长帧调度
 
 // LED 控制器
-EnhancedLEDController controller(LED_COUNT, LED_PIN, analyzer);
+// 灯带输出通道（写法见 enhanced_led_controller.hpp 的 LedChannelConfig）
+static const LedChannelConfig LED_CHANNELS[] = {
+  { LED_PIN, LED_COUNT, RGB, false },
+};
+static_assert(LED_COUNT <= LED_CAPACITY, "LED_COUNT 超过画布容量，调整 platformio.ini 中的 -DLED_CAPACITY");
+EnhancedLEDController controller(LED_CHANNELS, sizeof(LED_CHANNELS) / sizeof(LED_CHANNELS[0]), analyzer);
 static EnhancedFlowEffect &flow = controller.flow();
 static EnhancedPointEffect &point = controller.point();
 static EnhancedAudioEffect &audioEff = controller.audioEffect();
@@ -104,6 +115,9 @@ void setup()
   // 初始化按钮与音频分析器
   button.begin();
   analyzer.begin();
+  capture.attach(analyzer.source());
+  analyzer.setSource(&capture);
+  audioTask.begin();
 
   // 设置全局亮度
   gBrightness = 60;
@@ -126,9 +140,15 @@ void setup()
   startAp(apSsid);
 
   registerWeb(server, apSsid, mode, gBrightness, gPowerLimit_mA, gLedFull_mA, gLastCurrentEst_mA,
-              controller, analyzer, stepIndex, gPitchArmed, gPitchTargetHz, gPitchConfThresh,
+              controller, analyzer, audioTask, stepIndex, gPitchArmed, gPitchTargetHz, gPitchConfThresh,
               gPitchTolCents, gPitchMapEnable, gPitchMapScale, gPitchMapMinHz, gPitchMapMaxHz,
               FLOW_INTERVAL_MS, FLOW_TAIL);
+  registerAudioCaptureRoutes(server, capture);
+  registerFrameRoutes(server, frameScheduler);
+
+  frameScheduler.setTargetFps(FRAME_FPS);
+  frameScheduler.addJob("led", []() { controller.tick(); });
+  frameScheduler.begin();
 
   Serial.println("LED-only setup complete, entering main loop");
 }
@@ -142,9 +162,10 @@ void loop()
 
   // 2. 音频处理（仅在确实需要音频功能时才采样和处理）
   bool audioNeeded = controller.audioEnabled() || gPitchArmed || gPitchMapEnable;
+  audioTask.setActive(audioNeeded || capture.recording()); // 采集和分析在音频任务中进行，录音时也需要采样
   if (audioNeeded)
   {
-    analyzer.tick();
+    // 分析器只计算各消费者声明需要的特征（见 AudioEffect::features 与 handleAudioEffects）
     updateAudioLog();
     handleAudioEffects();
     handlePitchDetection();
@@ -155,9 +176,8 @@ void loop()
 
   // 4. Web 请求处理
   server.handleClient();
+  capture.service();
 
-  // 5. 渲染 LED（不涉及 TCM，始终由主控制器驱动）
-  controller.tick();
-
-  delay(2);
+  // 5. 渲染 LED（不涉及 TCM，始终由主控制器驱动）：到帧时间时渲染，否则精确睡眠到下一帧
+  frameScheduler.service();
 }
@@ -110,7 +110,9 @@ void setup() {
     
     // 初始化音频处理 (真实麦克风)
     audioAnalyzer.begin();
-    audioAnalyzer.setSensitivity(0.15); // 进一步降低灵敏度
+    // 电平由分析器的自动增益归一化，不再需要手调灵敏度
+    audioAnalyzer.setBands(MATRIX_WIDTH); // 8 段对数频谱对应矩阵的 8 列
+    audioAnalyzer.setDemand(OptimizedAudioAnalyzer::CONSUMER_DISPLAY, AudioFeatures::FEAT_SPECTRUM);
     Serial.println("MAX9814麦克风初始化完成");
     
     // 设置BLE控制
@@ -138,24 +140,20 @@ void loop() {
     // 更新音频数据 (真实麦克风) - 只有在音频模式下才更新
     if (matrix.getMode() == MatrixDisplay::MODE_AUDIO_SPECTRUM || 
         matrix.getMode() == MatrixDisplay::MODE_AUDIO_WAVEFORM) {
-        audioAnalyzer.tick(); // 更新音频分析
+        audioAnalyzer.tick(); // 更新音频分析（矩阵屏单任务运行，无需独立分析任务）
         
-        // 获取音频频谱数据并映射到矩阵
-        float audioSamples[64];
-        for (int i = 0; i < 64; i++) {
-            // 将频段数据映射到音频样本格式，进一步降低放大倍数
-            if (i < 8) {
-                // 低频段
-                audioSamples[i] = audioAnalyzer.low() * 2.5f; // 从5.0降低到2.5
-            } else if (i < 32) {
-                // 中频段  
-                audioSamples[i] = audioAnalyzer.mid() * 2.0f; // 从4.0降低到2.0
-            } else {
-                // 高频段
-                audioSamples[i] = audioAnalyzer.high() * 1.5f; // 从3.0降低到1.5
-            }
+        // 分析器的 8 段对数频谱直接对应矩阵的 8 列
+        AudioFeatures features;
+        audioAnalyzer.readFeatures(features);
+        const uint8_t* bands = features.bands;
+        matrix.updateSpectrum(bands, MATRIX_WIDTH);
+
+        // 波形模式沿用逐列电平
+        float columns[MATRIX_WIDTH];
+        for (int i = 0; i < MATRIX_WIDTH; i++) {
+            columns[i] = bands[i] / 255.0f;
         }
-        matrix.updateAudioData(audioSamples, 64);
+        matrix.updateAudioData(columns, MATRIX_WIDTH);
     }
     
     // 运行演示模式 - 只有在没有BLE连接时才运行
@@ -5,8 +5,9 @@
 #include "meridian.hpp"
 #include "enhanced_led_controller.hpp"
 #include "optimized_audio.hpp"
+#include "frame_scheduler.hpp"
 #include "hardware_check.h"
-#include "tcm_page.h"
+#include "webui.hpp"
 
 // TCM 辅助函数（在 tcm_demo.cpp 中实现）
 extern void initTcmSystem();
@@ -23,10 +24,10 @@ const uint8_t BUTTON_PIN = 9;    // 仍然暴露按钮引脚，方便后续扩
 const bool BUTTON_ACTIVE_LOW = true;
 const uint8_t AUDIO_PIN = 3;     // 不主动使用音频，但保持一致的引脚定义
 
-uint16_t gPowerLimit_mA = 1500;  // 功率限制，供电流估算打印使用
+uint16_t gPowerLimit_mA = 1500;  // 功率限制：经络画面同样经画布限流
 
 // EnhancedLEDCanvas 的功率与亮度相关全局变量
-uint8_t gBrightness = 64;        // 虽然 TCM 主要用自己的亮度设置，这里保持与主工程一致
+uint8_t gBrightness = 64;        // 经络系统的亮度（/api/tcm/brightness）也落在这里
 uint8_t gLedFull_mA = 60;
 uint32_t gLastCurrentEst_mA = 0;
 
@@ -36,6 +37,10 @@ bool gTcmMode = true;            // TCM-only 固件中始终处于 TCM 模式
 // Web 服务器
 static WebServer server(80);
 
+// 经络动画按固定帧率推进
+static const uint16_t FRAME_FPS = 60;
+FrameScheduler frameScheduler;
+
 //----------- EnhancedLEDCanvas 全局访问器实现 -----------//
 
 uint8_t &EnhancedLEDCanvas::globalBrightness() { return gBrightness; }
@@ -43,21 +48,16 @@ uint16_t &EnhancedLEDCanvas::powerLimit_mA() { return gPowerLimit_mA; }
 uint8_t &EnhancedLEDCanvas::ledFull_mA() { return gLedFull_mA; }
 uint32_t &EnhancedLEDCanvas::lastCurrentEst_mA() { return gLastCurrentEst_mA; }
 
-//----------- LED 控制器与音频分析器（仅用于共享 LED 缓冲区） -----------//
+//----------- LED 控制器与音频分析器（经络系统写它的外部图层，经画布输出） -----------//
 
 // 虽然 TCM-only 固件不做音频处理，但 EnhancedLEDController 需要一个音频分析器引用
 OptimizedAudioAnalyzer analyzer(AUDIO_PIN);
-EnhancedLEDController controller(LED_COUNT, LED_PIN, analyzer);
-
-//----------- WiFi AP 启动工具函数 -----------//
-
-static inline void startAp(const char *ssid)
-{
-  WiFi.mode(WIFI_AP);
-  bool ok = WiFi.softAP(ssid);
-  Serial.printf("AP %s %s, IP: %s\n", ssid, ok ? "started" : "failed",
-                WiFi.softAPIP().toString().c_str());
-}
+// 灯带输出通道（写法见 enhanced_led_controller.hpp 的 LedChannelConfig）
+static const LedChannelConfig LED_CHANNELS[] = {
+  { LED_PIN, LED_COUNT, RGB, false },
+};
+static_assert(LED_COUNT <= LED_CAPACITY, "LED_COUNT 超过画布容量，调整 platformio.ini 中的 -DLED_CAPACITY");
+EnhancedLEDController controller(LED_CHANNELS, sizeof(LED_CHANNELS) / sizeof(LED_CHANNELS[0]), analyzer);
 
 //----------- 初始化 -----------//
 
@@ -70,10 +70,11 @@ void setup()
   // 硬件连接检查
   checkHardwareConnections();
 
-  // 初始化 LED 控制器（用于提供共享 CRGB 缓冲区给 TCMMeridianSystem）
+  // 初始化 LED 控制器：始终处于外部模式，只合成经络系统的图层
   controller.begin();
+  controller.setExternalMode(true);
 
-  // 初始化中医经络系统（会从 controller.canvas().leds() 共享灯带数据）
+  // 初始化中医经络系统（写 controller.externalLeds()，经画布统一发送）
   initTcmSystem();
 
   // 启动 WiFi AP
@@ -83,6 +84,10 @@ void setup()
   // 注册经络相关 HTTP 接口
   registerTcmRoutes(server);
 
+  // 与主固件相同的输出指标与调节：亮度、输出级、功率与帧调度
+  registerOutputRoutes(server, controller, gBrightness, gPowerLimit_mA, gLedFull_mA, gLastCurrentEst_mA);
+  registerFrameRoutes(server, frameScheduler);
+
   // 注册 TCM 控制页面作为根页面和 /tcm 页面
   server.on("/", HTTP_GET, []() {
     server.send(200, "text/html", TCM_PAGE_HTML);
@@ -97,6 +102,11 @@ void setup()
 
   server.begin();
   Serial.println("HTTP server started for TCM-only firmware");
+
+  frameScheduler.setTargetFps(FRAME_FPS);
+  frameScheduler.addJob("tcm", tcmTick);
+  frameScheduler.addJob("led", []() { controller.tick(); });
+  frameScheduler.begin();
 }
 
 //----------- 主循环 -----------//
@@ -106,9 +116,6 @@ void loop()
   // 处理 HTTP 请求
   server.handleClient();
 
-  // 推进 TCM 非阻塞动画
-  tcmTick();
-
-  // 轻微延时，降低 CPU 占用并稳定帧率
-  delay(2);
+  // 到帧时间时推进 TCM 非阻塞动画并经画布发送，否则精确睡眠到下一帧
+  frameScheduler.service();
 }
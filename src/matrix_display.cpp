@@ -118,13 +118,12 @@ MatrixDisplay::MatrixDisplay() {
   textLength = 0;
   memset(textBuffer, 0, sizeof(textBuffer));
   memset(audioData, 0, sizeof(audioData));
+  audioCount = 0;
   memset(spectrumData, 0, sizeof(spectrumData));
   memset(customPattern, 0, sizeof(customPattern));
-
-  fft = new arduinoFFT();
 }
 
-MatrixDisplay::~MatrixDisplay() { delete fft; }
+MatrixDisplay::~MatrixDisplay() {}
 
 void MatrixDisplay::begin(int ledPin) {
   // 根据传入的引脚使用对应的FastLED配置
@@ -233,45 +232,21 @@ void MatrixDisplay::setVisualizationType(VisualizationType type) {
 void MatrixDisplay::updateAudioData(float *audioSamples, int sampleCount) {
   int copyCount = min(sampleCount, MATRIX_SIZE);
   memcpy(audioData, audioSamples, copyCount * sizeof(float));
-
-  // 处理FFT
-  if (currentMode == MODE_AUDIO_SPECTRUM) {
-    processFFT(audioSamples, sampleCount);
-  }
+  audioCount = copyCount;
 }
 
-void MatrixDisplay::processFFT(float *audioSamples, int sampleCount) {
-  // 准备FFT数据
-  int fftSize = min(sampleCount, 64);
-
-  // 分离实部和虚部数组
-  double vReal[64];
-  double vImag[64];
-
-  for (int i = 0; i < fftSize; i++) {
-    vReal[i] = audioSamples[i] * 1000.0; // real
-    vImag[i] = 0.0;                      // imag
-  }
-
-  // 执行FFT
-  fft->Windowing(vReal, fftSize, FFT_WIN_TYP_HAMMING, FFT_FORWARD);
-  fft->Compute(vReal, vImag, fftSize, FFT_FORWARD);
-  fft->ComplexToMagnitude(vReal, vImag, fftSize);
-
-  // 计算幅度谱并映射到8个频段
-  // 跳过直流分量(0)和极低频分量(1)，避免低频噪声
-  for (int i = 0; i < MATRIX_SIZE && i < fftSize / 2; i++) {
-    int fftIndex = i + 2; // 跳过前2个频率分量
-    if (fftIndex < fftSize) {
-      float magnitude = vReal[fftIndex];
-      // 增加阈值过滤，避免噪声触发
-      if (magnitude < 20)
-        magnitude = 0; // 从10提高到20
-      spectrumData[i] = (uint8_t)constrain(map(magnitude, 0, 300, 0, 8), 0,
-                                           8); // 从500降低到300
-    } else {
-      spectrumData[i] = 0;
+void MatrixDisplay::updateSpectrum(const uint8_t *bands, int bandCount) {
+  // 每列对应一个频段；频段多于列数时相邻频段取最大值
+  for (int x = 0; x < MATRIX_WIDTH; x++) {
+    int first = x * bandCount / MATRIX_WIDTH;
+    int last = (x + 1) * bandCount / MATRIX_WIDTH;
+    if (last <= first) last = first + 1;
+    uint8_t peak = 0;
+    for (int i = first; i < last && i < bandCount; i++) {
+      if (bands[i] > peak) peak = bands[i];
     }
+    // 0..255 映射为 0..8 格，低于一格(约28)的视为噪声
+    spectrumData[x] = (uint8_t)((peak * (MATRIX_HEIGHT + 1)) >> 8);
   }
 }
 
@@ -698,8 +673,9 @@ void MatrixDisplay::showBeatDetection() {
   static unsigned long lastBeat = 0;
   static bool beatState = false;
 
+  // 只统计最近写入的数据（按列更新时只有 MATRIX_WIDTH 个），其余是旧值或 0
   float audioSum = 0;
-  for (int i = 0; i < MATRIX_SIZE; i++) {
+  for (int i = 0; i < audioCount; i++) {
     audioSum += abs(audioData[i]);
   }
 
@@ -751,10 +727,10 @@ void MatrixDisplay::showVolumeMeter() {
 
   // 计算音量
   float volume = 0;
-  for (int i = 0; i < MATRIX_SIZE; i++) {
+  for (int i = 0; i < audioCount; i++) {
     volume += abs(audioData[i]);
   }
-  volume /= MATRIX_SIZE;
+  if (audioCount > 0) volume /= audioCount;
 
   uint8_t level = (uint8_t)constrain(volume * 8, 0, 8);
 
@@ -3,7 +3,6 @@
 
 #include <Arduino.h>
 #include <FastLED.h>
-#include "arduinoFFT.h"
 
 #define MATRIX_WIDTH 8
 #define MATRIX_HEIGHT 8
@@ -39,7 +38,7 @@ private:
 
     // 音频相关
     float audioData[MATRIX_SIZE];
-    arduinoFFT *fft;
+    int audioCount;                 // updateAudioData 最近写入的个数（按列更新时为 MATRIX_WIDTH）
     uint8_t spectrumData[MATRIX_SIZE];
 
     // 文字显示相关
@@ -91,7 +90,8 @@ public:
 
     // 音频可视化
     void updateAudioData(float *audioSamples, int sampleCount);
-    void processFFT(float *audioSamples, int sampleCount);
+    // 直接使用分析器的 N 段频谱（0..255），无需再做一次FFT
+    void updateSpectrum(const uint8_t *bands, int bandCount);
 
     // 文字显示
     void setText(const char *text);
@@ -27,8 +27,9 @@ public:
     return true;
   }
   
-  // 从JSON文件加载经络配置
-  static bool loadMeridians(const char* filename, std::vector<MeridianInfo>& meridians, std::vector<ZiwuliuzhuTimeSlot>& timeSlots) {
+  // 从JSON文件加载经络配置；acupoints 不为空时同时收集穴位（globalIndex 先记为 NO_LED，由调用方在算出经络区间后换算）
+  static bool loadMeridians(const char* filename, std::vector<MeridianInfo>& meridians, std::vector<ZiwuliuzhuTimeSlot>& timeSlots,
+                            std::vector<AcupointInfo>* acupoints = nullptr) {
     // 打开文件
     File file = SPIFFS.open(filename, "r");
     if (!file) {
@@ -115,7 +116,7 @@ public:
         
         // 创建穴位信息对象
         AcupointInfo acupoint;
-        acupoint.globalIndex = meridian.startIndex + localIndex; // 全局索引将在后续设置
+        acupoint.globalIndex = AcupointInfo::NO_LED; // 全局索引在算出经络区间后设置
         acupoint.localIndex = localIndex;
         acupoint.meridian = meridian.type;
         acupoint.name = strdup(acupointObj["name"].as<const char*>());
@@ -153,7 +154,7 @@ public:
         }
         
         // 添加到穴位列表
-        // 注意：这里我们只是准备数据，实际添加会在调用方完成
+        if (acupoints) acupoints->push_back(acupoint);
       }
       
       // 设置穴位索引
@@ -169,11 +170,12 @@ public:
   // 从多个JSON文件加载经络配置
   static bool loadAllMeridians(const std::vector<const char*>& filenames, 
                               std::vector<MeridianInfo>& meridians, 
-                              std::vector<ZiwuliuzhuTimeSlot>& timeSlots) {
+                              std::vector<ZiwuliuzhuTimeSlot>& timeSlots,
+                              std::vector<AcupointInfo>* acupoints = nullptr) {
     bool success = true;
     
     for (const char* filename : filenames) {
-      if (!loadMeridians(filename, meridians, timeSlots)) {
+      if (!loadMeridians(filename, meridians, timeSlots, acupoints)) {
         Serial.printf("加载文件失败: %s\n", filename);
         success = false;
       }
@@ -16,9 +16,14 @@ void TCMMeridianSystem::addSpecificAcupoint(MeridianType meridianType, uint16_t
 
   if (!meridian) return;
 
+  // 配置里已有同名穴位（带实际位置与详情）时不再添加示意位置（只在加载时调用，线性比较即可）
+  for (const auto& ap : acupoints_) {
+    if (strcmp(ap.name, name) == 0) return;
+  }
+
   // 创建穴位信息对象
   AcupointInfo acupoint;
-  acupoint.globalIndex = meridian->startIndex + localIndex;
+  acupoint.globalIndex = acupointLed(*meridian, localIndex);
   acupoint.localIndex = localIndex;
   acupoint.meridian = meridianType;
   acupoint.name = name;
@@ -350,13 +355,21 @@ void TCMMeridianSystem::initMeridians() {
     meridians_.push_back(liver);
 }
 
-// 实现 initAcupoints：根据 meridians_ 填充 acupoints_，并附加示例穴位信息
+// 实现 initAcupoints：根据 meridians_ 填充 acupoints_，并附加示例穴位信息；
+// 配置里已经读入的穴位保留，只为缺少的位置生成示例名称，最后建立查找索引
 void TCMMeridianSystem::initAcupoints() {
     // 为每个经络的穴位创建全局索引
+    size_t loaded = acupoints_.size();
     for (const auto& meridian : meridians_) {
       for (uint16_t localIdx : meridian.acupoints) {
+        bool known = false;
+        for (size_t i = 0; i < loaded && !known; i++) {
+          known = acupoints_[i].meridian == meridian.type && acupoints_[i].localIndex == localIdx;
+        }
+        if (known) continue;
+
         AcupointInfo acupoint;
-        acupoint.globalIndex = meridian.startIndex + localIdx;
+        acupoint.globalIndex = acupointLed(meridian, localIdx);
         acupoint.localIndex = localIdx;
         acupoint.meridian = meridian.type;
         
@@ -368,6 +381,11 @@ void TCMMeridianSystem::initAcupoints() {
         char chineseNameBuffer[50];
         sprintf(chineseNameBuffer, "%s穴位%d", meridian.chineseName, localIdx);
         acupoint.chineseName = strdup(chineseNameBuffer);
+        acupoint.pinyin = "";
+        acupoint.location = "";
+        acupoint.functions = "";
+        acupoint.indications = "";
+        acupoint.importance = 1;
         
         acupoints_.push_back(acupoint);
       }
@@ -450,140 +468,263 @@ void TCMMeridianSystem::initAcupoints() {
     // 下面这部分是原来在 hpp 中的示例“特定重要穴位”添加逻辑，
     // 如果后续不需要这么详细，可以逐步精简。
     // （为保持行为一致，这里先不删除原有 addSpecificAcupoint 调用。）
+
+    acupointIndex_.build(acupoints_);
 }
 
-void TCMMeridianSystem::startSingleFlow(MeridianType type, uint8_t tailLength, uint16_t interval) {
-  flowMode_ = FLOW_SINGLE;
-  flowTailLength_ = tailLength;
-  flowIntervalMs_ = interval;
-  flowSingleMeridian_ = type;
-  flowMeridianIndex_ = 0;
-  flowHead_ = 0;
-  flowInPause_ = false;
-  lastFlowStepMs_ = millis();
+// ---------- 非阻塞动画队列 ----------
+
+int TCMMeridianSystem::findMeridian(MeridianType type) const {
+  for (size_t i = 0; i < meridians_.size(); i++) {
+    if (meridians_[i].type == type) {
+      return (int)i;
+    }
+  }
+  return -1;
 }
 
-void TCMMeridianSystem::startAllFlow(uint8_t tailLength, uint16_t interval) {
-  flowMode_ = FLOW_ALL;
-  flowTailLength_ = tailLength;
-  flowIntervalMs_ = interval;
-  flowMeridianIndex_ = 0;
-  flowHead_ = 0;
-  flowInPause_ = false;
-  lastFlowStepMs_ = millis();
+TCMMeridianSystem::Animation* TCMMeridianSystem::allocAnimation() {
+  for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+    if (anims_[i].kind == ANIM_NONE) {
+      anims_[i] = Animation();
+      return &anims_[i];
+    }
+  }
+  return nullptr;
 }
 
-void TCMMeridianSystem::startCurrentTimeFlow(uint8_t tailLength, uint16_t interval) {
-  MeridianType active = getCurrentActiveMeridian();
-  startSingleFlow(active, tailLength, interval);
+// 结束一个动画：闪烁恢复原色，其余保持当前画面
+void TCMMeridianSystem::finishAnimation(Animation& a) {
+  if (a.kind == ANIM_BLINK && a.start < numLeds_) {
+    leds_[a.start] = a.saved;
+  }
+  a.kind = ANIM_NONE;
 }
 
-void TCMMeridianSystem::stopFlow() {
-  flowMode_ = FLOW_NONE;
-  flowInPause_ = false;
-  flowHead_ = 0;
-  flowMeridianIndex_ = 0;
+uint8_t TCMMeridianSystem::animationCount() const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+    if (anims_[i].kind != ANIM_NONE) n++;
+  }
+  return n;
 }
 
-void TCMMeridianSystem::tickFlow() {
-  if (flowMode_ == FLOW_NONE) {
-    return;
+bool TCMMeridianSystem::blinkAcupoint(const AcupointInfo& acupoint, uint8_t times, uint16_t interval, CRGB color) {
+  if (!acupoint.mapped() || acupoint.globalIndex >= numLeds_) return false;
+  if (times == 0) return true;
+
+  // 同一颗灯上的闪烁先结束（恢复原色），新的闪烁才能记下真正的原色
+  uint16_t idx = acupoint.globalIndex;
+  for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+    if (anims_[i].kind == ANIM_BLINK && anims_[i].start == idx) finishAnimation(anims_[i]);
   }
 
-  if (meridians_.empty()) {
-    stopFlow();
-    return;
+  Animation* a = allocAnimation();
+  if (!a) return false;
+  a->kind = ANIM_BLINK;
+  a->start = idx;
+  a->length = 1;
+  a->color = color;
+  a->saved = leds_[idx];
+  a->intervalMs = interval;
+  a->steps = (uint16_t)times * 2;
+  a->dueMs = millis() + interval;
+
+  // 第一次点亮立即显示
+  leds_[idx] = color;
+  present();
+  return true;
+}
+
+bool TCMMeridianSystem::fadeMeridian(MeridianType type, uint16_t durationMs, bool fadeIn) {
+  int mi = findMeridian(type);
+  if (mi < 0) return false;
+  const MeridianInfo& m = meridians_[mi];
+  if (m.length == 0 || m.startIndex >= numLeds_) return false;
+
+  uint16_t length = m.length;
+  if (length > numLeds_ - m.startIndex) length = numLeds_ - m.startIndex;
+  for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+    Animation& o = anims_[i];
+    if (o.kind == ANIM_FADE && o.start == m.startIndex && o.length == length) finishAnimation(o);
   }
 
-  uint32_t now = millis();
+  Animation* a = allocAnimation();
+  if (!a) return false;
+  a->kind = ANIM_FADE;
+  a->fadeIn = fadeIn;
+  a->start = m.startIndex;
+  a->length = length;
+  a->color = m.color;
+  a->intervalMs = durationMs ? durationMs : 1;
+  a->startMs = millis();
+  return true;
+}
 
-  if (flowInPause_) {
-    if (now >= flowPauseEndMs_) {
-      flowInPause_ = false;
-      lastFlowStepMs_ = now;
-    } else {
-      return;
-    }
+bool TCMMeridianSystem::startSingleFlow(MeridianType type, uint8_t tailLength, uint16_t interval) {
+  int mi = findMeridian(type);
+  if (mi < 0 || meridians_[mi].length == 0) return false;
+
+  // 同一经络（或全身循行）上只保留新的循行
+  for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+    Animation& o = anims_[i];
+    if (o.kind == ANIM_FLOW && (o.all || o.meridian == mi)) finishAnimation(o);
   }
 
-  if (now - lastFlowStepMs_ < flowIntervalMs_) {
-    return;
+  Animation* a = allocAnimation();
+  if (!a) return false;
+  a->kind = ANIM_FLOW;
+  a->meridian = (uint8_t)mi;
+  a->tail = tailLength ? tailLength : 1;
+  a->intervalMs = interval;
+  a->dueMs = millis();
+  return true;
+}
+
+bool TCMMeridianSystem::startAllFlow(uint8_t tailLength, uint16_t interval) {
+  size_t first = 0;
+  while (first < meridians_.size() && meridians_[first].length == 0) first++;
+  if (first >= meridians_.size()) return false;
+
+  for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+    if (anims_[i].kind == ANIM_FLOW) finishAnimation(anims_[i]);
   }
-  lastFlowStepMs_ = now;
 
-  MeridianInfo* meridian = nullptr;
+  Animation* a = allocAnimation();
+  if (!a) return false;
+  a->kind = ANIM_FLOW;
+  a->all = true;
+  a->meridian = (uint8_t)first;
+  a->tail = tailLength ? tailLength : 1;
+  a->intervalMs = interval;
+  a->dueMs = millis();
+  return true;
+}
 
-  if (flowMode_ == FLOW_SINGLE) {
-    for (auto& m : meridians_) {
-      if (m.type == flowSingleMeridian_) {
-        meridian = &m;
-        break;
-      }
-    }
-  } else if (flowMode_ == FLOW_ALL) {
-    while (flowMeridianIndex_ < meridians_.size()) {
-      auto& m = meridians_[flowMeridianIndex_];
-      if (m.length == 0) {
-        flowMeridianIndex_++;
-        continue;
-      }
-      meridian = &m;
-      break;
-    }
+bool TCMMeridianSystem::startCurrentTimeFlow(uint8_t tailLength, uint16_t interval) {
+  MeridianType active = getCurrentActiveMeridian();
+  return startSingleFlow(active, tailLength, interval);
+}
+
+void TCMMeridianSystem::stopFlow() {
+  for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+    if (anims_[i].kind != ANIM_NONE) finishAnimation(anims_[i]);
   }
+}
 
-  if (!meridian || meridian->length == 0) {
-    stopFlow();
-    return;
+// 循行前进一步：重画经络区间，返回是否改写了灯带
+bool TCMMeridianSystem::stepFlow(Animation& a, uint32_t now) {
+  if (a.meridian >= meridians_.size() || meridians_[a.meridian].length == 0) {
+    // 配置重新加载后经络不存在了
+    finishAnimation(a);
+    return false;
   }
+  const MeridianInfo& m = meridians_[a.meridian];
 
-  for (uint16_t i = 0; i < meridian->length; i++) {
-    uint16_t idx = meridian->startIndex + i;
+  for (uint16_t i = 0; i < m.length; i++) {
+    uint16_t idx = m.startIndex + i;
     if (idx < numLeds_) {
       leds_[idx] = CRGB::Black;
     }
   }
 
-  for (uint8_t t = 0; t < flowTailLength_; t++) {
-    int16_t pos = (int16_t)flowHead_ - (int16_t)t;
-    if (pos >= 0 && pos < (int16_t)meridian->length) {
-      uint16_t idx = meridian->startIndex + (uint16_t)pos;
+  for (uint8_t t = 0; t < a.tail; t++) {
+    int16_t pos = (int16_t)a.step - (int16_t)t;
+    if (pos >= 0 && pos < (int16_t)m.length) {
+      uint16_t idx = m.startIndex + (uint16_t)pos;
       if (idx < numLeds_) {
-        uint8_t brightness = 255 - ((255 * t) / flowTailLength_);
-        leds_[idx] = meridian->color;
+        uint8_t brightness = 255 - ((255 * t) / a.tail);
+        leds_[idx] = m.color;
         leds_[idx].nscale8(brightness);
       }
     }
   }
 
-  for (uint16_t apIdx : meridian->acupoints) {
-    if (apIdx >= meridian->length) {
+  for (uint16_t apIdx : m.acupoints) {
+    if (apIdx >= m.length) {
       continue;
     }
-    if (flowHead_ >= apIdx && (flowHead_ - apIdx) < flowTailLength_) {
-      uint16_t idx = meridian->startIndex + apIdx;
+    if (a.step >= apIdx && (a.step - apIdx) < a.tail) {
+      uint16_t idx = m.startIndex + apIdx;
       if (idx < numLeds_) {
         leds_[idx] = CRGB::White;
       }
     }
   }
 
-  FastLED.show();
+  // 闪烁中的灯被循行改写：记下循行画的颜色，闪烁结束时恢复它，而不是闪烁开始时的旧画面
+  for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+    Animation& b = anims_[i];
+    if (b.kind == ANIM_BLINK && b.start >= m.startIndex && b.start < m.startIndex + m.length) {
+      b.saved = leds_[b.start];
+    }
+  }
 
-  flowHead_++;
+  a.step++;
+  a.dueMs = now + a.intervalMs;
+  if (a.step < m.length + a.tail) {
+    return true;
+  }
+
+  // 走完一条经络：单经结束，全身模式停顿后换下一条有灯的经络
+  size_t next = a.meridian + 1;
+  while (a.all && next < meridians_.size() && meridians_[next].length == 0) next++;
+  if (!a.all || next >= meridians_.size()) {
+    finishAnimation(a);
+  } else {
+    a.meridian = (uint8_t)next;
+    a.step = 0;
+    a.dueMs = now + FLOW_PAUSE_MS;
+  }
+  return true;
+}
+
+// 闪烁与渐变画在循行之上：每次有改动时按当前状态重画
+void TCMMeridianSystem::drawOverlay(const Animation& a, uint32_t now) {
+  if (a.kind == ANIM_BLINK) {
+    leds_[a.start] = (a.step & 1) ? CRGB(CRGB::Black) : a.color;
+  } else if (a.kind == ANIM_FADE) {
+    uint32_t elapsed = now - a.startMs;
+    if (elapsed > a.intervalMs) elapsed = a.intervalMs;
+    uint8_t level = (uint8_t)(elapsed * 255u / a.intervalMs);
+    if (!a.fadeIn) level = 255 - level;
+    CRGB c = a.color;
+    if (level < 255) c.nscale8_video(level);
+    fill_solid(leds_ + a.start, a.length, c);
+  }
+}
 
-  if (flowHead_ >= meridian->length + flowTailLength_) {
-    if (flowMode_ == FLOW_SINGLE) {
-      stopFlow();
-    } else if (flowMode_ == FLOW_ALL) {
-      flowHead_ = 0;
-      flowMeridianIndex_++;
-      if (flowMeridianIndex_ >= meridians_.size()) {
-        stopFlow();
+void TCMMeridianSystem::tickFlow() {
+  uint32_t now = millis();
+  bool changed = false;
+
+  for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+    Animation& a = anims_[i];
+    if (a.kind == ANIM_NONE || (int32_t)(now - a.dueMs) < 0) continue;
+
+    if (a.kind == ANIM_FLOW) {
+      if (stepFlow(a, now)) changed = true;
+    } else if (a.kind == ANIM_BLINK) {
+      // 每个半周期切换一次亮灭，走完后恢复原色
+      changed = true;
+      if (++a.step >= a.steps) {
+        finishAnimation(a);
       } else {
-        flowInPause_ = true;
-        flowPauseEndMs_ = now + flowPauseMs_;
+        a.dueMs = now + a.intervalMs;
+      }
+    } else if (a.kind == ANIM_FADE) {
+      // 渐变每帧都变，最后一帧画到终值后结束
+      changed = true;
+      if (now - a.startMs >= a.intervalMs) {
+        drawOverlay(a, now);
+        finishAnimation(a);
       }
     }
   }
+
+  if (!changed) return;
+  for (uint8_t i = 0; i < MAX_ANIMATIONS; i++) {
+    if (anims_[i].kind == ANIM_BLINK || anims_[i].kind == ANIM_FADE) drawOverlay(anims_[i], now);
+  }
+  present();
 }
@@ -35,7 +35,9 @@ struct MeridianInfo {
 
 // 定义穴位信息结构体
 struct AcupointInfo {
-  uint16_t globalIndex;     // 全局索引
+  static const uint16_t NO_LED = 0xFFFF; // globalIndex 取此值：所在经络未启用或穴位不在经络区间内，只供查询
+
+  uint16_t globalIndex;     // 全局索引（NO_LED 表示没有对应的灯珠）
   uint16_t localIndex;      // 在经络内的索引
   MeridianType meridian;   // 所属经络
   const char* name;        // 穴位名称
@@ -45,6 +47,8 @@ struct AcupointInfo {
   const char* functions;   // 功效
   const char* indications; // 适应症
   uint8_t importance;       // 重要性级别 (1-5)
+
+  bool mapped() const { return globalIndex != NO_LED; }
 };
 
 /**
@@ -65,6 +69,7 @@ class MeridianConfig;
 
 // 现在包含配置文件
 #include "meridian_config.hpp"
+#include "acupoint_index.hpp"
 
 /**
  * 中医经络模拟控制类
@@ -118,20 +123,28 @@ public:
     ziwuliuzhuTimeSlots_.clear();
     acupoints_.clear();
     
-    // 加载配置
-    if (!MeridianConfig::loadAllMeridians(configFiles, meridians_, ziwuliuzhuTimeSlots_)) {
+    // 加载配置（穴位的名称、拼音与详情随经络一起读入）
+    if (!MeridianConfig::loadAllMeridians(configFiles, meridians_, ziwuliuzhuTimeSlots_, &acupoints_)) {
       Serial.println("加载经络配置失败");
+      // 回退到内置经络前清掉部分加载的数据
+      meridians_.clear();
+      acupoints_.clear();
       return false;
     }
     
-    // 计算经络起始位置
+    // 计算经络起始位置，再换算配置穴位的全局索引；未启用经络上的穴位保留供查询，但不对应灯珠
     calculateMeridianStartIndices();
+    for (auto& acupoint : acupoints_) {
+      int mi = findMeridian(acupoint.meridian);
+      acupoint.globalIndex = AcupointInfo::NO_LED;
+      if (mi >= 0) acupoint.globalIndex = acupointLed(meridians_[mi], acupoint.localIndex);
+    }
     
-    // 初始化穴位（使用已有的示例/常用穴位逻辑，避免未初始化指针）
+    // 补上配置中没有的穴位（示例名称与常用穴位），并建立查找索引
     initAcupoints();
     
     Serial.printf("成功加载 %d 条经络和 %d 个穴位\n", 
-                 meridians_.size(), acupoints_.size());
+                 (int)meridians_.size(), (int)acupoints_.size());
     
     return true;
   }
@@ -144,21 +157,40 @@ public:
   
   // 初始化
   void begin() {
-    FastLED.clear();
-    FastLED.show();
+    clearLeds();
+    present();
     
     // 初始化子午流注时间表
     initZiwuliuzhu();
   }
   
+  // 共享外部灯带缓冲时的发送函数（如控制器的 presentExternal），未设置时直接 FastLED.show()
+  typedef void (*ShowFn)();
+  void setShowHook(ShowFn fn) { showFn_ = fn; }
+
+  // 共享外部缓冲时的亮度设置（交给画布统一缩放与限流），未设置时直接设 FastLED 亮度
+  typedef void (*BrightnessFn)(uint8_t);
+  void setBrightnessHook(BrightnessFn fn) { brightnessFn_ = fn; }
+
   // 设置全局亮度
   void setBrightness(uint8_t brightness) {
-    FastLED.setBrightness(brightness);
+    if (brightnessFn_) brightnessFn_(brightness);
+    else FastLED.setBrightness(brightness);
   }
   
-  // 显示特定经络
-  void showMeridian(MeridianType type) {
-    FastLED.clear();
+  // 经络是否占有灯珠：存在、长度不为 0（配置中未启用的经络长度为 0）且起点在灯带内
+  bool meridianHasLeds(MeridianType type) const {
+    int mi = findMeridian(type);
+    return mi >= 0 && meridians_[mi].length > 0 && meridians_[mi].startIndex < numLeds_;
+  }
+
+  // 显示特定经络；fadeMs 不为 0 时先清屏，再由动画队列渐亮，渐亮没能入队（经络没有灯珠或队列已满）时返回 false
+  bool showMeridian(MeridianType type, uint16_t fadeMs = 0) {
+    clearLeds();
+    if (fadeMs > 0) {
+      present();
+      return fadeMeridian(type, fadeMs, true);
+    }
     
     for (const auto& meridian : meridians_) {
       if (meridian.type == type) {
@@ -172,12 +204,13 @@ public:
       }
     }
     
-    FastLED.show();
+    present();
+    return true;
   }
   
   // 显示所有经络
   void showAllMeridians() {
-    FastLED.clear();
+    clearLeds();
     
     for (const auto& meridian : meridians_) {
       for (uint16_t i = 0; i < meridian.length; i++) {
@@ -188,138 +221,78 @@ public:
       }
     }
     
-    FastLED.show();
+    present();
   }
   
-  // 显示特定穴位
+  // 显示特定穴位（英文名、中文名或拼音）
   void showAcupoint(const char* name, CRGB color = CRGB::White) {
-    for (const auto& acupoint : acupoints_) {
-      if (strcmp(acupoint.name, name) == 0) {
-        leds_[acupoint.globalIndex] = color;
-        FastLED.show();
-        return;
-      }
+    const AcupointInfo* acupoint = findAcupoint(name);
+    if (acupoint && acupoint->mapped() && acupoint->globalIndex < numLeds_) {
+      leds_[acupoint->globalIndex] = color;
+      present();
     }
   }
+
+  // 按英文名、中文名或拼音查找穴位（字母不分大小写，忽略空格与连字符），找不到返回 nullptr
+  const AcupointInfo* findAcupoint(const char* key) {
+    if (acupointIndex_.builtCount() != acupoints_.size()) acupointIndex_.build(acupoints_);
+    int i = acupointIndex_.find(key);
+    return i < 0 ? nullptr : &acupoints_[i];
+  }
+
+  // 按三个键的前缀联想，写入最多 max 个穴位下标（getAcupoints() 中的位置），返回个数
+  uint8_t searchAcupoints(const char* prefix, uint16_t* out, uint8_t max) {
+    if (acupointIndex_.builtCount() != acupoints_.size()) acupointIndex_.build(acupoints_);
+    return acupointIndex_.search(prefix, out, max);
+  }
   
   // 显示单个像素
   void showPixel(uint16_t index, CRGB color) {
     if (index < numLeds_) {
       leds_[index] = color;
-      FastLED.show();
+      present();
     }
   }
   
-  // 闪烁特定穴位
-  void blinkAcupoint(const char* name, uint8_t times = 3, uint16_t interval = 200, CRGB color = CRGB::White) {
-    for (const auto& acupoint : acupoints_) {
-      if (strcmp(acupoint.name, name) == 0) {
-        CRGB originalColor = leds_[acupoint.globalIndex];
-        
-        for (uint8_t i = 0; i < times; i++) {
-          leds_[acupoint.globalIndex] = color;
-          FastLED.show();
-          delay(interval);
-          
-          leds_[acupoint.globalIndex] = CRGB::Black;
-          FastLED.show();
-          delay(interval);
-        }
-        
-        leds_[acupoint.globalIndex] = originalColor;
-        FastLED.show();
-        return;
-      }
-    }
-  }
-  
-  // 模拟经络循行效果
-  void flowMeridian(MeridianType type, uint8_t tailLength = 5, uint16_t interval = 30) {
-    MeridianInfo* meridian = nullptr;
-    
-    // 查找指定经络
-    for (auto& m : meridians_) {
-      if (m.type == type) {
-        meridian = &m;
-        break;
-      }
-    }
-    
-    if (!meridian) return;
-    
-    // 清除当前显示
-    FastLED.clear();
-    
-    // 循行效果
-    for (uint16_t head = 0; head < meridian->length + tailLength; head++) {
-      // 清除上一帧
-      for (uint16_t i = 0; i < meridian->length; i++) {
-        uint16_t idx = meridian->startIndex + i;
-        if (idx < numLeds_) {
-          leds_[idx] = CRGB::Black;
-        }
-      }
-      
-      // 绘制流动效果
-      for (uint8_t t = 0; t < tailLength; t++) {
-        int16_t pos = head - t;
-        if (pos >= 0 && pos < meridian->length) {
-          uint16_t idx = meridian->startIndex + pos;
-          if (idx < numLeds_) {
-            // 计算尾部衰减
-            uint8_t brightness = 255 - ((255 * t) / tailLength);
-            leds_[idx] = meridian->color;
-            leds_[idx].nscale8(brightness);
-          }
-        }
-      }
-      
-      // 高亮显示经过的穴位
-      for (uint16_t apIdx : meridian->acupoints) {
-        if (apIdx >= meridian->length) {
-          continue;
-        }
-        if (head >= apIdx && head - apIdx < tailLength) {
-          // 穴位在尾部范围内，设置为白色高亮
-          uint16_t idx = meridian->startIndex + apIdx;
-          if (idx < numLeds_) {
-            leds_[idx] = CRGB::White;
-          }
-        }
-      }
-      
-      FastLED.show();
-      delay(interval);
-    }
-  }
-  
-  // 模拟全身经络循环
-  void flowAllMeridians(uint16_t interval = 30) {
-    for (const auto& meridian : meridians_) {
-      flowMeridian(meridian.type, 5, interval);
-      delay(500); // 经络间短暂停顿
-    }
+  // ---------- 非阻塞动画（在 loop 中通过 tickFlow 推进） ----------
+  // 最多 MAX_ANIMATIONS 个动画同时进行：不同经络的循行、穴位闪烁、渐变可以叠加，
+  // 每帧先推进循行，再把闪烁与渐变画在上面，有变化时只发送一次。队列满时启动函数返回 false
+
+  // 闪烁特定穴位：times 次亮灭，每次 interval 毫秒，结束后恢复原来的颜色；
+  // 穴位没有对应的灯珠（!mapped()）或队列已满时返回 false
+  bool blinkAcupoint(const AcupointInfo& acupoint, uint8_t times = 3, uint16_t interval = 200, CRGB color = CRGB::White);
+  bool blinkAcupoint(const char* name, uint8_t times = 3, uint16_t interval = 200, CRGB color = CRGB::White) {
+    const AcupointInfo* acupoint = findAcupoint(name);
+    return acupoint && blinkAcupoint(*acupoint, times, interval, color);
   }
-  
-  // ---------- 非阻塞版经络循行接口（在 loop 中通过 tickFlow 调用） ----------
 
-  // 启动单条经络循行（非阻塞，一次性播放）
-  void startSingleFlow(MeridianType type, uint8_t tailLength = 5, uint16_t interval = 30);
+  // 经络渐亮（fadeIn）或渐暗到黑，用时 durationMs
+  bool fadeMeridian(MeridianType type, uint16_t durationMs, bool fadeIn = true);
+
+  // 启动单条经络循行（一次性播放），替换同一经络上正在进行的循行
+  bool startSingleFlow(MeridianType type, uint8_t tailLength = 5, uint16_t interval = 30);
 
-  // 启动全身经络依次循行（非阻塞，一次性播放）
-  void startAllFlow(uint8_t tailLength = 5, uint16_t interval = 30);
+  // 启动全身经络依次循行（一次性播放），替换所有循行
+  bool startAllFlow(uint8_t tailLength = 5, uint16_t interval = 30);
 
-  // 按当前子午流注对应经络启动一次循行（非阻塞）
-  void startCurrentTimeFlow(uint8_t tailLength = 5, uint16_t interval = 30);
+  // 按当前子午流注对应经络启动一次循行
+  bool startCurrentTimeFlow(uint8_t tailLength = 5, uint16_t interval = 30);
 
-  // 停止当前动画（保持最后一帧画面）
+  // 原来阻塞（delay）的循行接口，现在同样只是启动动画
+  bool flowMeridian(MeridianType type, uint8_t tailLength = 5, uint16_t interval = 30) {
+    return startSingleFlow(type, tailLength, interval);
+  }
+  bool flowAllMeridians(uint16_t interval = 30) { return startAllFlow(5, interval); }
+
+  // 停止所有动画（保持最后一帧画面，闪烁中的穴位恢复原色）
   void stopFlow();
 
-  // 在主循环中周期调用，用于推进一帧动画
+  // 在主循环中周期调用，推进到期的动画
   void tickFlow();
 
   // 是否有动画在进行中
-  bool isFlowActive() const { return flowMode_ != FLOW_NONE; }
+  bool isFlowActive() const { return animationCount() > 0; }
+  uint8_t animationCount() const;
   
   // 获取经络信息
   const std::vector<MeridianInfo>& getMeridians() const {
@@ -368,12 +341,10 @@ public:
     return LUNG;
   }
   
-  // 根据当前时间自动切换并流动经络
-  void flowCurrentTimeMeridian(uint8_t tailLength = 5, uint16_t interval = 30) {
-    if (!ziwuliuzhuEnabled_) return;
-    
-    MeridianType activeMeridian = getCurrentActiveMeridian();
-    flowMeridian(activeMeridian, tailLength, interval);
+  // 根据当前时间自动切换并流动经络（非阻塞）
+  bool flowCurrentTimeMeridian(uint8_t tailLength = 5, uint16_t interval = 30) {
+    if (!ziwuliuzhuEnabled_) return false;
+    return startCurrentTimeFlow(tailLength, interval);
   }
   
   // 获取当前活跃经络的时间段描述
@@ -417,29 +388,56 @@ private:
   uint8_t pin_;                    // LED数据引脚
   std::vector<MeridianInfo> meridians_;  // 经络信息
   std::vector<AcupointInfo> acupoints_;  // 穴位信息
+  AcupointIndex acupointIndex_;          // 穴位名/中文名/拼音索引
   // 子午流注相关变量
   bool ziwuliuzhuEnabled_;
   MeridianType currentMeridian_;
   std::vector<ZiwuliuzhuTimeSlot> ziwuliuzhuTimeSlots_;
   bool ownsLeds_;
+  ShowFn showFn_ = nullptr;
+  BrightnessFn brightnessFn_ = nullptr;
+
+  // 只清自己的缓冲：共享画布时 FastLED 绑定的是画布的发送缓冲，FastLED.clear() 清不到 leds_
+  void clearLeds() { fill_solid(leds_, numLeds_, CRGB::Black); }
+  void present() {
+    if (showFn_) showFn_();
+    else FastLED.show();
+  }
   
-  // 非阻塞动画状态机
-  enum FlowMode {
-    FLOW_NONE,
-    FLOW_SINGLE,
-    FLOW_ALL
+  // 非阻塞动画队列：固定槽位，kind 为 ANIM_NONE 的槽位空闲
+  enum AnimKind : uint8_t {
+    ANIM_NONE,
+    ANIM_FLOW,   // 经络循行：拖尾沿经络前进，经过的穴位高亮
+    ANIM_BLINK,  // 单颗灯亮灭
+    ANIM_FADE    // 一段灯的颜色线性渐变
+  };
+
+  struct Animation {
+    AnimKind kind = ANIM_NONE;
+    bool all = false;          // 循行：依次走完全部经络
+    bool fadeIn = true;        // 渐变：由黑到 color，否则由 color 到黑
+    uint8_t tail = 5;          // 循行：拖尾长度
+    uint8_t meridian = 0;      // 循行：meridians_ 中的下标
+    uint16_t start = 0;        // 作用的灯带区间（闪烁为 1 颗）
+    uint16_t length = 0;
+    uint16_t intervalMs = 30;  // 每步间隔；渐变为总时长
+    uint16_t step = 0;         // 循行的 head / 闪烁已走的半周期
+    uint16_t steps = 0;        // 闪烁的半周期总数
+    uint32_t startMs = 0;      // 渐变开始时间
+    uint32_t dueMs = 0;        // 下一步的时间（循行在经络间停顿时推迟）
+    CRGB color;
+    CRGB saved;                // 闪烁结束后恢复的颜色（闪烁前的颜色，期间有循行经过时为循行的颜色）
   };
 
-  FlowMode flowMode_ = FLOW_NONE;
-  uint8_t flowTailLength_ = 5;
-  uint16_t flowIntervalMs_ = 30;
-  uint32_t lastFlowStepMs_ = 0;
-  uint16_t flowHead_ = 0;              // 当前 head 位置
-  size_t flowMeridianIndex_ = 0;       // FLOW_ALL 模式下当前经络索引
-  bool flowInPause_ = false;           // 全身模式经络间暂停标志
-  uint32_t flowPauseEndMs_ = 0;        // 暂停结束时间
-  uint16_t flowPauseMs_ = 500;         // 经络之间的暂停时间
-  MeridianType flowSingleMeridian_ = LUNG; // 单经模式下的经络
+  static const uint8_t MAX_ANIMATIONS = 8;
+  static const uint16_t FLOW_PAUSE_MS = 500; // 全身循行时经络之间的停顿
+  Animation anims_[MAX_ANIMATIONS];
+
+  Animation* allocAnimation();
+  void finishAnimation(Animation& a);
+  bool stepFlow(Animation& a, uint32_t now);
+  void drawOverlay(const Animation& a, uint32_t now);
+  int findMeridian(MeridianType type) const;
   
   // 检查当前时间是否在指定时间段内
   bool isTimeInSlot(uint8_t hour, uint8_t minute, const ZiwuliuzhuTimeSlot& slot) {
@@ -459,6 +457,14 @@ private:
     return currentMinutes >= startMinutes && currentMinutes < endMinutes;
   }
   
+  // 经络内第 localIndex 个位置对应的灯珠：超出经络长度（配置中未启用的经络长度为 0）或灯带时返回 NO_LED
+  uint16_t acupointLed(const MeridianInfo& meridian, uint16_t localIndex) const {
+    if (localIndex >= meridian.length) return AcupointInfo::NO_LED;
+    uint32_t idx = (uint32_t)meridian.startIndex + localIndex;
+    if (idx >= numLeds_) return AcupointInfo::NO_LED;
+    return (uint16_t)idx;
+  }
+
   // 计算经络起始位置
   void calculateMeridianStartIndices() {
     if (meridians_.empty()) {
@@ -546,7 +552,7 @@ private:
         }
         // 创建穴位信息对象
         AcupointInfo acupoint;
-        acupoint.globalIndex = meridian.startIndex + localIdx;
+        acupoint.globalIndex = acupointLed(meridian, localIdx);
         acupoint.localIndex = localIdx;
         acupoint.meridian = meridian.type;
 
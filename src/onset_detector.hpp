@@ -0,0 +1,331 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * 谱通量起音检测 + 自相关速度估计
+ * 每个分析帧输入一次幅度谱：
+ *   1. 幅度取 log2（Q8 定点，只需前导零计数），与上一帧相减后半波整流求和得到谱通量，
+ *      对持续的大音量不敏感，只对能量突增响应
+ *   2. 自适应阈值 = 通量的指数滑动均值 + k·平均绝对偏差，且不低于均值的 MIN_RISE 倍，再做局部峰值与不应期判定
+ *   3. 通量包络按 50Hz 抽取后做自相关，带 120BPM 附近的对数高斯先验，得到 BPM；
+ *      包络时段内检测到的起音不足 MIN_LOCK_ONSETS 个时不锁定（持续音与噪声的包络起伏也可能呈现周期性）
+ *   4. 按估计的周期预测节拍网格，起音只用于微调相位（简单锁相），因此效果可以提前安排脉冲
+ * 时间基准是音频帧时间（样本数/采样率），与 millis() 无关，主机端回放时结果一致。
+ */
+class OnsetDetector {
+public:
+  OnsetDetector() { reset(); }
+
+  void reset() {
+    memset(prevLog_, 0, sizeof(prevLog_));
+    prevBins_ = 0;
+    t_ = 0.0f;
+    fluxMean_ = 0.0f;
+    fluxDev_ = 0.0f;
+    statsFrames_ = 0;
+    flux1_ = flux2_ = 0.0f;
+    thresh1_ = 0.0f;
+    lastOnset_ = NO_ONSET;
+    onset_ = false;
+    onsets_ = 0;
+    for (uint8_t i = 0; i < MIN_LOCK_ONSETS; i++) recentOnsets_[i] = NO_ONSET;
+    recentPos_ = 0;
+    envAcc_ = 0.0f;
+    envTime_ = 0.0f;
+    envPos_ = 0;
+    envFill_ = 0;
+    sinceTempo_ = 0.0f;
+    bpm_ = 0.0f;
+    candidateBpm_ = 0.0f;
+    tempoConf_ = 0.0f;
+    lowConf_ = 0;
+    lastBeat_ = 0.0f;
+    nextBeat_ = 0.0f;
+    beats_ = 0;
+    memset(env_, 0, sizeof(env_));
+  }
+
+  /**
+   * 处理一帧幅度谱
+   * @param mag     幅度谱（bin 0 为直流）
+   * @param bins    bin 数
+   * @param frameDt 帧间隔（秒），即 hop / fs
+   * @param floor   幅度底噪，取对数前加上，避免噪声级别的小幅度波动被对数放大成通量
+   */
+  void process(const uint32_t* mag, uint16_t bins, float frameDt, uint32_t floor) {
+    if (bins > MAX_BINS) bins = MAX_BINS;
+    t_ += frameDt;
+    onset_ = false;
+    if (t_ > REBASE_S) rebase();
+
+    // 1. 谱通量（log2 幅度的正向差，按 bin 数归一化，与窗口长度无关）
+    // 底噪再按本帧最强 bin 抬高到 -30dB：响亮的持续音其窗函数旁瓣（约 -43dB）随相位起伏，
+    // 若低于底噪之上会在对数域里产生周期性的假通量
+    uint32_t peak = 0;
+    for (uint16_t k = 1; k < bins; k++) {
+      if (mag[k] > peak) peak = mag[k];
+    }
+    floor += peak >> 5;
+    uint32_t sum = 0;
+    for (uint16_t k = 1; k < bins; k++) {
+      uint16_t l = log2q8(mag[k] + floor + 1);
+      if (l > prevLog_[k]) sum += l - prevLog_[k];
+      prevLog_[k] = l;
+    }
+    float flux = 0.0f;
+    const bool valid = prevBins_ == bins;
+    if (valid) flux = (float)sum / (256.0f * (float)(bins - 1));
+    prevBins_ = bins; // 窗口变化后的第一帧只建立基准
+
+    // 2. 自适应阈值（用上一帧的统计量，当前帧不影响自身判定）
+    float a = 1.0f - expf(-frameDt / STATS_TAU);
+    float thresh = fluxMean_ + thresholdK_ * fluxDev_ + THRESH_FLOOR;
+    // 噪声与持续音的通量峰值不超过均值的约 1.8 倍，真实起音通常高出数倍，相对门限挡住前者
+    if (thresh < fluxMean_ * MIN_RISE) thresh = fluxMean_ * MIN_RISE;
+
+    // 局部峰值判定有一帧延迟：判断上一帧是否为峰；统计量积累满 WARMUP_FRAMES 之前不判定，
+    // 否则从 0 起步的均值会把开头几帧的常态通量当成起音
+    if (statsFrames_ > WARMUP_FRAMES && flux1_ > thresh1_ && flux1_ >= flux2_ && flux1_ > flux &&
+        (t_ - frameDt) - lastOnset_ >= REFRACTORY_S) {
+      onset_ = true;
+      onsets_++;
+      lastOnset_ = t_ - frameDt;
+      recentOnsets_[recentPos_] = lastOnset_;
+      recentPos_ = (recentPos_ + 1) % MIN_LOCK_ONSETS;
+      correctPhase(lastOnset_);
+    }
+
+    // 开始阶段按累计平均更新统计量，之后转为指数滑动
+    if (valid && statsFrames_ < 0xFFFF) statsFrames_++;
+    if (statsFrames_ > 0 && a < 1.0f / statsFrames_) a = 1.0f / statsFrames_;
+
+    float dev = flux - fluxMean_;
+    fluxMean_ += a * dev;
+    fluxDev_ += a * ((dev > 0 ? dev : -dev) - fluxDev_);
+    flux2_ = flux1_;
+    flux1_ = flux;
+    thresh1_ = thresh;
+
+    // 3. 起音强度包络（高于均值的部分），抽取到 ENV_HZ
+    float strength = flux - fluxMean_;
+    if (strength > envAcc_) envAcc_ = strength; // 抽取区间内取最大值，保留尖峰
+    envTime_ += frameDt;
+    while (envTime_ >= ENV_DT) {
+      envTime_ -= ENV_DT;
+      env_[envPos_] = envAcc_ > 0.0f ? envAcc_ : 0.0f;
+      envPos_ = (envPos_ + 1) % ENV_LEN;
+      if (envFill_ < ENV_LEN) envFill_++;
+      envAcc_ = 0.0f;
+    }
+
+    sinceTempo_ += frameDt;
+    if (sinceTempo_ >= TEMPO_INTERVAL_S && envFill_ >= ENV_MIN_FILL) {
+      sinceTempo_ = 0.0f;
+      estimateTempo();
+    }
+
+    // 4. 节拍网格
+    advanceBeats();
+  }
+
+  // 自适应阈值中偏差项的倍数，越大越不敏感
+  void setThresholdK(float k) { thresholdK_ = k < 0.5f ? 0.5f : (k > 5.0f ? 5.0f : k); }
+  float thresholdK() const { return thresholdK_; }
+
+  // 最近一帧是否检测到起音
+  bool onset() const { return onset_; }
+  uint32_t onsetCount() const { return onsets_; }
+
+  // 节拍计数（每个预测节拍点 +1；速度未知时每个起音 +1）
+  uint32_t beatCount() const { return beats_; }
+
+  // 当前速度（BPM），未锁定时为 0
+  float bpm() const { return bpm_; }
+  float tempoConfidence() const { return tempoConf_; }
+
+  // 当前节拍内的相位 0..1（0 = 刚刚到达节拍点）
+  float beatPhase() const {
+    if (bpm_ > 0.0f) {
+      float p = (t_ - lastBeat_) * bpm_ / 60.0f;
+      if (p < 0.0f) p = 0.0f;
+      if (p > 1.0f) p = 1.0f;
+      return p;
+    }
+    if (beats_ == 0) return 1.0f;
+    float p = (t_ - lastBeat_) / 0.5f;
+    return p > 1.0f ? 1.0f : p;
+  }
+
+  float flux() const { return flux1_; }
+
+private:
+  static const uint16_t MAX_BINS = 256;
+  static const uint16_t ENV_LEN = 256;          // 5.12 秒包络
+  static const uint16_t ENV_MIN_FILL = 150;     // 至少 3 秒才估计速度
+  static constexpr float ENV_DT = 0.02f;        // 包络抽取间隔（50Hz）
+  static constexpr float STATS_TAU = 0.5f;      // 阈值统计时间常数（秒）
+  static constexpr float THRESH_FLOOR = 0.02f;  // 安静时的最低通量阈值
+  static constexpr float MIN_RISE = 2.0f;       // 阈值不低于通量均值的倍数
+  static const uint16_t WARMUP_FRAMES = 8;      // 统计量积累的最少帧数
+  static constexpr float REFRACTORY_S = 0.1f;   // 起音不应期
+  static constexpr float TEMPO_INTERVAL_S = 0.5f;
+  static constexpr float REBASE_S = 1000.0f;
+  static constexpr float NO_ONSET = -1.0e6f;
+  static constexpr float MIN_BPM = 60.0f;
+  static constexpr float MAX_BPM = 180.0f;
+
+  // log2(v)，Q8 定点：整数部分取最高位位置，小数部分取其后 8 位
+  static uint16_t log2q8(uint32_t v) {
+    int msb = 31 - __builtin_clz(v);
+    uint32_t frac = msb >= 8 ? (v >> (msb - 8)) & 0xFF : (v << (8 - msb)) & 0xFF;
+    return (uint16_t)((msb << 8) | frac);
+  }
+
+  // 对起音强度包络做自相关，在 60–180BPM 范围内选峰
+  void estimateTempo() {
+    // 按时间顺序展开
+    float e[ENV_LEN];
+    uint16_t n = envFill_;
+    uint16_t start = (envPos_ + ENV_LEN - n) % ENV_LEN;
+    float mean = 0.0f;
+    for (uint16_t i = 0; i < n; i++) { e[i] = env_[(start + i) % ENV_LEN]; }
+    // [1 2 1]/4 平滑：周期不是整数个包络点时，峰值不会因量化而被拆散到相邻滞后上
+    float prev = e[0];
+    for (uint16_t i = 1; i + 1 < n; i++) {
+      float cur = e[i];
+      e[i] = 0.25f * prev + 0.5f * cur + 0.25f * e[i + 1];
+      prev = cur;
+    }
+    for (uint16_t i = 0; i < n; i++) mean += e[i];
+    mean /= n;
+    for (uint16_t i = 0; i < n; i++) e[i] -= mean;
+
+    const uint16_t lagMin = (uint16_t)(60.0f / (MAX_BPM * ENV_DT));
+    const uint16_t lagMax = (uint16_t)(60.0f / (MIN_BPM * ENV_DT)) + 1;
+    float r[64];
+    float r0 = 0.0f;
+    for (uint16_t i = 0; i < n; i++) r0 += e[i] * e[i];
+    if (r0 <= 0.0f) return;
+
+    uint16_t best = 0;
+    float bestScore = 0.0f;
+    for (uint16_t lag = lagMin - 1; lag <= lagMax + 1 && lag < 64; lag++) {
+      float acc = 0.0f;
+      for (uint16_t i = 0; i + lag < n; i++) acc += e[i] * e[i + lag];
+      r[lag] = acc / (float)(n - lag);
+      if (lag < lagMin || lag > lagMax) continue;
+      // 以 120BPM 为中心的对数高斯先验，抑制倍频/半频误判
+      float oct = log2f((60.0f / (lag * ENV_DT)) / 120.0f);
+      float score = r[lag] * expf(-0.5f * oct * oct / (0.9f * 0.9f));
+      if (score > bestScore) { bestScore = score; best = lag; }
+    }
+    tempoConf_ = best ? r[best] * (float)n / r0 : 0.0f;
+    if (tempoConf_ > 1.0f) tempoConf_ = 1.0f;
+    // 最早的一个记录起音仍落在包络时段内，说明这段包络里至少有 MIN_LOCK_ONSETS 个起音
+    const bool enoughOnsets = t_ - recentOnsets_[recentPos_] <= n * ENV_DT;
+    if (best == 0 || tempoConf_ < MIN_TEMPO_CONF || !enoughOnsets) {
+      // 连续几次都没有明显周期或起音（音乐停止或只剩持续音、噪声）时解除锁定，回到逐起音模式
+      if (bpm_ > 0.0f && ++lowConf_ >= UNLOCK_ESTIMATES) {
+        bpm_ = 0.0f;
+        candidateBpm_ = 0.0f;
+      }
+      return;
+    }
+    lowConf_ = 0;
+
+    float lag = (float)best;
+    float den = r[best - 1] - 2.0f * r[best] + r[best + 1];
+    if (den < 0.0f) {
+      float d = 0.5f * (r[best - 1] - r[best + 1]) / den;
+      if (d > -0.5f && d < 0.5f) lag += d;
+    }
+    float est = 60.0f / (lag * ENV_DT);
+
+    if (bpm_ <= 0.0f) {
+      // 首次锁定：以最近一次起音为节拍起点
+      bpm_ = est;
+      lastBeat_ = lastOnset_ > NO_ONSET ? lastOnset_ : t_;
+      nextBeat_ = lastBeat_ + 60.0f / bpm_;
+      while (nextBeat_ <= t_) { lastBeat_ = nextBeat_; nextBeat_ += 60.0f / bpm_; }
+    } else if (fabsf(est - bpm_) <= bpm_ * 0.08f) {
+      bpm_ += 0.3f * (est - bpm_);
+      candidateBpm_ = 0.0f;
+    } else if (candidateBpm_ > 0.0f && fabsf(est - candidateBpm_) <= candidateBpm_ * 0.08f) {
+      bpm_ = est; // 连续两次得到一致的新速度才切换
+      candidateBpm_ = 0.0f;
+    } else {
+      candidateBpm_ = est;
+    }
+  }
+
+  // float 时间长期累加会损失精度，定期整体平移时间基准
+  void rebase() {
+    t_ -= REBASE_S;
+    lastBeat_ -= REBASE_S;
+    nextBeat_ -= REBASE_S;
+    if (lastOnset_ > NO_ONSET) lastOnset_ -= REBASE_S;
+    for (uint8_t i = 0; i < MIN_LOCK_ONSETS; i++) {
+      if (recentOnsets_[i] > NO_ONSET) recentOnsets_[i] -= REBASE_S;
+    }
+  }
+
+  // 推进预测的节拍网格
+  void advanceBeats() {
+    if (bpm_ <= 0.0f) return;
+    const float period = 60.0f / bpm_;
+    if (t_ >= nextBeat_) {
+      beats_++;
+      lastBeat_ = nextBeat_;
+      nextBeat_ += period;
+      while (nextBeat_ <= t_) { lastBeat_ = nextBeat_; nextBeat_ += period; }
+    }
+  }
+
+  // 起音落在网格点附近时把相位向起音拉近；速度未知时起音直接当作节拍
+  void correctPhase(float onsetTime) {
+    if (bpm_ <= 0.0f) {
+      beats_++;
+      lastBeat_ = onsetTime;
+      return;
+    }
+    const float period = 60.0f / bpm_;
+    float err = onsetTime - lastBeat_;
+    if (err > 0.5f * period) err -= period;
+    if (fabsf(err) < 0.25f * period) {
+      lastBeat_ += PHASE_GAIN * err;
+      nextBeat_ = lastBeat_ + period;
+      if (nextBeat_ <= t_) nextBeat_ = t_; // 已越过则立即触发
+    }
+  }
+
+  static constexpr float MIN_TEMPO_CONF = 0.3f; // 纯噪声的包络自相关约 0.1~0.2
+  static const uint8_t UNLOCK_ESTIMATES = 6;     // 约 3 秒
+  static const uint8_t MIN_LOCK_ONSETS = 4;      // 锁定速度所需的包络时段内起音数
+  static constexpr float PHASE_GAIN = 0.25f;
+
+  float thresholdK_ = 1.5f;
+  uint16_t prevLog_[MAX_BINS];
+  uint16_t prevBins_;
+  float t_;
+
+  float fluxMean_, fluxDev_;
+  uint16_t statsFrames_;
+  float flux1_, flux2_, thresh1_;
+  float lastOnset_;
+  bool onset_;
+  uint32_t onsets_;
+  float recentOnsets_[MIN_LOCK_ONSETS]; // 最近几次起音时刻（环形）
+  uint8_t recentPos_;
+
+  float env_[ENV_LEN];
+  float envAcc_, envTime_;
+  uint16_t envPos_, envFill_;
+  float sinceTempo_;
+
+  float bpm_, candidateBpm_, tempoConf_;
+  uint8_t lowConf_;
+  float lastBeat_, nextBeat_;
+  uint32_t beats_;
+};
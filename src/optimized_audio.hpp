@@ -1,72 +1,338 @@
 #pragma once
 #include <Arduino.h>
+
+// FFT后端选择：1 = Q15定点FFT（默认，适合无FPU的ESP32-C3），0 = ArduinoFFT(double)
+// 可在 platformio.ini 中通过 build_flags = -DAUDIO_FIXED_POINT_FFT=0 切回
+#ifndef AUDIO_FIXED_POINT_FFT
+#define AUDIO_FIXED_POINT_FFT 1
+#endif
+
+// 分阶段耗时统计：1 = 记录每个分析阶段的调用次数与耗时（主机端基准程序默认开启）
+#ifndef AUDIO_STAGE_PROFILE
+#define AUDIO_STAGE_PROFILE 0
+#endif
+
+#if AUDIO_FIXED_POINT_FFT
+#include "fixed_fft.hpp"
+#else
 #include <arduinoFFT.h>
+#endif
+
+#include "sample_source.hpp"
+#include "pitch_estimator.hpp"
+#include "goertzel.hpp"
+#include "onset_detector.hpp"
+#include "chroma.hpp"
+#include "audio_features.hpp"
+#include "audio_agc.hpp"
 
 /**
  * 优化的音频分析器类
  * 专为MAX9814麦克风模块设计
- * 使用ArduinoFFT进行频谱分析
- * 使用自相关算法进行音高检测
+ * 使用定点FFT（或ArduinoFFT）进行频谱分析
+ * 音高检测使用可替换的估计器（YIN 或 FFT自相关），直接处理时域样本
+ * 前端跟踪直流偏置；电平与频段经底噪扣除和自动增益（audio_agc.hpp）归一化，全程定点
+ * 频率换算（频段边界、音高、色度、目标音）使用采样源实测的有效采样率，而不是标称的 8kHz
+ *
+ * 线程模型：tick() 与下方“分析侧”的 getter 属于分析任务（见 audio_task.hpp）；
+ * 其它任务通过 readFeatures() 读取 seqlock 快照，通过 set* 控制接口修改参数，
+ * 控制参数同样经 seqlock 传给分析任务，在下一次 tick() 开始时生效。
+ * 单线程使用（如矩阵屏）时两侧在同一任务中，行为不变。
  */
 class OptimizedAudioAnalyzer {
 public:
-  explicit OptimizedAudioAnalyzer(uint8_t adcPin) : pin_(adcPin) {
-    // 初始化FFT
-    fft = new arduinoFFT(vReal, vImag, SAMPLES, SAMPLING_FREQ);
+  explicit OptimizedAudioAnalyzer(uint8_t adcPin)
+  : pin_(adcPin),
+#if defined(ARDUINO_ARCH_ESP32)
+    adcSource_(adcPin, SAMPLING_FREQ), fallbackSource_(adcPin, SAMPLING_FREQ),
+    source_(&adcSource_),
+#else
+    source_(&hostSource_), // 主机端没有ADC，默认用合成信号，通常再用 setSource() 换成回放源
+#endif
+#if AUDIO_FIXED_POINT_FFT
+    acfPitch_(fft),
+#else
+    acfPitch_(acfFft_),
+#endif
+    pitch_(&yinPitch_) {
+    chromaFft_.begin(CHROMA_WINDOW);
+    setWindow(DEFAULT_WINDOW, DEFAULT_HOP);
   }
 
   ~OptimizedAudioAnalyzer() {
+#if !AUDIO_FIXED_POINT_FFT
     delete fft;
+#endif
   }
 
+  // 替换采样源（需在分析任务启动之前调用），例如合成信号源、回放源或包装实时源的 CaptureSource
+  void setSource(SampleSource* source) { source_ = source; }
+  SampleSource* source() { return source_; }
+
   void begin() {
-    analogReadResolution(12); // ESP32-C3 ADC up to 12-bit
-    analogSetPinAttenuation(pin_, ADC_11db); // 扩展输入范围至3.3V
-    lastTick_ = micros();
+    // 默认使用ADC连续(DMA)模式，失败时退回定时器逐点采样
+    if (!source_->begin()) {
+#if defined(ARDUINO_ARCH_ESP32)
+      if (source_ == &adcSource_) {
+        Serial.println("ADC连续模式不可用，退回定时器采样");
+        source_ = &fallbackSource_;
+        source_->begin();
+      }
+#endif
+    }
+    dc_.reset();
+    resetHistory();
   }
 
-  // 频繁调用以更新音频分析
-  void tick() {
-    unsigned long now = micros();
-    if (now - lastTick_ < 2500) return; // ~400 Hz更新率
-    lastTick_ = now;
+  /**
+   * 配置滑动窗口分析
+   * @param window 分析窗口长度（128/256/512）
+   * @param hop    每收到多少个新样本做一次分析（1..window，2的幂）
+   * 窗口与跳步相等时退化为不重叠的逐块分析
+   */
+  bool setWindow(uint16_t window, uint16_t hop) {
+    if (window < 128 || window > MAX_WINDOW || (window & (window - 1)) != 0) return false;
+    if (hop == 0 || hop > window || (hop & (hop - 1)) != 0) return false;
+    window_ = window;
+    hop_ = hop;
+    bins_ = window_ / 2;
+    windowLog2_ = 0;
+    while ((1u << windowLog2_) < window_) windowLog2_++;
+#if AUDIO_FIXED_POINT_FFT
+    fft.begin(window_);
+#else
+    delete fft;
+    fft = new arduinoFFT(vReal, vImag, window_, fs_);
+#endif
+    configureBandEdges();
+    buildBandMap();
+    resetBandState();
 
-    // 采样音频数据
-    for (int i = 0; i < SAMPLES; i++) {
-      vReal[i] = analogRead(pin_) - 2048; // 转换为有符号值
-      vImag[i] = 0;
+    // 平滑系数以 128 点不重叠分析为基准，按跳步换算，保证时间常数不随更新频率变化
+    float ratio = (float)hop_ / 128.0f;
+    levelAlpha_ = (uint32_t)((1.0f - powf(0.8f, ratio)) * 65536.0f + 0.5f);
+    bandAlpha_ = (uint32_t)((1.0f - powf(0.85f, ratio)) * 65536.0f + 0.5f);
+    pitchKeep_ = powf(0.7f, ratio);
+    pitchDecay_ = powf(0.95f, ratio);
+
+    configureChroma();
+    chroma_.reset();
+
+    // 频段量纲随窗口变化，底噪重新跟踪
+    agc_.configure(updateRate());
+    agc_.resetFloors();
+
+    resetHistory();
+    return true;
+  }
+
+  /**
+   * 选择音高估计算法
+   * PITCH_YIN：YIN/CMNDF，低频准确、音分误差小（默认）
+   * PITCH_ACF：FFT自相关（Wiener–Khinchin），开销固定
+   */
+  enum PitchMethod { PITCH_YIN = 0, PITCH_ACF = 1 };
+  void setPitchMethod(PitchMethod m) { pitch_ = (m == PITCH_ACF) ? (PitchEstimator*)&acfPitch_ : (PitchEstimator*)&yinPitch_; }
+
+  // 也可以挂接外部实现的估计器
+  void setPitchEstimator(PitchEstimator* e) { if (e) pitch_ = e; }
+  PitchEstimator* pitchEstimator() { return pitch_; }
+
+  /**
+   * 目标音匹配（音高武装模式）
+   * 启用后每个样本都送入 Goertzel 滤波器组；目标或容差变化时重新调谐
+   */
+  void setPitchMatch(bool enable, float targetHz, float tolCents) {
+    if (ctl_.pitchMatch == enable && ctl_.targetHz == targetHz && ctl_.tolCents == tolCents) return;
+    ctl_.pitchMatch = enable;
+    ctl_.targetHz = targetHz;
+    ctl_.tolCents = tolCents;
+    control_.publish(ctl_);
+  }
+
+  // 命中事件经特征快照发布：AudioFeatures::pitchHits 计数增加即为命中
+  const GoertzelBank& pitchMatcher() const { return match_; }
+
+  /**
+   * 特征需求：每个消费者在自己的槽位中声明需要的 AudioFeatures::FEAT_* 位，
+   * 分析器按所有槽位的并集决定跑哪些阶段——只要音量时不做 FFT，没人读音高时不做音高估计；
+   * 并集为空（如只武装了目标音匹配）时跳过整个窗口分析
+   */
+  enum Consumer : uint8_t { CONSUMER_EFFECT, CONSUMER_PITCH_MAP, CONSUMER_DISPLAY, CONSUMER_COUNT };
+
+  void setDemand(Consumer who, uint8_t mask) {
+    if (who >= CONSUMER_COUNT || demandBy_[who] == mask) return;
+    demandBy_[who] = mask;
+    uint8_t all = 0;
+    for (uint8_t i = 0; i < CONSUMER_COUNT; i++) all |= demandBy_[i];
+    if (ctl_.demand == all) return;
+    ctl_.demand = all;
+    control_.publish(ctl_);
+  }
+  uint8_t demand() const { return ctl_.demand; }
+
+  /**
+   * N 段频谱（8/16/32 段，对数或 Mel 间隔）
+   * 每个 FFT bin 对各频段的权重在配置变化时预先计算一次，每帧只做整数乘加；
+   * 结果平滑后以 0..255 的字节数组发布，矩阵列和灯带频谱效果直接使用
+   */
+  enum BandScale { BAND_LOG = 0, BAND_MEL = 1 };
+
+  bool setBands(uint8_t count, BandScale scale = BAND_LOG) {
+    if (count != 8 && count != 16 && count != 32) return false;
+    if (ctl_.bandCount == count && ctl_.bandScale == (uint8_t)scale) return true;
+    ctl_.bandCount = count;
+    ctl_.bandScale = (uint8_t)scale;
+    control_.publish(ctl_);
+    return true;
+  }
+
+  // 只改段数、保持当前刻度；段数相同时不做任何事，可在每帧调用
+  bool requestBands(uint8_t count) { return setBands(count, (BandScale)ctl_.bandScale); }
+
+  // 分析侧
+  const uint8_t* bands() const { return bandBytes_; }
+  uint8_t bandCount() const { return bandCount_; }
+  BandScale bandScale() const { return bandScale_; }
+
+  /**
+   * 节拍：谱通量起音检测 + 自相关速度估计（见 onset_detector.hpp）
+   * beat()      自上次调用以来是否到达节拍点（单一消费者；多个效果请各自比较 beatCount()）
+   * beatPhase() 当前节拍内的相位 0..1，速度锁定后可据此提前安排脉冲
+   * bpm()       速度，未锁定时为 0
+   */
+  bool beat() {
+    uint32_t c = onset_.beatCount();
+    bool b = (c != beatSeen_);
+    beatSeen_ = c;
+    return b;
+  }
+  uint32_t beatCount() const { return onset_.beatCount(); }
+  float beatPhase() const { return onset_.beatPhase(); }
+  float bpm() const { return onset_.bpm(); }
+  bool onset() const { return onset_.onset(); }
+  void setOnsetThreshold(float k) {
+    if (ctl_.onsetK == k) return;
+    ctl_.onsetK = k;
+    control_.publish(ctl_);
+  }
+  const OnsetDetector& onsetDetector() const { return onset_; }
+
+  /**
+   * 色度、主音与调性（见 chroma.hpp），由 FFT 幅度谱查表得到
+   * 频率分辨率取决于 FFT 长度：128 点只能用 510Hz 以上的泛音，220Hz、440Hz 的纯音都会判错，
+   * 所以分析窗口短于 CHROMA_WINDOW（512）时色度单独对最近 512 个样本做 FFT（140Hz 以上可用），
+   * 按 CHROMA_INTERVAL 个新样本节流；窗口已是 512 点时直接使用每帧的幅度谱
+   */
+  const ChromaAnalyzer& chromaAnalyzer() const { return chroma_; }
+
+  uint16_t window() const { return window_; }
+  uint16_t hop() const { return hop_; }
+
+  // 特征更新频率（Hz）
+  float updateRate() const { return fs_ / (float)hop_; }
+
+  // 频率换算所用的采样率（Hz）：开始为标称值，之后跟随采样源的实测值（分析侧）
+  float sampleRate() const { return fs_; }
+
+  /**
+   * 频繁调用以更新音频分析：非阻塞地取走已采集的样本，每凑够一个跳步做一次分析
+   * 每次最多分析一帧，返回 true 表示分析了一帧（缓冲区中可能还有待处理的样本）
+   * 有新样本时发布一次特征快照
+   */
+  bool tick() {
+    applyControl();
+    trackSampleRate();
+    int16_t chunk[64];
+    size_t processed = 0;
+    bool analyzed = false;
+    for (;;) {
+      size_t want = hop_ - newSinceHop_;
+      if (want > sizeof(chunk) / sizeof(chunk[0])) want = sizeof(chunk) / sizeof(chunk[0]);
+      size_t n = source_->read(chunk, want);
+      if (n == 0) break;
+
+      uint32_t t = profileMark();
+      for (size_t i = 0; i < n; i++) pushSample(dc_.process(chunk[i])); // 减去跟踪到的直流偏置
+      profileAdd(PROFILE_INGEST, t);
+      newSinceHop_ += n;
+      processed += n;
+      if (newSinceHop_ < hop_) continue;
+      newSinceHop_ = 0;
+      if (demand_ == 0) {
+        // 无人需要窗口特征（如仅目标音匹配）：尽量取空缓冲区，但限制单次处理量（阻塞式采样源总能读到数据）
+        if (processed >= MAX_WINDOW) break;
+        continue;
+      }
+      if (histFill_ < window_ || histFill_ < PITCH_WINDOW) continue; // 窗口尚未填满
+
+      analyzeWindow();
+      analyzed = true;
+      break; // 每次 tick 最多分析一次，剩余样本留在缓冲区中下次处理
     }
-    
-    // 计算RMS音量
-    float sum = 0;
-    for (int i = 0; i < SAMPLES; i++) {
-      sum += vReal[i] * vReal[i];
+
+    if (processed > 0) {
+      // 一次 tick 可能跨过多个 Goertzel 块：每个命中都计数，置信度取这一批中最高的
+      GoertzelBank::Hit hit;
+      float conf = -1.0f;
+      while (match_.takeHit(hit)) {
+        pitchHits_++;
+        if (hit.confidence > conf) conf = hit.confidence;
+      }
+      if (conf >= 0.0f) pitchHitConf_ = conf;
+      publishFeatures();
     }
-    float rms = sqrt(sum / SAMPLES) / 2048.0;
-    
-    // 平滑RMS值
-    levelSmoothed_ = levelSmoothed_ * 0.8f + rms * 0.2f;
-    
-    // 执行FFT
-    fft->Windowing(FFT_WIN_TYP_HAMMING, FFT_FORWARD);
-    fft->Compute(FFT_FORWARD);
-    fft->ComplexToMagnitude();
-    
-    // 计算频段能量
-    calculateBands();
-    
-    // 检测音高
-    detectPitch();
+    return analyzed;
   }
 
-  // 获取音频特征
-  float level() const { return levelSmoothed_; }
-  float low() const { return low_; }
-  float mid() const { return mid_; }
-  float high() const { return high_; }
+  /**
+   * 暂停分析时由分析任务按周期调用：取走并丢弃采样源中积压的样本（每次最多 MAX_WINDOW 个），
+   * 环形缓冲区不会因无人消费而溢出、计入 dropped()；同时清空历史窗口，
+   * 恢复分析后的第一帧只包含恢复之后的音频
+   */
+  void discardInput() {
+    int16_t chunk[64];
+    size_t total = 0;
+    while (total < MAX_WINDOW) {
+      size_t n = source_->read(chunk, sizeof(chunk) / sizeof(chunk[0]));
+      if (n == 0) break;
+      total += n;
+    }
+    if (histFill_ > 0 || newSinceHop_ > 0) resetHistory();
+  }
+
+  // 其它任务读取最新的特征快照（无锁、不阻塞分析任务），尚无快照时返回 false
+  bool readFeatures(AudioFeatures& out) const { return features_.read(out); }
+  uint32_t featureSequence() const { return features_.sequence(); }
+
+  /**
+   * 分阶段耗时（需 AUDIO_STAGE_PROFILE=1，否则全为 0）
+   * 槽位 0..STAGE_COUNT-1 对应 AudioFeatures::Stage，PROFILE_INGEST 为样本入队与 Goertzel 更新
+   * 时间单位为 micros()，单次可能只有 0/1µs，但大量调用的累计值是无偏的
+   */
+  static const uint8_t PROFILE_INGEST = AudioFeatures::STAGE_COUNT;
+  static const uint8_t PROFILE_SLOTS = AudioFeatures::STAGE_COUNT + 1;
+  struct StageProfile {
+    uint32_t runs = 0;
+    uint64_t totalUs = 0;
+    uint32_t maxUs = 0;
+  };
+  const StageProfile& stageProfile(uint8_t slot) const { return profile_[slot < PROFILE_SLOTS ? slot : PROFILE_INGEST]; }
+  static const char* profileName(uint8_t slot) { return slot == PROFILE_INGEST ? "ingest" : AudioFeatures::stageName(slot); }
+  void resetProfile() { for (uint8_t i = 0; i < PROFILE_SLOTS; i++) profile_[i] = StageProfile(); }
+
+  // 以下为分析侧 getter（与 tick() 同一任务中使用），电平与频段为自动增益之后的 0..1
+  float level() const { return (float)level_ / 65536.0f; }
+  float low() const { return (float)low_ / 65536.0f; }
+  float mid() const { return (float)mid_ / 65536.0f; }
+  float high() const { return (float)high_ / 65536.0f; }
   float pitchHz() const { return pitchHz_; }
   float pitchConf() const { return pitchConf_; }
 
+  // 已分析的帧数与采样源丢弃的样本数（分析跟不上采集速度时增长）
+  uint32_t frames() const { return frames_; }
+  uint32_t droppedSamples() const { return source_->dropped(); }
+
   // 便捷函数
   uint8_t levelByte() const { 
     float x = level(); 
@@ -96,154 +362,545 @@ public:
     return (uint8_t)(x * 255.0f + 0.5f); 
   }
   
-  // 音高到长度映射
-  uint16_t mapPitchToLen(float minHz, float maxHz, float scale, uint16_t maxLen) const {
-    if (pitchHz_ <= 0 || maxHz <= minHz) return 0;
-    float num = logf(pitchHz_ / minHz) / logf(2.0f);
-    float den = logf(maxHz / minHz) / logf(2.0f);
-    float norm = (den > 0) ? (num / den) : 0.0f;
-    if (norm < 0) norm = 0; 
-    if (norm > 1) norm = 1;
-    float s = scale; 
-    if (s < 0.1f) s = 0.1f; 
-    if (s > 2.0f) s = 2.0f;
-    float v = norm * s; 
-    if (v > 1.0f) v = 1.0f;
-    return (uint16_t)(v * (float)maxLen + 0.5f);
-  }
-
-  // 设置敏感度
+  // 设置敏感度：自动增益之后的微调倍数（关闭自动增益时即为固定增益）
   void setSensitivity(float value) {
-    sensitivity_ = value;
-    if (sensitivity_ < 0.1f) sensitivity_ = 0.1f;
-    if (sensitivity_ > 5.0f) sensitivity_ = 5.0f;
+    if (value < 0.1f) value = 0.1f;
+    if (value > 5.0f) value = 5.0f;
+    if (ctl_.sensitivity == value) return;
+    ctl_.sensitivity = value;
+    control_.publish(ctl_);
   }
 
+  /**
+   * 自动增益与底噪扣除（默认开启）
+   * 关闭后电平与频段只按固定量纲归一化再乘灵敏度；底噪与增益仍在跟踪，重新开启时无需重新收敛
+   */
+  void setAgc(bool enable) {
+    if (ctl_.agc == enable) return;
+    ctl_.agc = enable;
+    control_.publish(ctl_);
+  }
+  bool agcEnabled() const { return ctl_.agc; }
+
 private:
-  // 计算频段能量
-  void calculateBands() {
-    // 低频段 (0-150Hz)
-    float lowSum = 0;
-    int lowCount = 0;
-    for (int i = 2; i < 8; i++) { // 跳过DC和非常低的频率
-      lowSum += vReal[i];
-      lowCount++;
+  // 跨任务控制参数：控制侧修改 ctl_ 并发布，分析任务在 tick() 开始时比对并应用
+  struct Control {
+    uint8_t demand = 0;
+    bool pitchMatch = false;
+    float targetHz = 440.0f;
+    float tolCents = 50.0f;
+    uint8_t bandCount = 16;
+    uint8_t bandScale = BAND_LOG;
+    float onsetK = 1.5f;
+    float sensitivity = 1.0f;
+    bool agc = true;
+  };
+
+  void applyControl() {
+    uint32_t seq = control_.sequence();
+    if (seq == controlSeq_) return;
+    controlSeq_ = seq;
+    Control c;
+    if (!control_.read(c)) return;
+
+    setActiveDemand(c.demand);
+    agc_.setTrim(c.sensitivity);
+    agc_.setEnabled(c.agc);
+    onset_.setThresholdK(c.onsetK);
+    if (!c.pitchMatch) {
+      match_.disable();
+    } else if (!match_.active() || match_.targetHz() != c.targetHz || match_.tolCents() != c.tolCents) {
+      match_.tune(c.targetHz, c.tolCents, fs_);
     }
-    
-    // 中频段 (150-1kHz)
-    float midSum = 0;
-    int midCount = 0;
-    for (int i = 8; i < 25; i++) {
-      midSum += vReal[i];
-      midCount++;
+    if (c.bandCount != bandCount_ || c.bandScale != (uint8_t)bandScale_) {
+      bandCount_ = c.bandCount;
+      bandScale_ = (BandScale)c.bandScale;
+      buildBandMap();
+      resetBandState();
     }
-    
-    // 高频段 (1kHz+)
-    float highSum = 0;
-    int highCount = 0;
-    for (int i = 25; i < SAMPLES/2; i++) {
-      highSum += vReal[i];
-      highCount++;
+  }
+
+  /**
+   * 跟随采样源实测的采样率：偏差超过 0.2%（约 3.5 音分）时重新换算所有与频率相关的表
+   * 只是系数微调，不清空平滑状态与底噪；偏离标称值 5% 以上的测量值视为异常（如长时间停顿），不采用
+   */
+  void trackSampleRate() {
+    float r = source_->measuredRate();
+    float nominal = (float)source_->sampleRate();
+    if (r < nominal * 0.95f || r > nominal * 1.05f) return;
+    if (fabsf(r - fs_) * 500.0f <= fs_) return;
+    fs_ = r;
+    configureBandEdges();
+    buildBandMap();
+    configureChroma();
+    agc_.configure(updateRate());
+    if (match_.active()) match_.tune(match_.targetHz(), match_.tolCents(), fs_);
+  }
+
+  // 切换需求时清零不再计算的输出，快照中不会留下过期的值
+  void setActiveDemand(uint8_t mask) {
+    uint8_t dropped = demand_ & ~mask;
+    demand_ = mask;
+    if (dropped & AudioFeatures::FEAT_BANDS) lowRaw_ = midRaw_ = highRaw_ = low_ = mid_ = high_ = 0;
+    if (dropped & AudioFeatures::FEAT_SPECTRUM) {
+      for (uint8_t b = 0; b < MAX_BANDS; b++) { bandRaw_[b] = 0; bandBytes_[b] = 0; }
     }
-    
-    // 归一化并平滑
-    float newLow = lowCount > 0 ? lowSum / (lowCount * 2048.0f) : 0;
-    float newMid = midCount > 0 ? midSum / (midCount * 2048.0f) : 0;
-    float newHigh = highCount > 0 ? highSum / (highCount * 2048.0f) : 0;
-    
-    // 应用敏感度
-    newLow *= sensitivity_;
-    newMid *= sensitivity_;
-    newHigh *= sensitivity_;
-    
-    // 限制范围
-    if (newLow > 1.0f) newLow = 1.0f;
-    if (newMid > 1.0f) newMid = 1.0f;
-    if (newHigh > 1.0f) newHigh = 1.0f;
-    
-    // 平滑过渡
-    low_ = low_ * 0.85f + newLow * 0.15f;
-    mid_ = mid_ * 0.85f + newMid * 0.15f;
-    high_ = high_ * 0.85f + newHigh * 0.15f;
+    if (dropped & AudioFeatures::FEAT_PITCH) { pitchHz_ = 0.0f; pitchConf_ = 0.0f; }
+    if (dropped & AudioFeatures::FEAT_CHROMA) chroma_.reset();
   }
-  
-  // 使用自相关算法检测音高
-  void detectPitch() {
-    // 准备数据 - 只使用一部分样本以提高效率
-    const int useSamples = SAMPLES / 2;
-    
-    // 寻找最佳周期
-    float maxCorrelation = 0;
-    int bestPeriod = 0;
-    
-    // 搜索合理范围的周期 (对应约80Hz-1000Hz)
-    const int minPeriod = SAMPLING_FREQ / 1000; // ~1000Hz
-    const int maxPeriod = SAMPLING_FREQ / 80;   // ~80Hz
+
+  uint32_t profileMark() const {
+#if AUDIO_STAGE_PROFILE
+    return micros();
+#else
+    return 0;
+#endif
+  }
+
+  // 把从 mark 到现在的耗时记到 slot，并把 mark 移到现在
+  void profileAdd(uint8_t slot, uint32_t& mark) {
+#if AUDIO_STAGE_PROFILE
+    uint32_t now = micros();
+    uint32_t dt = now - mark;
+    StageProfile& p = profile_[slot];
+    p.runs++;
+    p.totalUs += dt;
+    if (dt > p.maxUs) p.maxUs = dt;
+    mark = now;
+#else
+    (void)slot;
+    (void)mark;
+#endif
+  }
+
+  void publishFeatures() {
+    AudioFeatures f;
+    f.level = level();
+    f.low = low();
+    f.mid = mid();
+    f.high = high();
+    f.pitchHz = pitchHz_;
+    f.pitchConf = pitchConf_;
+    f.bandCount = bandCount_;
+    memcpy(f.bands, bandBytes_, bandCount_);
+    f.beatCount = onset_.beatCount();
+    if (demand_ & AudioFeatures::FEAT_ONSET) {
+      f.beatPhase = onset_.beatPhase();
+      f.bpm = onset_.bpm();
+    }
+    if (demand_ & AudioFeatures::FEAT_CHROMA) {
+      memcpy(f.chroma, chroma_.chroma(), sizeof(f.chroma));
+      f.note = chroma_.note();
+      f.noteConf = chroma_.noteConfidence();
+      f.key = chroma_.key();
+      f.keyConf = chroma_.keyConfidence();
+    }
+    f.pitchHits = pitchHits_;
+    f.pitchHitConf = pitchHitConf_;
+    f.agc = agc_.enabled();
+    f.agcGain = (float)agc_.gainQ16() / 65536.0f;
+    f.noiseFloor = (float)agc_.floorOf(AutoGain::CH_LEVEL) / 65536.0f;
+    f.dcOffset = dc_.offset();
+    f.sampleRate = fs_;
+    for (uint8_t b = 0; b < bandCount_; b++) f.bandFloor[b] = toByte(agc_.floorOf(AutoGain::CH_BAND0 + b));
+    f.demand = demand_;
+    f.frames = frames_;
+    memcpy(f.skipped, skipped_, sizeof(skipped_));
+    f.timestampUs = micros();
+    features_.publish(f);
+  }
+
+  void resetHistory() {
+    memset(hist_, 0, sizeof(hist_));
+    histPos_ = 0;
+    histFill_ = 0;
+    newSinceHop_ = 0;
+    sinceLastPitch_ = 0;
+    sinceLastChroma_ = 0;
+    sumSq_ = 0;
+  }
+
+  // 写入一个样本，同时增量更新窗口内的平方和（加入新样本、移除滑出窗口的样本）
+  // 历史长度固定为 MAX_WINDOW，音高估计可以使用比FFT窗口更长的样本
+  void pushSample(int16_t s) {
+    int16_t old = hist_[(histPos_ - window_) & (MAX_WINDOW - 1)];
+    sumSq_ += (uint32_t)((int32_t)s * s);
+    sumSq_ -= (uint32_t)((int32_t)old * old);
+    hist_[histPos_] = s;
+    histPos_ = (histPos_ + 1) & (MAX_WINDOW - 1);
+    match_.push(s);
+    if (histFill_ < MAX_WINDOW) histFill_++;
+    sinceLastPitch_++;
+    sinceLastChroma_++;
+  }
+
+  // 把环形历史中最近的 n 个样本按时间顺序展开到 dst
+  void copyLatest(int16_t* dst, uint16_t n) const {
+    uint16_t start = (histPos_ - n) & (MAX_WINDOW - 1);
+    uint16_t first = MAX_WINDOW - start;
+    if (first >= n) {
+      memcpy(dst, hist_ + start, n * sizeof(int16_t));
+    } else {
+      memcpy(dst, hist_ + start, first * sizeof(int16_t));
+      memcpy(dst + first, hist_, (n - first) * sizeof(int16_t));
+    }
+  }
+
+  void analyzeWindow() {
+    frames_++;
+
+    // 窗口内RMS由增量平方和直接得到，无需再遍历样本；满量程 2048 对应 Q16 的 1.0
+    uint32_t rms = FixedRealFFT<MAX_WINDOW>::isqrt64(((uint64_t)sumSq_ << 10) >> windowLog2_);
+
+    // 平滑后经底噪扣除与自动增益（同时更新全局增益）
+    levelRaw_ = smooth(levelRaw_, rms, levelAlpha_);
+    level_ = agc_.level(levelRaw_);
+
+    // 以下各阶段只在有消费者需要时运行，跳过的阶段计数
+    // 色度有自己的 FFT 时，窗口 FFT 只为频段、频谱与起音计算
+    uint8_t fftUsers = AudioFeatures::FEAT_BANDS | AudioFeatures::FEAT_SPECTRUM | AudioFeatures::FEAT_ONSET;
+    if (!chromaOwnFft()) fftUsers |= AudioFeatures::FEAT_CHROMA;
+    uint32_t t = profileMark();
+    if (demand_ & fftUsers) {
+      // 把环形历史按时间顺序展开成连续帧
+      copyLatest(frame_, window_);
+
+      // 执行FFT，得到 window/2 个幅度值
+      computeSpectrum();
+      profileAdd(AudioFeatures::STAGE_FFT, t);
+    } else {
+      skipped_[AudioFeatures::STAGE_FFT]++;
+    }
+
+    // 计算频段能量
+    if (demand_ & AudioFeatures::FEAT_BANDS) {
+      calculateBands();
+      profileAdd(AudioFeatures::STAGE_BANDS, t);
+    } else {
+      skipped_[AudioFeatures::STAGE_BANDS]++;
+    }
+    if (demand_ & AudioFeatures::FEAT_SPECTRUM) {
+      calculateSpectrumBands();
+      profileAdd(AudioFeatures::STAGE_SPECTRUM, t);
+    } else {
+      skipped_[AudioFeatures::STAGE_SPECTRUM]++;
+    }
+
+    // 起音与节拍（帧间隔为一个跳步）
+    // 底噪取满量程幅度的 1/8（约 -18dB），与窗口长度同比例
+    // 谱通量取对数，本身与增益无关，因此直接使用增益之前的幅度谱
+    if (demand_ & AudioFeatures::FEAT_ONSET) {
+      onset_.process(spectrum_, bins_, (float)hop_ / fs_, (uint32_t)(bandNorm_ / 8.0f));
+      profileAdd(AudioFeatures::STAGE_ONSET, t);
+    } else {
+      skipped_[AudioFeatures::STAGE_ONSET]++;
+    }
+
+    // 色度：自动增益之后的电平高于约 2% 才算有声，否则只衰减
+    if (demand_ & AudioFeatures::FEAT_CHROMA) {
+      if (!chromaOwnFft()) {
+        chroma_.process(spectrum_, level_ > CHROMA_ACTIVE_LEVEL);
+        profileAdd(AudioFeatures::STAGE_CHROMA, t);
+      } else if (sinceLastChroma_ >= CHROMA_INTERVAL && histFill_ >= CHROMA_WINDOW) {
+        // 前面各阶段已用完本帧的 frame_ 与 spectrum_，借来放 512 点的帧与幅度谱
+        sinceLastChroma_ = 0;
+        t = profileMark();
+        copyLatest(frame_, CHROMA_WINDOW);
+        chromaFft_.magnitude(frame_, spectrum_);
+        chroma_.process(spectrum_, level_ > CHROMA_ACTIVE_LEVEL);
+        profileAdd(AudioFeatures::STAGE_CHROMA, t);
+      }
+    } else {
+      skipped_[AudioFeatures::STAGE_CHROMA]++;
+    }
     
-    for (int period = minPeriod; period <= maxPeriod; period++) {
-      float correlation = 0;
-      int validSamples = 0;
-      
-      for (int i = 0; i < useSamples - period; i++) {
-        correlation += vReal[i] * vReal[i + period];
-        validSamples++;
+    // 检测音高：音高变化远慢于跳步，按 PITCH_INTERVAL 个新样本节流
+    if (sinceLastPitch_ >= PITCH_INTERVAL) {
+      sinceLastPitch_ = 0;
+      if (demand_ & AudioFeatures::FEAT_PITCH) {
+        t = profileMark();
+        detectPitch();
+        profileAdd(AudioFeatures::STAGE_PITCH, t);
+      } else {
+        skipped_[AudioFeatures::STAGE_PITCH]++;
+      }
+    }
+  }
+
+  // 加窗 + FFT + 求幅度，结果写入 spectrum_
+  void computeSpectrum() {
+#if AUDIO_FIXED_POINT_FFT
+    fft.magnitude(frame_, spectrum_);
+#else
+    for (int i = 0; i < window_; i++) {
+      vReal[i] = frame_[i];
+      vImag[i] = 0;
+    }
+    fft->Windowing(FFT_WIN_TYP_HANN, FFT_FORWARD);
+    fft->Compute(FFT_FORWARD);
+    fft->ComplexToMagnitude();
+    for (int i = 0; i < bins_; i++) {
+      spectrum_[i] = (uint32_t)(vReal[i] + 0.5);
+    }
+#endif
+  }
+
+  float binHz() const { return fs_ / (float)window_; }
+
+  // 窗口短于 CHROMA_WINDOW 时色度用单独的 512 点 FFT
+  bool chromaOwnFft() const { return window_ < CHROMA_WINDOW; }
+
+  void configureChroma() {
+    if (!chromaOwnFft()) {
+      chroma_.configure(bins_, binHz(), updateRate());
+      return;
+    }
+    // 每帧最多算一次色度：跳步长于 CHROMA_INTERVAL 时按跳步的频率更新
+    uint16_t every = hop_;
+    if (every < CHROMA_INTERVAL) every = CHROMA_INTERVAL;
+    chroma_.configure(CHROMA_WINDOW / 2, fs_ / (float)CHROMA_WINDOW, fs_ / (float)every);
+  }
+
+  // 频段边界按频率定义（与原 128 点时的 bin 2/8/25 对应），随窗口长度与采样率换算
+  void configureBandEdges() {
+    const float hz = binHz();
+    lowStart_ = (uint16_t)(125.0f / hz + 0.5f);
+    midStart_ = (uint16_t)(500.0f / hz + 0.5f);
+    highStart_ = (uint16_t)(1562.5f / hz + 0.5f);
+    // 幅度随窗口长度线性增长，归一化到 128 点的量纲
+    bandNorm_ = 2048.0f * (float)window_ / 128.0f;
+    lowRecip_ = recipQ24(midStart_ - lowStart_);
+    midRecip_ = recipQ24(highStart_ - midStart_);
+    highRecip_ = recipQ24(bins_ - highStart_);
+  }
+
+  /**
+   * 频段平均幅度 → Q16：以 8 倍 bandNorm_ 为 1.0，宽带信号时与总电平大致同一量级
+   * （原先以 bandNorm_ 为 1.0，音乐输入下频段值比电平高一个数量级，只能靠调低灵敏度压住）
+   * sumQ24 为幅度和乘以 recipQ24(个数或权重和)，即平均幅度的 Q24 值
+   */
+  uint32_t bandQ16(uint64_t sumQ24) const {
+    uint64_t v = sumQ24 >> (15 + windowLog2_);
+    return v > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)v;
+  }
+
+  static uint32_t recipQ24(uint32_t n) { return n ? (1u << 24) / n : 0; }
+
+  // Q16 一阶平滑
+  static uint32_t smooth(uint32_t y, uint32_t x, uint32_t alpha) {
+    int64_t d = (int64_t)x - (int64_t)y;
+    return (uint32_t)((int64_t)y + ((d * (int64_t)alpha) >> 16));
+  }
+
+  static uint8_t toByte(uint32_t q16) { return q16 >= 65535 ? 255 : (uint8_t)((q16 + 128) >> 8); }
+
+  // 生成 bin→频段 权重表：频段边界按对数或 Mel 等分，每个 bin 按与频段的重叠宽度取权（Q8）
+  // 频段窄于一个 bin 时只得到该 bin 的一部分权重，归一化后即等于该 bin 的幅度
+  // 采样率微调时只重建权重表，段数、刻度或窗口变化时再由 resetBandState() 清空状态
+  void buildBandMap() {
+    const float binHz = this->binHz();
+    float fMin = binHz > 60.0f ? binHz : 60.0f; // 最低频段从 60Hz（或第一个非直流 bin）开始
+    float fMax = fs_ * 0.5f;
+    float edges[MAX_BANDS + 1];
+    for (uint8_t b = 0; b <= bandCount_; b++) {
+      float t = (float)b / (float)bandCount_;
+      if (bandScale_ == BAND_MEL) {
+        float mLo = 2595.0f * log10f(1.0f + fMin / 700.0f);
+        float mHi = 2595.0f * log10f(1.0f + fMax / 700.0f);
+        edges[b] = 700.0f * (powf(10.0f, (mLo + (mHi - mLo) * t) / 2595.0f) - 1.0f);
+      } else {
+        edges[b] = fMin * powf(fMax / fMin, t);
       }
-      
-      if (validSamples > 0) {
-        correlation /= validSamples;
-        
-        if (correlation > maxCorrelation) {
-          maxCorrelation = correlation;
-          bestPeriod = period;
-        }
+    }
+
+    uint16_t taps = 0;
+    for (uint8_t b = 0; b < bandCount_; b++) {
+      float lo = edges[b] / binHz, hi = edges[b + 1] / binHz; // 以 bin 为单位，bin k 覆盖 [k-0.5, k+0.5)
+      int k0 = (int)(lo + 0.5f), k1 = (int)(hi + 0.5f);
+      if (k0 < 1) k0 = 1;
+      if (k1 > bins_ - 1) k1 = bins_ - 1;
+      if (k1 < k0) k1 = k0;
+      bandFirst_[b] = (uint16_t)k0;
+      bandTaps_[b] = 0;
+      uint32_t wsum = 0;
+      for (int k = k0; k <= k1 && taps < MAX_BAND_TAPS; k++) {
+        float a = lo > k - 0.5f ? lo : k - 0.5f;
+        float z = hi < k + 0.5f ? hi : k + 0.5f;
+        uint16_t w = z > a ? (uint16_t)((z - a) * 256.0f + 0.5f) : 0;
+        if (w == 0) w = 1;
+        bandW_[taps++] = w;
+        bandTaps_[b]++;
+        wsum += w;
       }
+      bandRecip_[b] = recipQ24(wsum);
     }
-    
-    // 计算频率和置信度
-    float newPitchHz = 0;
+  }
+
+  void resetBandState() {
+    for (uint8_t b = 0; b < MAX_BANDS; b++) { bandRaw_[b] = 0; bandBytes_[b] = 0; }
+    agc_.resetFloors(AutoGain::CH_BAND0, MAX_BANDS);
+  }
+
+  // N 段频谱：按预计算权重做整数加权求和
+  void calculateSpectrumBands() {
+    const uint16_t* w = bandW_;
+    for (uint8_t b = 0; b < bandCount_; b++) {
+      const uint32_t* m = spectrum_ + bandFirst_[b];
+      uint64_t acc = 0;
+      for (uint16_t t = 0; t < bandTaps_[b]; t++) acc += (uint64_t)w[t] * m[t];
+      w += bandTaps_[b];
+
+      bandRaw_[b] = smooth(bandRaw_[b], bandQ16(acc * bandRecip_[b]), bandAlpha_);
+      bandBytes_[b] = toByte(agc_.channel(AutoGain::CH_BAND0 + b, bandRaw_[b]));
+    }
+  }
+
+  // 计算频段能量：低频 125-500Hz，中频 500Hz-1.5kHz，高频 1.5kHz 以上（跳过直流和非常低的频率）
+  void calculateBands() {
+    uint32_t lowSum = 0, midSum = 0, highSum = 0;
+    for (int i = lowStart_; i < midStart_; i++) lowSum += spectrum_[i];
+    for (int i = midStart_; i < highStart_; i++) midSum += spectrum_[i];
+    for (int i = highStart_; i < bins_; i++) highSum += spectrum_[i];
+
+    // 平均幅度归一化、平滑，再经底噪扣除与自动增益
+    lowRaw_ = smooth(lowRaw_, bandQ16((uint64_t)lowSum * lowRecip_), bandAlpha_);
+    midRaw_ = smooth(midRaw_, bandQ16((uint64_t)midSum * midRecip_), bandAlpha_);
+    highRaw_ = smooth(highRaw_, bandQ16((uint64_t)highSum * highRecip_), bandAlpha_);
+    low_ = agc_.channel(AutoGain::CH_LOW, lowRaw_);
+    mid_ = agc_.channel(AutoGain::CH_MID, midRaw_);
+    high_ = agc_.channel(AutoGain::CH_HIGH, highRaw_);
+  }
+  
+  // 对最近 PITCH_WINDOW 个时域样本做音高估计
+  void detectPitch() {
+    copyLatest(pitchFrame_, PITCH_WINDOW);
+    PitchEstimate est;
     float newPitchConf = 0;
-    
-    if (bestPeriod > 0) {
-      newPitchHz = (float)SAMPLING_FREQ / bestPeriod;
-      
-      // 计算置信度 (0-1)
-      // 归一化相关值作为置信度指标
-      float normCorrelation = maxCorrelation / (level() * 2048.0f);
-      newPitchConf = constrain(normCorrelation, 0.0f, 1.0f);
-      
+    if (pitch_->estimate(pitchFrame_, PITCH_WINDOW, fs_, est)) {
+      newPitchConf = est.confidence;
       // 如果音量太低，降低置信度
       if (level() < 0.05f) {
         newPitchConf *= level() * 20.0f; // 在低音量时逐渐降低置信度
       }
     }
-    
+
     // 仅在置信度足够高时更新音高
     if (newPitchConf > 0.3f) {
-      // 平滑过渡
-      pitchHz_ = pitchHz_ * 0.7f + newPitchHz * 0.3f;
-      pitchConf_ = pitchConf_ * 0.7f + newPitchConf * 0.3f;
+      // 从无到有时直接采用新值，避免从0平滑上来产生错误的中间频率
+      if (pitchHz_ <= 0.0f) pitchHz_ = est.hz;
+      else pitchHz_ = pitchHz_ * pitchKeep_ + est.hz * (1.0f - pitchKeep_);
+      pitchConf_ = pitchConf_ * pitchKeep_ + newPitchConf * (1.0f - pitchKeep_);
     } else {
-      // 如果置信度低，逐渐降低旧值的权重
-      pitchHz_ = pitchHz_ * 0.95f;
-      pitchConf_ = pitchConf_ * 0.95f;
+      // 置信度低时只衰减置信度，频率保持不变（衰减频率会扫过一串虚假音高）
+      pitchConf_ = pitchConf_ * pitchDecay_;
+      if (pitchConf_ < 0.05f) { pitchConf_ = 0.0f; pitchHz_ = 0.0f; }
     }
   }
 
   // 常量
-  static const int SAMPLES = 128;
-  static const int SAMPLING_FREQ = 8000;
+  static const int MAX_WINDOW = 512;
+  static const int MAX_BINS = MAX_WINDOW / 2;
+  static const int MAX_BANDS = 32;
+  static const int MAX_BAND_TAPS = MAX_BINS + MAX_BANDS; // 每个频段边界最多把一个 bin 拆成两份
+  static const int PITCH_WINDOW = 256;   // 音高分析长度：80Hz 时约 2.5 个周期
+  static const int PITCH_INTERVAL = 128; // 每 128 个新样本（16ms）估计一次音高
+  static const int CHROMA_WINDOW = MAX_WINDOW; // 色度 FFT 长度：bin 间隔 15.6Hz
+  static const int CHROMA_INTERVAL = 128;      // 窗口较短时每 128 个新样本（16ms）算一次色度
+  static const uint32_t CHROMA_ACTIVE_LEVEL = 1311; // 0.02（Q16）
+  static const int DEFAULT_WINDOW = 128;
+  static const int DEFAULT_HOP = 32;   // 75%重叠，特征更新频率为不重叠时的4倍
+  static const int SAMPLING_FREQ = 8000; // 标称采样率，实际换算用 fs_
 
   // 成员变量
   uint8_t pin_;
-  unsigned long lastTick_ = 0;
-  float levelSmoothed_ = 0.0f;
-  float low_ = 0.0f, mid_ = 0.0f, high_ = 0.0f;
+#if defined(ARDUINO_ARCH_ESP32)
+  AdcContinuousSource adcSource_;
+  TimerAdcSource fallbackSource_;
+#else
+  SyntheticSampleSource hostSource_;
+#endif
+  SampleSource* source_;
+  float fs_ = SAMPLING_FREQ;   // 频率换算所用的采样率（分析侧）
+  uint32_t frames_ = 0;
+  uint8_t demand_ = 0;                               // 分析任务当前生效的需求
+  uint8_t demandBy_[CONSUMER_COUNT] = {};            // 控制侧：各消费者的需求
+  uint32_t skipped_[AudioFeatures::STAGE_COUNT] = {}; // 各阶段跳过次数
+  StageProfile profile_[PROFILE_SLOTS];
+  GoertzelBank match_;
+  OnsetDetector onset_;
+  ChromaAnalyzer chroma_;
+  uint32_t beatSeen_ = 0;
+  uint32_t pitchHits_ = 0;
+  float pitchHitConf_ = 0.0f;
+
+  // 跨任务通道
+  Control ctl_;                           // 控制侧副本
+  SeqlockSnapshot<Control> control_;      // 控制侧 → 分析任务
+  uint32_t controlSeq_ = 0;               // 分析任务已应用的控制序号
+  SeqlockSnapshot<AudioFeatures> features_; // 分析任务 → 其它任务
+
+  // 滑动窗口配置与状态
+  uint16_t window_ = DEFAULT_WINDOW;
+  uint16_t hop_ = DEFAULT_HOP;
+  uint16_t bins_ = DEFAULT_WINDOW / 2;
+  uint16_t histPos_ = 0;       // 下一个写入位置（同时也是最旧样本的位置）
+  uint16_t histFill_ = 0;      // 历史中有效样本数
+  uint16_t newSinceHop_ = 0;   // 自上次分析以来的新样本数
+  uint16_t sinceLastPitch_ = 0; // 自上次音高估计以来的新样本数
+  uint16_t sinceLastChroma_ = 0; // 自上次色度计算以来的新样本数（色度单独 FFT 时）
+  uint32_t sumSq_ = 0;         // 窗口内样本平方和（增量维护）
+
+  // 频段边界（bin索引）与归一化
+  uint16_t lowStart_ = 2, midStart_ = 8, highStart_ = 25;
+  float bandNorm_ = 2048.0f;
+  uint8_t windowLog2_ = 7;
+  uint32_t lowRecip_ = 0, midRecip_ = 0, highRecip_ = 0; // 各频段 bin 数的倒数（Q24）
+
+  // N 段频谱配置与预计算的 bin→频段 权重
+  uint8_t bandCount_ = 16;
+  BandScale bandScale_ = BAND_LOG;
+  uint16_t bandFirst_[MAX_BANDS];
+  uint16_t bandTaps_[MAX_BANDS];
+  uint16_t bandW_[MAX_BAND_TAPS];
+  uint32_t bandRecip_[MAX_BANDS]; // 权重和的倒数（Q24）
+  uint32_t bandRaw_[MAX_BANDS];   // 平滑后、自动增益前的频段值（Q16）
+  uint8_t bandBytes_[MAX_BANDS];
+
+  // 按跳步换算后的平滑系数（电平与频段为 Q16 定点）
+  uint32_t levelAlpha_ = 13107, bandAlpha_ = 9830;
+  float pitchKeep_ = 0.7f, pitchDecay_ = 0.95f;
+
+  // 电平与频段：*Raw_ 为平滑后、自动增益前的值，其余为归一化输出，均为 Q16
+  uint32_t levelRaw_ = 0, level_ = 0;
+  uint32_t lowRaw_ = 0, midRaw_ = 0, highRaw_ = 0;
+  uint32_t low_ = 0, mid_ = 0, high_ = 0;
   float pitchHz_ = 0.0f;
   float pitchConf_ = 0.0f;
-  float sensitivity_ = 1.0f;
+
+  // 前端：直流跟踪与自动增益
+  DcTracker dc_;
+  AutoGain agc_;
   
+  // 采样与频谱
+  int16_t hist_[MAX_WINDOW];     // 去直流后的样本环形历史（固定 MAX_WINDOW 长）
+  int16_t frame_[MAX_WINDOW];    // 按时间顺序展开的当前分析窗口
+  int16_t pitchFrame_[PITCH_WINDOW];
+  uint32_t spectrum_[MAX_BINS];  // 幅度谱（与ArduinoFFT同量纲）
+
   // FFT相关
-  double vReal[SAMPLES];
-  double vImag[SAMPLES];
-  arduinoFFT* fft;
+#if AUDIO_FIXED_POINT_FFT
+  FixedRealFFT<MAX_WINDOW> fft;
+#else
+  double vReal[MAX_WINDOW];
+  double vImag[MAX_WINDOW];
+  arduinoFFT* fft = nullptr;
+  FixedRealFFT<MAX_WINDOW> acfFft_; // 仅供自相关音高估计使用
+#endif
+
+  FixedRealFFT<CHROMA_WINDOW> chromaFft_; // 窗口短于 CHROMA_WINDOW 时色度专用
+
+  // 音高估计器
+  AcfPitchEstimator<MAX_WINDOW> acfPitch_;
+  YinPitchEstimator<PITCH_WINDOW> yinPitch_;
+  PitchEstimator* pitch_;
 };
@@ -0,0 +1,208 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "fixed_fft.hpp"
+
+/**
+ * 音高估计结果
+ */
+struct PitchEstimate {
+  float hz = 0.0f;          // 基频，0 表示未检测到
+  float confidence = 0.0f;  // 置信度 0..1
+};
+
+/**
+ * 音高估计器接口
+ * 输入为去直流后的时域样本（ADC计数），分析器按需切换不同实现
+ */
+class PitchEstimator {
+public:
+  virtual ~PitchEstimator() {}
+
+  /**
+   * @param x  时域样本（按时间顺序）
+   * @param n  样本数
+   * @param fs 采样率（Hz）
+   * @return 是否得到有效结果
+   */
+  virtual bool estimate(const int16_t* x, uint16_t n, float fs, PitchEstimate& out) = 0;
+
+  virtual const char* name() const = 0;
+
+  // 搜索范围（Hz），默认覆盖 80Hz-1kHz
+  void setRange(float minHz, float maxHz) {
+    if (minHz > 0 && maxHz > minHz) { minHz_ = minHz; maxHz_ = maxHz; }
+  }
+
+protected:
+  // 由频率范围得到滞后范围，最大滞后不超过 n/2，保证至少两个周期
+  bool lagRange(uint16_t n, float fs, uint16_t& minLag, uint16_t& maxLag) const {
+    minLag = (uint16_t)(fs / maxHz_);
+    maxLag = (uint16_t)(fs / minHz_ + 1.0f);
+    if (minLag < 2) minLag = 2;
+    if (maxLag > n / 2) maxLag = n / 2;
+    return maxLag > minLag + 2;
+  }
+
+  // 抛物线插值：返回以 i 为中心的亚样本峰（谷）偏移 (-0.5..0.5)
+  static float parabolicOffset(float a, float b, float c) {
+    float den = a - 2.0f * b + c;
+    if (den == 0.0f) return 0.0f;
+    float d = 0.5f * (a - c) / den;
+    if (d > 0.5f) d = 0.5f;
+    if (d < -0.5f) d = -0.5f;
+    return d;
+  }
+
+  float minHz_ = 80.0f;
+  float maxHz_ = 1000.0f;
+};
+
+/**
+ * 基于FFT的自相关音高估计（Wiener–Khinchin + MPM）
+ * r = IFFT(|FFT(x补零到2n)|²)，复杂度 O(n log n)，开销与滞后范围无关。
+ * 自相关按 MPM 的 NSDF 归一化（2r(τ)/m(τ)，m 由平方前缀和增量得到），
+ * 峰值选取采用“首个接近全局最大值的峰”规则。
+ */
+template <uint16_t MAX_N>
+class AcfPitchEstimator : public PitchEstimator {
+public:
+  explicit AcfPitchEstimator(const FixedRealFFT<MAX_N>& fft) : fft_(fft) {}
+
+  const char* name() const override { return "acf"; }
+
+  bool estimate(const int16_t* x, uint16_t n, float fs, PitchEstimate& out) override {
+    out = PitchEstimate();
+    const uint16_t m = 2 * n;
+    uint16_t minLag, maxLag;
+    if (m > MAX_N || !lagRange(n, fs, minLag, maxLag)) return false;
+
+    for (uint16_t i = 0; i < n; i++) { re_[i] = x[i]; im_[i] = 0; }
+    for (uint16_t i = n; i < m; i++) { re_[i] = 0; im_[i] = 0; }
+    fft_.complexTransform(re_, im_, m, false);
+
+    // 功率谱按峰值动态缩放，保证逆变换累加 m 项时不溢出 int32
+    uint64_t peak = 0;
+    for (uint16_t k = 0; k < m; k++) {
+      uint64_t p = (uint64_t)((int64_t)re_[k] * re_[k]) + (uint64_t)((int64_t)im_[k] * im_[k]);
+      if (p > peak) peak = p;
+    }
+    if (peak == 0) return false;
+    int shift = 0;
+    while ((peak >> shift) > (uint64_t)(0x3FFFFFFF / m)) shift++;
+    for (uint16_t k = 0; k < m; k++) {
+      uint64_t p = (uint64_t)((int64_t)re_[k] * re_[k]) + (uint64_t)((int64_t)im_[k] * im_[k]);
+      re_[k] = (int32_t)(p >> shift);
+      im_[k] = 0;
+    }
+    fft_.complexTransform(re_, im_, m, true);
+
+    // 逆变换未归一化：re_[τ] = m·r(τ)/2^shift
+    const float scale = ldexpf(1.0f, shift) / (float)m;
+
+    // NSDF：n(τ) = 2r(τ) / Σ(x[j]² + x[j+τ]²)，分母随 τ 增量递减
+    float energy = 0.0f;
+    for (uint16_t i = 0; i < n; i++) energy += (float)x[i] * (float)x[i];
+    if (energy <= 0.0f) return false;
+    float msum = 2.0f * energy;
+    const uint16_t last = maxLag + 1 < n ? maxLag + 1 : n - 1;
+    for (uint16_t t = 1; t <= last; t++) {
+      msum -= (float)x[n - t] * (float)x[n - t] + (float)x[t - 1] * (float)x[t - 1];
+      nacf_[t] = msum > 0.0f ? 2.0f * (float)re_[t] * scale / msum : 0.0f;
+    }
+
+    float globalMax = 0.0f;
+    for (uint16_t t = minLag; t <= maxLag; t++) {
+      if (nacf_[t] > globalMax) globalMax = nacf_[t];
+    }
+    if (globalMax <= 0.0f) return false;
+
+    // 取第一个超过 0.9*全局最大值 的局部峰，避免落到倍周期上
+    const float thresh = 0.9f * globalMax;
+    for (uint16_t t = minLag; t <= maxLag; t++) {
+      if (nacf_[t] >= thresh && nacf_[t] >= nacf_[t - 1] && nacf_[t] >= nacf_[t + 1]) {
+        float lag = (float)t + parabolicOffset(nacf_[t - 1], nacf_[t], nacf_[t + 1]);
+        out.hz = fs / lag;
+        out.confidence = nacf_[t] > 1.0f ? 1.0f : nacf_[t];
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  const FixedRealFFT<MAX_N>& fft_;
+  int32_t re_[MAX_N];
+  int32_t im_[MAX_N];
+  float nacf_[MAX_N / 2 + 2];
+};
+
+/**
+ * YIN 音高估计
+ * 差分函数用整数累加，累积均值归一化(CMNDF)后取第一个低于阈值的谷，
+ * 再对该处的差分函数做抛物线插值得到亚样本周期，近 1kHz 时的音分误差显著降低。
+ */
+template <uint16_t MAX_N>
+class YinPitchEstimator : public PitchEstimator {
+public:
+  const char* name() const override { return "yin"; }
+
+  void setThreshold(float t) { threshold_ = t; }
+
+  bool estimate(const int16_t* x, uint16_t n, float fs, PitchEstimate& out) override {
+    out = PitchEstimate();
+    uint16_t minLag, maxLag;
+    if (n > MAX_N || !lagRange(n, fs, minLag, maxLag)) return false;
+    // 差分函数 d(τ)，τ = 1..maxLag+1（多算一个点，最大滞后处的谷也能插值）；
+    // 积分窗口相应少一个样本，保证 j + τ 不越过 n
+    const uint16_t last = maxLag + 1;
+    const uint16_t w = n - last;
+    float running = 0.0f;
+    cmndf_[0] = 1.0f;
+    for (uint16_t tau = 1; tau <= last; tau++) {
+      uint64_t d = 0;
+      for (uint16_t j = 0; j < w; j++) {
+        int32_t diff = (int32_t)x[j] - (int32_t)x[j + tau];
+        d += (uint32_t)(diff * diff);
+      }
+      float df = (float)d;
+      diff_[tau] = df;
+      running += df;
+      cmndf_[tau] = running > 0.0f ? df * (float)tau / running : 1.0f;
+    }
+
+    // 第一个低于阈值的谷；若没有则取全局最小值
+    uint16_t best = 0;
+    for (uint16_t tau = minLag; tau < last; tau++) {
+      if (cmndf_[tau] < threshold_) {
+        while (tau + 1 < last && cmndf_[tau + 1] < cmndf_[tau]) tau++;
+        best = tau;
+        break;
+      }
+    }
+    if (best == 0) {
+      float minVal = 1e30f;
+      for (uint16_t tau = minLag; tau < last; tau++) {
+        if (cmndf_[tau] < minVal) { minVal = cmndf_[tau]; best = tau; }
+      }
+      if (best == 0) return false;
+    }
+
+    // 插值在原始差分函数上做（CMNDF 的归一化会使短周期的谷形偏斜）
+    float lag = (float)best;
+    if (best > 1 && best + 1 <= last) {
+      lag += parabolicOffset(diff_[best - 1], diff_[best], diff_[best + 1]);
+    }
+    float conf = 1.0f - cmndf_[best];
+    if (conf < 0.0f) conf = 0.0f;
+    out.hz = fs / lag;
+    out.confidence = conf;
+    return true;
+  }
+
+private:
+  float threshold_ = 0.15f;
+  float diff_[MAX_N / 2 + 2];
+  float cmndf_[MAX_N / 2 + 2];
+};
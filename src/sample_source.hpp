@@ -0,0 +1,391 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <atomic>
+#include "spsc_ring.hpp"
+#include "audio_features.hpp"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <Arduino.h>
+#include <driver/adc.h>
+#include <esp_timer.h>
+#endif
+
+/**
+ * 采样时序统计快照
+ * 间隔为相邻两批样本到达的时间：DMA 源一批是一帧（block 个样本），定时器逐点采样一批是一个样本
+ */
+struct SamplerStats {
+  uint32_t nominalHz = 0;  // 标称采样率
+  float measuredHz = 0;    // 实测有效采样率（窗口间平滑）
+  uint16_t block = 1;      // 每个间隔对应的标称样本数
+  uint32_t intervals = 0;  // 最近一个窗口内的间隔数
+  float minUs = 0, maxUs = 0, meanUs = 0, stddevUs = 0; // 最近一个窗口内的间隔统计
+  uint32_t late = 0;       // 累计：间隔超过标称 1.5 倍的次数（读取任务被抢占或推迟）
+  uint32_t missed = 0;     // 累计：错过的采样点（仅定时器逐点采样）
+  uint32_t samples = 0;    // 累计样本数
+  uint32_t windows = 0;    // 已完成的统计窗口数
+};
+
+/**
+ * 采样时钟：由采样源的生产者任务在每批样本到达时调用 add()
+ * 按约 2s 的窗口统计到达间隔的最小/最大/均值/标准差，并以“窗口内样本数 ÷ 经过时间”得到实测采样率
+ * （窗口之间再做一阶平滑）；窗口结束时经 seqlock 发布快照，实测采样率另存一个原子量供分析任务每帧读取
+ */
+class SampleClock {
+public:
+  static const uint32_t WINDOW_US = 2000000;
+
+  void reset(uint32_t nominalHz, uint16_t block) {
+    nominal_ = nominalHz;
+    block_ = block;
+    started_ = false;
+    total_ = 0;
+    late_ = 0;
+    missed_ = 0;
+    windows_ = 0;
+    rateHz_ = 0.0f;
+    rateMilliHz_.store(0, std::memory_order_relaxed);
+    clearWindow(0);
+  }
+
+  // 在 nowUs 时刻收到 n 个样本
+  void add(uint32_t nowUs, uint32_t n) {
+    total_ += n;
+    if (!started_) {
+      // 第一批样本是在计时开始之前采到的，不计入采样率
+      started_ = true;
+      lastUs_ = nowUs;
+      clearWindow(nowUs);
+      return;
+    }
+    uint32_t dt = nowUs - lastUs_;
+    lastUs_ = nowUs;
+    winSamples_ += n;
+    count_++;
+    sum_ += dt;
+    sumSq_ += (uint64_t)dt * dt;
+    if (dt < min_) min_ = dt;
+    if (dt > max_) max_ = dt;
+    if ((uint64_t)dt * nominal_ * 2 > (uint64_t)block_ * 3000000u) late_++;
+    uint32_t span = nowUs - winStartUs_;
+    if (span >= WINDOW_US) finishWindow(nowUs, span);
+  }
+
+  // 定时器采样时错过的采样点（不产生样本，只计数）
+  void addMissed(uint32_t n) { missed_ += n; }
+
+  // 实测采样率，第一个窗口结束前为 0
+  float rate() const { return (float)rateMilliHz_.load(std::memory_order_relaxed) / 1000.0f; }
+
+  bool read(SamplerStats& out) const { return stats_.read(out); }
+
+private:
+  void clearWindow(uint32_t nowUs) {
+    winStartUs_ = nowUs;
+    winSamples_ = 0;
+    count_ = 0;
+    sum_ = 0;
+    sumSq_ = 0;
+    min_ = 0xFFFFFFFFu;
+    max_ = 0;
+  }
+
+  void finishWindow(uint32_t nowUs, uint32_t span) {
+    float r = (float)winSamples_ * 1e6f / (float)span;
+    rateHz_ = windows_ == 0 ? r : rateHz_ + (r - rateHz_) * 0.25f;
+    windows_++;
+    rateMilliHz_.store((uint32_t)(rateHz_ * 1000.0f + 0.5f), std::memory_order_relaxed);
+
+    SamplerStats s;
+    s.nominalHz = nominal_;
+    s.measuredHz = rateHz_;
+    s.block = block_;
+    s.intervals = count_;
+    if (count_) {
+      float mean = (float)sum_ / (float)count_;
+      float var = (float)sumSq_ / (float)count_ - mean * mean;
+      s.minUs = (float)min_;
+      s.maxUs = (float)max_;
+      s.meanUs = mean;
+      s.stddevUs = var > 0.0f ? sqrtf(var) : 0.0f;
+    }
+    s.late = late_;
+    s.missed = missed_;
+    s.samples = total_;
+    s.windows = windows_;
+    stats_.publish(s);
+    clearWindow(nowUs);
+  }
+
+  uint32_t nominal_ = 0;
+  uint16_t block_ = 1;
+  bool started_ = false;
+  uint32_t lastUs_ = 0;
+  uint32_t winStartUs_ = 0;
+  uint32_t winSamples_ = 0;
+  uint32_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t sumSq_ = 0;
+  uint32_t min_ = 0xFFFFFFFFu, max_ = 0;
+  uint32_t total_ = 0;
+  uint32_t late_ = 0;
+  uint32_t missed_ = 0;
+  uint32_t windows_ = 0;
+  float rateHz_ = 0.0f;
+  std::atomic<uint32_t> rateMilliHz_{0};
+  SeqlockSnapshot<SamplerStats> stats_;
+};
+
+/**
+ * 音频采样源接口
+ * 分析器只通过该接口取样本，因此既可以由片上ADC驱动，
+ * 也可以在 Linux 主机上由合成信号或录音文件驱动。
+ *
+ * 样本格式：12位ADC原始计数（0..4095，中点2048）
+ */
+class SampleSource {
+public:
+  virtual ~SampleSource() {}
+
+  // 启动采样，失败返回 false
+  virtual bool begin() = 0;
+
+  // 非阻塞读取：最多读出 maxCount 个样本，返回实际数量
+  virtual size_t read(int16_t* dst, size_t maxCount) = 0;
+
+  // 标称采样率（Hz）
+  virtual uint32_t sampleRate() const = 0;
+
+  // 因消费不及时而丢弃的样本数
+  virtual uint32_t dropped() const { return 0; }
+
+  /**
+   * 实测有效采样率（Hz）
+   * ADC 的实际时钟由分频得到，与标称值有千分之几的偏差；逐点采样还会因抢占漏掉采样点。
+   * 分析器用该值换算所有频率（频段边界、音高、色度），不能测量的采样源直接返回标称值
+   */
+  virtual float measuredRate() const { return (float)sampleRate(); }
+
+  // 采样时序统计（见 SampleClock），不能测量的采样源返回 false
+  virtual bool timing(SamplerStats& out) const { (void)out; return false; }
+
+  // 诊断用名称
+  virtual const char* name() const { return "source"; }
+};
+
+/**
+ * 合成信号源：正弦波叠加白噪声
+ * 每次 read 都会填满请求的样本数（即“最快速度”运行），用于主机端基准测试
+ */
+class SyntheticSampleSource : public SampleSource {
+public:
+  explicit SyntheticSampleSource(uint32_t sampleRate = 8000) : rate_(sampleRate) {}
+
+  void setTone(float hz, float amplitude) { toneHz_ = hz; amplitude_ = amplitude; }
+  void setNoise(float amplitude) { noise_ = amplitude; }
+
+  bool begin() override { phase_ = 0.0f; return true; }
+
+  size_t read(int16_t* dst, size_t maxCount) override {
+    const float inc = 2.0f * (float)M_PI * toneHz_ / (float)rate_;
+    for (size_t i = 0; i < maxCount; i++) {
+      // 线性同余噪声，保证多次运行结果一致
+      seed_ = seed_ * 1103515245u + 12345u;
+      float n = ((float)((seed_ >> 16) & 0x7FFF) / 16383.5f - 1.0f) * noise_;
+      float v = 2048.0f + amplitude_ * sinf(phase_) + n;
+      if (v < 0.0f) v = 0.0f;
+      if (v > 4095.0f) v = 4095.0f;
+      dst[i] = (int16_t)v;
+      phase_ += inc;
+      if (phase_ > 2.0f * (float)M_PI) phase_ -= 2.0f * (float)M_PI;
+    }
+    return maxCount;
+  }
+
+  uint32_t sampleRate() const override { return rate_; }
+  const char* name() const override { return "synthetic"; }
+
+private:
+  uint32_t rate_;
+  float toneHz_ = 440.0f;
+  float amplitude_ = 600.0f;
+  float noise_ = 20.0f;
+  float phase_ = 0.0f;
+  uint32_t seed_ = 1;
+};
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+/**
+ * 定时器逐点采样源（ADC连续模式初始化失败时的后备）
+ * esp_timer（系统硬件定时器）按采样周期回调，回调只通知高优先级读取任务，由任务执行 analogRead
+ * 后写入环形缓冲区，read 与 DMA 源一样不阻塞（旧实现在分析任务里连续 analogRead，采样率取决于其耗时）。
+ * 每个采样点的时间戳送入 SampleClock：抖动来自任务唤醒延迟，
+ * 读取任务来不及响应而合并的定时器周期计为错过的采样点，实测采样率相应降低。
+ */
+class TimerAdcSource : public SampleSource {
+public:
+  TimerAdcSource(uint8_t pin, uint32_t sampleRate) : pin_(pin), rate_(sampleRate) {}
+
+  bool begin() override {
+    analogReadResolution(12); // ESP32-C3 ADC up to 12-bit
+    analogSetPinAttenuation(pin_, ADC_11db); // 扩展输入范围至3.3V
+    clock_.reset(rate_, 1);
+    if (xTaskCreate(samplerTask, "adc_sampler", 2048, this, 5, &task_) != pdPASS) return false;
+
+    esp_timer_create_args_t args = {};
+    args.callback = onTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "adc_sampler";
+    if (esp_timer_create(&args, &timer_) != ESP_OK ||
+        esp_timer_start_periodic(timer_, (1000000u + rate_ / 2) / rate_) != ESP_OK) {
+      Serial.println("定时器采样: esp_timer 启动失败");
+      vTaskDelete(task_);
+      task_ = nullptr;
+      return false;
+    }
+    Serial.printf("定时器采样已启动: GPIO%d, %u Hz\n", pin_, (unsigned)rate_);
+    return true;
+  }
+
+  size_t read(int16_t* dst, size_t maxCount) override { return ring_.pop(dst, maxCount); }
+
+  uint32_t sampleRate() const override { return rate_; }
+  uint32_t dropped() const override { return ring_.dropped(); }
+  float measuredRate() const override {
+    float r = clock_.rate();
+    return r > 0.0f ? r : (float)rate_;
+  }
+  bool timing(SamplerStats& out) const override { return clock_.read(out); }
+  const char* name() const override { return "adc_timer"; }
+
+private:
+  static void onTimer(void* arg) { xTaskNotifyGive(static_cast<TimerAdcSource*>(arg)->task_); }
+
+  // 读取任务：每次通知采一个点；通知计数大于 1 说明有定时器周期没能及时响应
+  static void samplerTask(void* arg) {
+    TimerAdcSource* self = static_cast<TimerAdcSource*>(arg);
+    for (;;) {
+      uint32_t ticks = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+      if (ticks == 0) continue;
+      int16_t s = (int16_t)analogRead(self->pin_);
+      self->clock_.add(micros(), 1);
+      if (ticks > 1) self->clock_.addMissed(ticks - 1);
+      self->ring_.push(&s, 1);
+    }
+  }
+
+  uint8_t pin_;
+  uint32_t rate_;
+  esp_timer_handle_t timer_ = nullptr;
+  TaskHandle_t task_ = nullptr;
+  SampleClock clock_;
+  SpscRing<int16_t, 1024> ring_;
+};
+
+/**
+ * ADC连续(DMA)采样源
+ * 由ADC数字控制器按硬件时钟采样并经DMA写入驱动缓冲区，
+ * 后台读取任务把结果搬进无锁环形缓冲区，分析器在 loop 中非阻塞地取走。
+ */
+class AdcContinuousSource : public SampleSource {
+public:
+  AdcContinuousSource(uint8_t pin, uint32_t sampleRate) : pin_(pin), rate_(sampleRate) {}
+
+  bool begin() override {
+    int8_t ch = digitalPinToAnalogChannel(pin_);
+    if (ch < 0 || ch > 4) {
+      Serial.printf("ADC连续模式: GPIO%d 不是ADC1通道\n", pin_);
+      return false;
+    }
+    channel_ = (uint8_t)ch;
+
+    adc_digi_init_config_t initCfg = {};
+    initCfg.max_store_buf_size = FRAME_BYTES * 4;
+    initCfg.conv_num_each_intr = FRAME_BYTES;
+    initCfg.adc1_chan_mask = BIT(channel_);
+    initCfg.adc2_chan_mask = 0;
+    if (adc_digi_initialize(&initCfg) != ESP_OK) {
+      Serial.println("ADC连续模式: 驱动初始化失败");
+      return false;
+    }
+
+    adc_digi_pattern_config_t pattern = {};
+    pattern.atten = ADC_ATTEN_DB_11; // 扩展输入范围至3.3V
+    pattern.channel = channel_;
+    pattern.unit = 0;                // ADC1
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+    adc_digi_configuration_t cfg = {};
+    cfg.conv_limit_en = false;
+    cfg.conv_limit_num = 250;
+    cfg.pattern_num = 1;
+    cfg.adc_pattern = &pattern;
+    cfg.sample_freq_hz = rate_;
+    cfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    cfg.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    if (adc_digi_controller_configure(&cfg) != ESP_OK || adc_digi_start() != ESP_OK) {
+      Serial.println("ADC连续模式: 控制器配置失败");
+      adc_digi_deinitialize();
+      return false;
+    }
+
+    clock_.reset(rate_, FRAME_BYTES / SOC_ADC_DIGI_RESULT_BYTES);
+    if (xTaskCreate(readerTask, "adc_reader", 3072, this, 5, &task_) != pdPASS) {
+      adc_digi_stop();
+      adc_digi_deinitialize();
+      return false;
+    }
+    Serial.printf("ADC连续模式已启动: GPIO%d, %u Hz\n", pin_, (unsigned)rate_);
+    return true;
+  }
+
+  size_t read(int16_t* dst, size_t maxCount) override { return ring_.pop(dst, maxCount); }
+
+  uint32_t sampleRate() const override { return rate_; }
+
+  uint32_t dropped() const override { return ring_.dropped(); }
+
+  // ADC 数字控制器的采样时钟由 APB 分频得到，实际频率与设定值有偏差，按帧到达时间实测
+  float measuredRate() const override {
+    float r = clock_.rate();
+    return r > 0.0f ? r : (float)rate_;
+  }
+  bool timing(SamplerStats& out) const override { return clock_.read(out); }
+  const char* name() const override { return "adc_dma"; }
+
+private:
+  static const uint32_t FRAME_BYTES = 64 * SOC_ADC_DIGI_RESULT_BYTES;
+
+  // 后台任务：阻塞等待DMA帧，解析后写入环形缓冲区
+  static void readerTask(void* arg) {
+    AdcContinuousSource* self = static_cast<AdcContinuousSource*>(arg);
+    uint8_t raw[FRAME_BYTES];
+    int16_t samples[FRAME_BYTES / SOC_ADC_DIGI_RESULT_BYTES];
+    for (;;) {
+      uint32_t len = 0;
+      if (adc_digi_read_bytes(raw, FRAME_BYTES, &len, 100) != ESP_OK) continue;
+      size_t n = 0;
+      for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t* d = reinterpret_cast<const adc_digi_output_data_t*>(&raw[i]);
+        if (d->type2.unit != 0 || d->type2.channel != self->channel_) continue;
+        samples[n++] = (int16_t)d->type2.data;
+      }
+      if (n == 0) continue;
+      self->clock_.add(micros(), n);
+      self->ring_.push(samples, n);
+    }
+  }
+
+  uint8_t pin_;
+  uint32_t rate_;
+  uint8_t channel_ = 0;
+  TaskHandle_t task_ = nullptr;
+  SampleClock clock_;
+  SpscRing<int16_t, 1024> ring_;
+};
+
+#endif // ARDUINO_ARCH_ESP32
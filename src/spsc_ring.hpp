@@ -0,0 +1,57 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * 单生产者/单消费者无锁环形缓冲区
+ * 生产者（ADC读取任务、定时器回调等）与消费者（音频分析器）各自只写自己的索引，
+ * 不需要临界区。N 必须是2的幂，索引自然回绕。
+ */
+template <typename T, uint16_t N>
+class SpscRing {
+  static_assert((N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+  // 生产者调用：写入最多 count 个元素，空间不足时丢弃多余部分并计数
+  size_t push(const T* src, size_t count) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    size_t space = N - (size_t)(head - tail);
+    size_t n = count < space ? count : space;
+    for (size_t i = 0; i < n; i++) {
+      buf_[(head + i) & (N - 1)] = src[i];
+    }
+    head_.store(head + (uint32_t)n, std::memory_order_release);
+    if (n < count) dropped_.store(dropped_.load(std::memory_order_relaxed) + (uint32_t)(count - n), std::memory_order_relaxed);
+    return n;
+  }
+
+  // 消费者调用：读出最多 count 个元素
+  size_t pop(T* dst, size_t count) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+    size_t avail = (size_t)(head - tail);
+    size_t n = count < avail ? count : avail;
+    for (size_t i = 0; i < n; i++) {
+      dst[i] = buf_[(tail + i) & (N - 1)];
+    }
+    tail_.store(tail + (uint32_t)n, std::memory_order_release);
+    return n;
+  }
+
+  size_t available() const {
+    return (size_t)(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+  }
+
+  static size_t capacity() { return N; }
+
+  // 因缓冲区满而被丢弃的元素总数（消费者处理不及时的指标）
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+  std::atomic<uint32_t> dropped_{0};
+  T buf_[N];
+};
@@ -10,7 +10,6 @@
 // 目前使用一条 100 颗 WS2812B 灯带，连接在 GPIO0 上
 #define LED_PIN 0        // WS2812B 数据线连接到 GPIO0
 #define LED_COUNT 160     // 实际灯珠数量
-#define BRIGHTNESS 64    // 亮度设置 (0-255)
 
 // 创建中医经络系统实例
 static TCMMeridianSystem *meridianSystem = nullptr;
@@ -63,13 +62,20 @@ unsigned long autoSwitchIntervalMs = 30000; // 自动切换间隔（毫秒），
 // 供主程序调用的初始化函数：只初始化经络系统和时间，同一 AP/Server 由 main.cpp 管理
 void initTcmSystem() {
   if (!meridianSystem) {
-    CRGB *sharedLeds = controller.canvas().leds();
+    // 经络系统写控制器的外部图层，合成后与灯效走同一个画布输出：亮度、限流与帧统计一致
+    CRGB *sharedLeds = controller.externalLeds();
     uint16_t count = controller.canvas().length();
     meridianSystem = new TCMMeridianSystem(sharedLeds, count);
+    // 路由里置 gTcmMode 后立即绘制（静态显示与动画每一步都经此发送），不等 loop 同步模式
+    meridianSystem->setShowHook([]() {
+      controller.setExternalMode(gTcmMode);
+      controller.presentExternal();
+    });
+    meridianSystem->setBrightnessHook([](uint8_t b) { EnhancedLEDCanvas::globalBrightness() = b; });
   }
 
+  // 亮度沿用画布的全局亮度（/api/brightness 与 /api/tcm/brightness 调的是同一个值）
   meridianSystem->begin();
-  meridianSystem->setBrightness(BRIGHTNESS);
 
   if (!meridianSystem->initFromConfig()) {
     meridianSystem->initMeridians();
@@ -83,6 +89,18 @@ void initTcmSystem() {
   Serial.println("TCM meridian system init done (config from SPIFFS if available)");
 }
 
+// 穴位列表与联想共用的简要信息
+static void appendAcupointSummary(String &json, const AcupointInfo &acupoint) {
+  json += "{";
+  json += "\"name\":\"" + String(acupoint.name) + "\",";
+  json += "\"chineseName\":\"" + String(acupoint.chineseName) + "\",";
+  json += "\"pinyin\":\"" + String(acupoint.pinyin ? acupoint.pinyin : "") + "\",";
+  json += "\"meridian\":" + String(acupoint.meridian) + ",";
+  json += "\"mapped\":" + String(acupoint.mapped() ? "true" : "false") + ",";
+  json += "\"importance\":" + String(acupoint.importance);
+  json += "}";
+}
+
 // 将经络相关 HTTP 接口注册到主程序提供的 WebServer 上
 void registerTcmRoutes(WebServer &server) {
   // 选择经络
@@ -106,12 +124,24 @@ void registerTcmRoutes(WebServer &server) {
     }
   });
 
-  // 显示当前经络
+  // 显示当前经络：fade=毫秒（可选）时渐亮
   server.on("/api/show", HTTP_GET, [&server]() {
+    int fade = server.hasArg("fade") ? server.arg("fade").toInt() : 0;
+    if (fade < 0) fade = 0;
+    if (fade > 10000) fade = 10000;
+
+    if (!meridianSystem->meridianHasLeds(currentMeridian)) {
+      server.send(404, "text/plain", getMeridianChineseName(currentMeridian) + "未启用或不在灯带范围内");
+      return;
+    }
+
     gTcmMode = true;
     // 显示静态经络前停止任何正在进行的循行
     stopTcmFlow();
-    meridianSystem->showMeridian(currentMeridian);
+    if (!meridianSystem->showMeridian(currentMeridian, (uint16_t)fade)) {
+      server.send(503, "text/plain", "动画队列已满");
+      return;
+    }
     server.send(200, "text/plain", "显示" + getMeridianChineseName(currentMeridian));
   });
 
@@ -133,11 +163,18 @@ void registerTcmRoutes(WebServer &server) {
       if (speed > 100) speed = 100;
     }
 
-    gTcmMode = true;
-    server.send(200, "text/plain", "正在模拟" + getMeridianChineseName(currentMeridian) + "循行");
+    if (!meridianSystem->meridianHasLeds(currentMeridian)) {
+      server.send(404, "text/plain", getMeridianChineseName(currentMeridian) + "未启用或不在灯带范围内");
+      return;
+    }
 
+    gTcmMode = true;
     // 使用非阻塞动画：在主循环中通过 tickFlow 推进
-    meridianSystem->startSingleFlow(currentMeridian, 5, 100 - speed);
+    if (!meridianSystem->startSingleFlow(currentMeridian, 5, 100 - speed)) {
+      server.send(503, "text/plain", "动画队列已满");
+      return;
+    }
+    server.send(200, "text/plain", "正在模拟" + getMeridianChineseName(currentMeridian) + "循行");
   });
 
   // 模拟全身经络循行
@@ -150,10 +187,12 @@ void registerTcmRoutes(WebServer &server) {
     }
 
     gTcmMode = true;
-    server.send(200, "text/plain", "正在模拟全身经络循行");
-
     // 非阻塞全身循行
-    meridianSystem->startAllFlow(5, 100 - speed);
+    if (!meridianSystem->startAllFlow(5, 100 - speed)) {
+      server.send(503, "text/plain", "动画队列已满或没有启用的经络");
+      return;
+    }
+    server.send(200, "text/plain", "正在模拟全身经络循行");
   });
 
   // 按当前子午流注经络循行一次
@@ -166,13 +205,15 @@ void registerTcmRoutes(WebServer &server) {
     }
 
     gTcmMode = true;
+    // 非阻塞：计算当前当令经络并由动画队列执行一次循行
+    if (!meridianSystem->startCurrentTimeFlow(5, 100 - speed)) {
+      server.send(503, "text/plain", "动画队列已满或经络未启用");
+      return;
+    }
     server.send(200, "text/plain", "正在按当前子午流注经络循行");
-
-    // 非阻塞：计算当前当令经络并由状态机执行一次循行
-    meridianSystem->startCurrentTimeFlow(5, 100 - speed);
   });
 
-  // 设置亮度（TCM 专用）
+  // 设置亮度（与 /api/brightness 相同，经画布统一缩放与限流）
   server.on("/api/tcm/brightness", HTTP_GET, [&server]() {
     if (server.hasArg("value")) {
       int brightness = server.arg("value").toInt();
@@ -185,37 +226,66 @@ void registerTcmRoutes(WebServer &server) {
     }
   });
 
-  // 显示特定穴位
+  // 显示特定穴位：name 可以是英文名、中文名或拼音（索引查找一次，闪烁与返回详情共用）
   server.on("/api/acupoint", HTTP_GET, [&server]() {
     if (server.hasArg("name")) {
       String name = server.arg("name");
+      const AcupointInfo *acupoint = meridianSystem->findAcupoint(name.c_str());
+      if (!acupoint) {
+        server.send(404, "text/plain", "未找到穴位 " + name);
+        return;
+      }
+      if (!acupoint->mapped()) {
+        server.send(404, "text/plain", "穴位 " + name + " 所在经络未启用或不在灯带范围内");
+        return;
+      }
 
       gTcmMode = true;
-      meridianSystem->blinkAcupoint(name.c_str(), 5, 200, CRGB::White);
-
-      for (const auto &acupoint : meridianSystem->getAcupoints()) {
-        if (strcmp(acupoint.name, name.c_str()) == 0) {
-          String json = "{";
-          json += "\"name\":\"" + String(acupoint.name) + "\",";
-          json += "\"chineseName\":\"" + String(acupoint.chineseName) + "\",";
-          json += "\"pinyin\":\"" + String(acupoint.pinyin ? acupoint.pinyin : "") + "\",";
-          json += "\"location\":\"" + String(acupoint.location ? acupoint.location : "") + "\",";
-          json += "\"functions\":\"" + String(acupoint.functions ? acupoint.functions : "") + "\",";
-          json += "\"indications\":\"" + String(acupoint.indications ? acupoint.indications : "") + "\",";
-          json += "\"importance\":" + String(acupoint.importance);
-          json += "}";
-
-          server.send(200, "application/json", json);
-          return;
-        }
+      // 非阻塞：闪烁交给动画队列，立即返回穴位信息
+      if (!meridianSystem->blinkAcupoint(*acupoint, 5, 200, CRGB::White)) {
+        server.send(503, "text/plain", "动画队列已满");
+        return;
       }
 
-      server.send(200, "text/plain", "正在显示" + name + "穴");
+      String json = "{";
+      json += "\"name\":\"" + String(acupoint->name) + "\",";
+      json += "\"chineseName\":\"" + String(acupoint->chineseName) + "\",";
+      json += "\"pinyin\":\"" + String(acupoint->pinyin ? acupoint->pinyin : "") + "\",";
+      json += "\"location\":\"" + String(acupoint->location ? acupoint->location : "") + "\",";
+      json += "\"functions\":\"" + String(acupoint->functions ? acupoint->functions : "") + "\",";
+      json += "\"indications\":\"" + String(acupoint->indications ? acupoint->indications : "") + "\",";
+      json += "\"importance\":" + String(acupoint->importance);
+      json += "}";
+      server.send(200, "application/json", json);
     } else {
       server.send(400, "text/plain", "缺少参数");
     }
   });
 
+  // 穴位联想：q 为英文名、中文名或拼音的前缀，limit 为最多返回个数（1-50，默认 10）
+  server.on("/api/acupoint/search", HTTP_GET, [&server]() {
+    if (!server.hasArg("q")) {
+      server.send(400, "text/plain", "缺少参数");
+      return;
+    }
+    int limit = server.hasArg("limit") ? server.arg("limit").toInt() : 10;
+    if (limit < 1) limit = 1;
+    if (limit > 50) limit = 50;
+
+    uint16_t hits[50];
+    String q = server.arg("q");
+    uint8_t n = meridianSystem->searchAcupoints(q.c_str(), hits, (uint8_t)limit);
+    const std::vector<AcupointInfo> &acupoints = meridianSystem->getAcupoints();
+
+    String json = "[";
+    for (uint8_t i = 0; i < n; i++) {
+      if (i) json += ",";
+      appendAcupointSummary(json, acupoints[hits[i]]);
+    }
+    json += "]";
+    server.send(200, "application/json", json);
+  });
+
   // 获取所有穴位列表
   server.on("/api/acupoints", HTTP_GET, [&server]() {
     String json = "[";
@@ -224,13 +294,7 @@ void registerTcmRoutes(WebServer &server) {
     for (const auto &acupoint : meridianSystem->getAcupoints()) {
       if (!first) json += ",";
       first = false;
-
-      json += "{";
-      json += "\"name\":\"" + String(acupoint.name) + "\",";
-      json += "\"chineseName\":\"" + String(acupoint.chineseName) + "\",";
-      json += "\"meridian\":" + String(acupoint.meridian) + ",";
-      json += "\"importance\":" + String(acupoint.importance);
-      json += "}";
+      appendAcupointSummary(json, acupoint);
     }
 
     json += "]";
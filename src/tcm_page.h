@@ -75,6 +75,14 @@ static const char TCM_PAGE_HTML[] PROGMEM = R"HTML(
     .acupoint-btn:hover {
       background-color: #2c3e50;
     }
+    .acupoint-search {
+      width: 100%;
+      box-sizing: border-box;
+      padding: 8px;
+      margin-top: 10px;
+      border: 1px solid #ccc;
+      border-radius: 4px;
+    }
     .slider-container {
       margin: 15px 0;
     }
@@ -198,6 +206,8 @@ static const char TCM_PAGE_HTML[] PROGMEM = R"HTML(
         <button class="acupoint-btn" onclick="showAcupoint('Neiguan')">内关穴</button>
         <button class="acupoint-btn" onclick="showAcupoint('Taichong')">太冲穴</button>
       </div>
+      <input type="text" class="acupoint-search" id="acupoint-search" placeholder="搜索穴位：英文名、中文名或拼音" oninput="searchAcupoint(this.value)">
+      <div class="btn-group" id="acupoint-suggest"></div>
       
       <div class="acupoint-info" id="acupoint-info" style="display:none;">
         <h3 id="acupoint-title">穴位信息</h3>
@@ -308,8 +318,12 @@ static const char TCM_PAGE_HTML[] PROGMEM = R"HTML(
     }
     
     function showAcupoint(name) {
-      fetch('/api/acupoint?name=' + name)
-        .then(response => response.json())
+      fetch('/api/acupoint?name=' + encodeURIComponent(name))
+        .then(response => {
+          // 404 未找到或穴位没有对应的灯珠、503 动画队列已满：显示服务器给出的原因
+          if (!response.ok) return response.text().then(text => { throw new Error(text); });
+          return response.json();
+        })
         .then(data => {
           // 更新状态
           document.getElementById('status').innerText = '状态: 正在显示' + data.chineseName + '穴';
@@ -325,11 +339,36 @@ static const char TCM_PAGE_HTML[] PROGMEM = R"HTML(
           document.getElementById('acupoint-indications').innerText = data.indications || '无数据';
         })
         .catch(error => {
-          document.getElementById('status').innerText = '状态: 获取穴位信息失败';
+          document.getElementById('status').innerText = '状态: 获取穴位信息失败 ' + error.message;
           console.error('Error:', error);
         });
     }
     
+    // 穴位输入联想：只保留最后一次输入的结果
+    var searchSeq = 0;
+    function searchAcupoint(text) {
+      var box = document.getElementById('acupoint-suggest');
+      var seq = ++searchSeq;
+      if (!text.trim()) {
+        box.innerHTML = '';
+        return;
+      }
+      fetch('/api/acupoint/search?limit=8&q=' + encodeURIComponent(text))
+        .then(response => response.json())
+        .then(list => {
+          if (seq !== searchSeq) return;
+          box.innerHTML = '';
+          list.forEach(ap => {
+            var btn = document.createElement('button');
+            btn.className = 'acupoint-btn';
+            btn.innerText = ap.chineseName + ' ' + ap.pinyin;
+            btn.onclick = function() { showAcupoint(ap.name); };
+            box.appendChild(btn);
+          });
+        })
+        .catch(error => console.error('Error:', error));
+    }
+    
     // 子午流注相关函数
     function toggleZiwuliuzhu() {
       ziwuliuzhuEnabled = !ziwuliuzhuEnabled;
@@ -0,0 +1,158 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <SPIFFS.h>
+#else
+#include <stdio.h>
+#endif
+
+/**
+ * 录音文件读写
+ * 设备端读写 SPIFFS，主机端读写普通文件，两边是同一种格式，可以互相回放：
+ * 16 位单声道 PCM WAV，样本为 12 位 ADC 原始计数（0..4095，中点 2048），
+ * 即分析器从 SampleSource 读到的原样数据。
+ */
+class AudioFile {
+public:
+  ~AudioFile() { close(); }
+
+  bool open(const char* path, bool forWrite) {
+    close();
+#if defined(ARDUINO)
+    if (!SPIFFS.begin(true)) return false;
+    file_ = SPIFFS.open(path, forWrite ? "w" : "r");
+    return (bool)file_;
+#else
+    fp_ = fopen(path, forWrite ? "wb" : "rb");
+    return fp_ != nullptr;
+#endif
+  }
+
+  void close() {
+#if defined(ARDUINO)
+    if (file_) file_.close();
+#else
+    if (fp_) fclose(fp_);
+    fp_ = nullptr;
+#endif
+  }
+
+  bool isOpen() const {
+#if defined(ARDUINO)
+    return (bool)file_;
+#else
+    return fp_ != nullptr;
+#endif
+  }
+
+  size_t read(void* dst, size_t bytes) {
+#if defined(ARDUINO)
+    return file_.read((uint8_t*)dst, bytes);
+#else
+    return fp_ ? fread(dst, 1, bytes, fp_) : 0;
+#endif
+  }
+
+  size_t write(const void* src, size_t bytes) {
+#if defined(ARDUINO)
+    return file_.write((const uint8_t*)src, bytes);
+#else
+    return fp_ ? fwrite(src, 1, bytes, fp_) : 0;
+#endif
+  }
+
+  bool seek(uint32_t pos) {
+#if defined(ARDUINO)
+    return file_.seek(pos);
+#else
+    return fp_ && fseek(fp_, (long)pos, SEEK_SET) == 0;
+#endif
+  }
+
+private:
+#if defined(ARDUINO)
+  fs::File file_;
+#else
+  FILE* fp_ = nullptr;
+#endif
+};
+
+/**
+ * WAV 头（RIFF / fmt / data，44 字节）
+ * 录音开始时先写一个数据长度为 0 的头，结束时回写真实长度；
+ * 解析时跳过 fmt 与 data 之间的其它块
+ */
+namespace wav {
+
+static const uint32_t HEADER_BYTES = 44;
+
+struct Info {
+  uint32_t sampleRate = 0;
+  uint32_t dataOffset = 0; // data 块起始位置（字节）
+  uint32_t samples = 0;    // 样本数
+};
+
+inline void putLE(uint8_t* p, uint32_t v, uint8_t bytes) {
+  for (uint8_t i = 0; i < bytes; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+inline uint32_t getLE(const uint8_t* p, uint8_t bytes) {
+  uint32_t v = 0;
+  for (uint8_t i = 0; i < bytes; i++) v |= (uint32_t)p[i] << (8 * i);
+  return v;
+}
+
+// 在文件开头写入/回写 16 位单声道头
+inline bool writeHeader(AudioFile& f, uint32_t sampleRate, uint32_t samples) {
+  uint8_t h[HEADER_BYTES];
+  uint32_t dataBytes = samples * 2;
+  memcpy(h, "RIFF", 4);
+  putLE(h + 4, 36 + dataBytes, 4);
+  memcpy(h + 8, "WAVEfmt ", 8);
+  putLE(h + 16, 16, 4);             // fmt 块长度
+  putLE(h + 20, 1, 2);              // PCM
+  putLE(h + 22, 1, 2);              // 单声道
+  putLE(h + 24, sampleRate, 4);
+  putLE(h + 28, sampleRate * 2, 4); // 字节率
+  putLE(h + 32, 2, 2);              // 块对齐
+  putLE(h + 34, 16, 2);             // 位深
+  memcpy(h + 36, "data", 4);
+  putLE(h + 40, dataBytes, 4);
+  return f.seek(0) && f.write(h, HEADER_BYTES) == HEADER_BYTES;
+}
+
+// 解析头并把读位置留在数据起点；只接受 16 位单声道 PCM
+inline bool readHeader(AudioFile& f, Info& info) {
+  uint8_t h[12];
+  if (!f.seek(0) || f.read(h, 12) != 12) return false;
+  if (memcmp(h, "RIFF", 4) != 0 || memcmp(h + 8, "WAVE", 4) != 0) return false;
+
+  uint32_t pos = 12;
+  bool haveFmt = false;
+  for (;;) {
+    uint8_t c[8];
+    if (f.read(c, 8) != 8) return false;
+    uint32_t len = getLE(c + 4, 4);
+    pos += 8;
+    if (memcmp(c, "fmt ", 4) == 0) {
+      uint8_t fmt[16];
+      if (len < 16 || f.read(fmt, 16) != 16) return false;
+      if (getLE(fmt, 2) != 1 || getLE(fmt + 2, 2) != 1 || getLE(fmt + 14, 2) != 16) return false;
+      info.sampleRate = getLE(fmt + 4, 4);
+      haveFmt = true;
+    } else if (memcmp(c, "data", 4) == 0) {
+      if (!haveFmt) return false;
+      info.dataOffset = pos;
+      // 录音中途断电时头里的长度仍为 0，此时一直读到文件末尾
+      info.samples = len ? len / 2 : 0xFFFFFFFFu;
+      return true;
+    }
+    pos += len + (len & 1); // 块按偶数字节对齐
+    if (!f.seek(pos)) return false;
+  }
+}
+
+} // namespace wav
@@ -5,6 +5,9 @@
 #include "meridian.hpp"
 #include "enhanced_led_controller.hpp"
 #include "optimized_audio.hpp"
+#include "audio_task.hpp"
+#include "audio_capture.hpp"
+#include "frame_scheduler.hpp"
 #include "tcm_page.h"
 
 // 使用于音频模式同步的全局变量声明
@@ -122,6 +125,128 @@ inline void startAp(const char *ssid)
   Serial.printf("AP %s %s, IP: %s\n", ssid, ok ? "started" : "failed", WiFi.softAPIP().toString().c_str());
 }
 
+// 画布输出的帧统计（灯效与经络模式共用同一路输出）：tick 次数、重新渲染的帧、实际发送到灯带的帧
+inline void appendFrameStats(String &s, EnhancedLEDController &ctrl)
+{
+  s += "{";
+  s += "\"ticks\":"; s += String((unsigned long)ctrl.ticks()); s += ",";
+  s += "\"rendered\":"; s += String((unsigned long)ctrl.framesRendered()); s += ",";
+  s += "\"transmitted\":"; s += String((unsigned long)ctrl.framesTransmitted()); s += ",";
+  s += "\"changed\":"; s += String((unsigned long)ctrl.canvas().framesChanged()); s += ",";
+  s += "\"unchanged\":"; s += String((unsigned long)ctrl.canvas().framesUnchanged()); s += ",";
+  s += "\"refreshed\":"; s += String((unsigned long)ctrl.canvas().framesRefreshed()); s += ",";
+  s += "\"dithered\":"; s += String((unsigned long)ctrl.canvas().framesDithered()); s += ",";
+  // 异步发送：发送耗时、提交前等待上一帧的时间，重叠率 = 1 - 等待/发送
+  const LedTransmitter::Stats& tx = ctrl.canvas().txStats();
+  s += "\"tx\":{";
+    s += "\"last_us\":"; s += String((unsigned long)tx.lastTxUs); s += ",";
+    s += "\"max_us\":"; s += String((unsigned long)tx.maxTxUs); s += ",";
+    s += "\"wait_us\":"; s += String((unsigned long)tx.lastWaitUs); s += ",";
+    s += "\"max_wait_us\":"; s += String((unsigned long)tx.maxWaitUs); s += ",";
+    s += "\"waits\":"; s += String((unsigned long)tx.waits); s += ",";
+    s += "\"overlap\":"; s += String(tx.overlap(), 3);
+  s += "}";
+  s += "}";
+}
+
+// 画布输出：亮度、输出级与功率模型。灯效与经络模式都经画布发送，两个固件注册同一组接口
+inline void registerOutputRoutes(
+    WebServer &server,
+    EnhancedLEDController &ctrl,
+    uint8_t &gBrightness,
+    uint16_t &powerLimit_mA,
+    uint8_t &ledFull_mA,
+    uint32_t &lastCurrentEst_mA)
+{
+  server.on("/api/brightness", HTTP_GET, [&]()
+            {
+    if (!server.hasArg("value")) { sendJson(server, 400, "{\"ok\":false,\"error\":\"value required\"}"); return; }
+    int v = server.arg("value").toInt();
+    if (v < 0) v = 0; if (v > 255) v = 255;
+    gBrightness = (uint8_t)v;
+    sendJson(server, 200, String("{\"ok\":true,\"brightness\":") + String((int)gBrightness) + "}"); });
+
+  // 输出级：/api/output?gamma=0|1&dither=0|1&static_dither=0|1，不带参数时返回当前设置、是否在经络（外部图层）模式与帧统计
+  server.on("/api/output", HTTP_GET, [&]()
+            {
+    LedOutputStage& out = ctrl.canvas().output();
+    if (server.hasArg("gamma")) out.setGamma(server.arg("gamma").toInt() != 0);
+    if (server.hasArg("dither")) out.setDither(server.arg("dither").toInt() != 0);
+    if (server.hasArg("static_dither")) ctrl.canvas().setStaticDither(server.arg("static_dither").toInt() != 0);
+    ctrl.canvas().requestRefresh();
+    String s = "{\"ok\":true,";
+    s += "\"gamma\":"; s += out.gamma()?"true":"false"; s += ",";
+    s += "\"dither\":"; s += out.dither()?"true":"false"; s += ",";
+    s += "\"static_dither\":"; s += ctrl.canvas().staticDither()?"true":"false"; s += ",";
+    s += "\"dithering\":"; s += out.dithering()?"true":"false"; s += ",";
+    s += "\"external\":"; s += ctrl.externalMode()?"true":"false"; s += ",";
+    s += "\"frames\":"; appendFrameStats(s, ctrl);
+    s += "}";
+    sendJson(server, 200, s); });
+
+  // 功率模型：limit_ma 限流值，led_full_ma 每颗灯全白电流（三通道平分），
+  // r_ma/g_ma/b_ma 各通道满占空比电流，idle_ma 每颗灯静态电流，supply_mv 供电电压（换算 Wh）
+  server.on("/api/power", HTTP_GET, [&]()
+            {
+    bool changed = false;
+    LedPowerModel& pm = ctrl.canvas().power();
+    if (server.hasArg("limit_ma")) { int v = server.arg("limit_ma").toInt(); if (v<0) v=0; if (v>100000) v=100000; powerLimit_mA = (uint16_t)v; changed = true; }
+    if (server.hasArg("led_full_ma")) { int v = server.arg("led_full_ma").toInt(); if (v<=0) v=60; if (v>120) v=120; ledFull_mA = (uint8_t)v; pm.setLedFull(ledFull_mA); changed = true; }
+    uint16_t cal[4] = { pm.channel_uA(0), pm.channel_uA(1), pm.channel_uA(2), pm.idle_uA() };
+    const char* calArgs[4] = { "r_ma", "g_ma", "b_ma", "idle_ma" };
+    for (uint8_t i = 0; i < 4; i++) {
+      if (!server.hasArg(calArgs[i])) continue;
+      float v = server.arg(calArgs[i]).toFloat();
+      if (v < 0) v = 0; if (v > 60) v = 60;
+      cal[i] = (uint16_t)(v * 1000.0f + 0.5f);
+      changed = true;
+    }
+    pm.setCalibration(cal[0], cal[1], cal[2], cal[3]);
+    if (server.hasArg("supply_mv")) { int v = server.arg("supply_mv").toInt(); if (v<1000) v=1000; if (v>24000) v=24000; pm.setSupply_mV((uint16_t)v); changed = true; }
+    String s = "{";
+    s += "\"ok\":true,\"changed\":"; s += changed?"true":"false"; s += ",";
+    s += "\"limit_ma\":"; s += String((int)powerLimit_mA); s += ",";
+    s += "\"led_full_ma\":"; s += String((int)ledFull_mA); s += ",";
+    s += "\"r_ma\":"; s += String(pm.channel_uA(0) / 1000.0f, 1); s += ",";
+    s += "\"g_ma\":"; s += String(pm.channel_uA(1) / 1000.0f, 1); s += ",";
+    s += "\"b_ma\":"; s += String(pm.channel_uA(2) / 1000.0f, 1); s += ",";
+    s += "\"idle_ma\":"; s += String(pm.idle_uA() / 1000.0f, 2); s += ",";
+    s += "\"supply_mv\":"; s += String((int)pm.supply_mV()); s += ",";
+    s += "\"estimated_ma\":"; s += String((int)lastCurrentEst_mA); s += ",";
+    s += "\"requested_ma\":"; s += String(pm.requested_mA(), 0); s += ",";
+    s += "\"limited\":"; s += pm.limited()?"true":"false"; s += ",";
+    // 负载更新方式：整帧重算与按脏区增量的次数
+    s += "\"scans\":{\"full\":"; s += String((unsigned long)ctrl.canvas().loadFullScans());
+    s += ",\"partial\":"; s += String((unsigned long)ctrl.canvas().loadPartialScans()); s += "}";
+    s += "}";
+    sendJson(server, 200, s); });
+
+  // 电流历史：最近 60 秒（每秒）与 60 分钟（每分钟）的平均/峰值 mA，从旧到新；累计 mAh 与 Wh
+  server.on("/api/power/history", HTTP_GET, [&]()
+            {
+    const LedPowerModel& pm = ctrl.canvas().power();
+    String s = "{\"ok\":true,";
+    s += "\"supply_mv\":"; s += String((int)pm.supply_mV()); s += ",";
+    s += "\"mah\":"; s += String(pm.mAh(), 2); s += ",";
+    s += "\"wh\":"; s += String(pm.Wh(), 3); s += ",";
+    for (uint8_t r = 0; r < 2; r++) {
+      uint8_t n = r ? pm.minuteCount() : pm.secondCount();
+      s += r ? "\"minutes\":{" : "\"seconds\":{";
+      for (uint8_t f = 0; f < 2; f++) {
+        s += f ? ",\"peak_ma\":[" : "\"avg_ma\":[";
+        for (uint8_t i = 0; i < n; i++) {
+          const LedPowerModel::Sample& x = r ? pm.minute(n - 1 - i) : pm.second(n - 1 - i);
+          if (i) s += ",";
+          s += String((int)(f ? x.peak_mA : x.avg_mA));
+        }
+        s += "]";
+      }
+      s += r ? "}" : "},";
+    }
+    s += "}";
+    sendJson(server, 200, s); });
+}
+
 inline void registerWeb(
     WebServer &server,
     const char *apSsid,
@@ -132,6 +257,7 @@ inline void registerWeb(
     uint32_t &lastCurrentEst_mA,
     EnhancedLEDController &ctrl,
     OptimizedAudioAnalyzer &analyzer,
+    AudioTask &audioTask,
     uint16_t &stepIndex,
     bool &pitchArmed,
     float &pitchTargetHz,
@@ -315,17 +441,28 @@ poll();
     if (!server.hasArg("arm")) { sendJson(server,400,"{\"ok\":false,\"error\":\"arm required\"}"); return; }
     int a = server.arg("arm").toInt();
     pitchArmed = (a!=0);
+    if (server.hasArg("target")) { float hz; if (parseNoteToHz(server.arg("target"), hz)) pitchTargetHz = hz; }
+    if (server.hasArg("conf")) pitchConfThresh = constrain(server.arg("conf").toFloat(), 0.0f, 1.0f);
+    if (server.hasArg("tol")) pitchTolCents = constrain(server.arg("tol").toFloat(), 5.0f, 600.0f);
+
+    // 目标音或容差变化时重新调谐 Goertzel 滤波器组；解除武装时停止逐样本滤波
+    analyzer.setPitchMatch(pitchArmed, pitchTargetHz, pitchTolCents);
 
     // 当关闭音高检测时，清除由 Pitch 命中产生的点效果，避免 LED 长亮无法通过 Web UI 清掉
     if (!pitchArmed) {
       ctrl.clearPoint();
     }
 
-    sendJson(server,200, String("{\"ok\":true,\"armed\":") + (pitchArmed?"true":"false") + "}"); });
+    sendJson(server,200, String("{\"ok\":true,\"armed\":") + (pitchArmed?"true":"false") + ",\"target_hz\":" + String(pitchTargetHz,2) + "}"); });
 
   // Audio control: /api/audio?enable=0/1 or /api/audio?set=1&sens=f&maxLen=n&low=r,g,b&mid=r,g,b&high=r,g,b
+  // 自动增益开关：/api/audio?agc=0/1（可单独使用）
   server.on("/api/audio", HTTP_GET, [&]()
             {
+    if (server.hasArg("agc")) {
+      analyzer.setAgc(server.arg("agc").toInt() != 0);
+      if (!server.hasArg("enable")) { sendJson(server, 200, String("{\"ok\":true,\"agc\":") + (analyzer.agcEnabled()?"true":"false") + "}"); return; }
+    }
     if (!server.hasArg("enable")) { sendJson(server,400,"{\"ok\":false,\"error\":\"enable required\"}"); return; }
     bool en = (server.arg("enable").toInt()!=0);
     ctrl.enableAudio(en);
@@ -333,6 +470,7 @@ poll();
     // 当关闭音频效果时，同时关闭 Pitch 检测和 Pitch→Length，并清除点效果，避免残留LED长亮
     if (!en) {
       pitchArmed = false;
+      analyzer.setPitchMatch(false, pitchTargetHz, pitchTolCents);
       pitchMapEnable = false;
       ctrl.clearPoint();
     }
@@ -352,6 +490,43 @@ poll();
 
     ctrl.setAudioMode(static_cast<AudioVisualizer::EffectType>(mode));
     sendJson(server, 200, String("{\"ok\":true,\"mode\":") + String(mode) + "}"); });
+  // 采样诊断：/api/audio/diag
+  // 采样源、标称与实测采样率、到达间隔抖动（最近约 2s 窗口）、迟到/错过/丢弃计数，以及分析器实际使用的采样率
+  server.on("/api/audio/diag", HTTP_GET, [&]()
+            {
+    SampleSource *src = analyzer.source();
+    AudioFeatures f;
+    analyzer.readFeatures(f);
+    SamplerStats t;
+    bool timed = src->timing(t);
+    float nominal = (float)src->sampleRate();
+    float measured = src->measuredRate();
+    String s = "{";
+    s += "\"source\":\""; s += src->name(); s += "\",";
+    s += "\"nominal_hz\":"; s += String((unsigned long)src->sampleRate()); s += ",";
+    s += "\"measured_hz\":"; s += String(measured, 2); s += ",";
+    s += "\"error_ppm\":"; s += String(nominal > 0 ? (long)((measured - nominal) * 1e6f / nominal) : 0L); s += ",";
+    s += "\"analysis_hz\":"; s += String(f.sampleRate, 2); s += ",";
+    s += "\"dropped\":"; s += String((unsigned long)src->dropped()); s += ",";
+    s += "\"timing\":";
+    if (timed) {
+      s += "{";
+      s += "\"block\":"; s += String((unsigned)t.block); s += ",";
+      s += "\"intervals\":"; s += String((unsigned long)t.intervals); s += ",";
+      s += "\"min_us\":"; s += String(t.minUs, 1); s += ",";
+      s += "\"max_us\":"; s += String(t.maxUs, 1); s += ",";
+      s += "\"mean_us\":"; s += String(t.meanUs, 2); s += ",";
+      s += "\"stddev_us\":"; s += String(t.stddevUs, 2); s += ",";
+      s += "\"late\":"; s += String((unsigned long)t.late); s += ",";
+      s += "\"missed\":"; s += String((unsigned long)t.missed); s += ",";
+      s += "\"samples\":"; s += String((unsigned long)t.samples); s += ",";
+      s += "\"windows\":"; s += String((unsigned long)t.windows);
+      s += "}";
+    } else {
+      s += "null";
+    }
+    s += "}";
+    sendJson(server,200,s); });
   server.on("/index.html", HTTP_GET, [&server]()
             { server.sendHeader("Location","/"); server.send(302); });
 
@@ -363,7 +538,31 @@ poll();
     s += "\"brightness\":"; s += String((int)gBrightness); s += ",";
     s += "\"power\":{";
       s += "\"limit_ma\":"; s += String((int)powerLimit_mA); s += ",";
-      s += "\"estimated_ma\":"; s += String((int)lastCurrentEst_mA);
+      s += "\"estimated_ma\":"; s += String((int)lastCurrentEst_mA); s += ",";
+      // 限流前（请求亮度下）的估计与是否正在限流
+      s += "\"requested_ma\":"; s += String(ctrl.canvas().power().requested_mA(), 0); s += ",";
+      s += "\"limited\":"; s += ctrl.canvas().power().limited()?"true":"false"; s += ",";
+      s += "\"wh\":"; s += String(ctrl.canvas().power().Wh(), 3);
+    s += "},";
+    // 帧统计：tick 次数、重新渲染的帧、实际发送到灯带的帧（画面不变时跳过发送）
+    s += "\"frames\":"; appendFrameStats(s, ctrl); s += ",";
+    // 输出通道：每条灯带的引脚、长度、颜色顺序、是否反向与逻辑起点
+    s += "\"strips\":[";
+    for (uint8_t i = 0; i < ctrl.canvas().channelCount(); i++) {
+      const EnhancedLEDCanvas::Channel& ch = ctrl.canvas().channel(i);
+      if (i) s += ",";
+      s += "{\"pin\":"; s += String((int)ch.config.pin); s += ",";
+      s += "\"length\":"; s += String((int)ch.config.length); s += ",";
+      s += "\"order\":\""; s += EnhancedLEDCanvas::orderName(ch.config.order); s += "\",";
+      s += "\"reversed\":"; s += ch.config.reversed ? "true" : "false"; s += ",";
+      s += "\"offset\":"; s += String((int)ch.offset); s += "}";
+    }
+    s += "],";
+    // 输出级：伽马校正、时间抖动开关，以及抖动是否仍在进行（静止画面也在逐帧发送）
+    s += "\"output\":{";
+      s += "\"gamma\":"; s += ctrl.canvas().output().gamma()?"true":"false"; s += ",";
+      s += "\"dither\":"; s += ctrl.canvas().output().dither()?"true":"false"; s += ",";
+      s += "\"dithering\":"; s += ctrl.canvas().output().dithering()?"true":"false";
     s += "},";
     s += "\"flow\":{";
       s += "\"running\":"; s += ctrl.flow().running()?"true":"false"; s += ",";
@@ -372,7 +571,51 @@ poll();
     s += "},";
     s += "\"audio\":{";
       s += "\"enabled\":"; s += ctrl.audioEnabled()?"true":"false"; s += ",";
-      s += "\"mode\":"; s += String((int)ctrl.getAudioMode());
+      s += "\"mode\":"; s += String((int)ctrl.getAudioMode()); s += ",";
+      AudioFeatures f;
+      bool haveFeatures = analyzer.readFeatures(f);
+      s += "\"bands\":[";
+      for (uint8_t i = 0; i < f.bandCount; i++) { if (i) s += ","; s += String((int)f.bands[i]); }
+      s += "],";
+      // 色度与主音/调性（仅在 Pitch Color 等效果需要色度时计算）
+      s += "\"chroma\":[";
+      for (uint8_t i = 0; i < 12; i++) { if (i) s += ","; s += String((int)f.chroma[i]); }
+      s += "],";
+      s += "\"note\":\""; s += AudioFeatures::noteName(f.note); s += "\",";
+      s += "\"note_conf\":"; s += String(f.noteConf,2); s += ",";
+      s += "\"key\":\""; s += AudioFeatures::keyName(f.key); s += "\",";
+      s += "\"key_conf\":"; s += String(f.keyConf,2); s += ",";
+      // 快照年龄：分析任务停止或卡住时持续增大；-1 表示尚未发布过
+      s += "\"snapshot_age_ms\":"; s += haveFeatures ? String((long)((micros() - f.timestampUs) / 1000)) : String("-1"); s += ",";
+      // 按需计算：本快照计算了哪些特征，以及各阶段因无人需要而跳过的累计次数
+      s += "\"demand\":"; s += String((int)f.demand); s += ",";
+      s += "\"skipped\":{";
+      uint32_t skippedTotal = 0;
+      for (uint8_t i = 0; i < AudioFeatures::STAGE_COUNT; i++) {
+        s += "\""; s += AudioFeatures::stageName(i); s += "\":"; s += String((unsigned long)f.skipped[i]); s += ",";
+        skippedTotal += f.skipped[i];
+      }
+      s += "\"total\":"; s += String((unsigned long)skippedTotal);
+      s += "},";
+      // 自动增益：当前增益、总电平底噪（满量程RMS为 1）、直流偏置、各段底噪（0..255）
+      s += "\"agc\":{";
+        s += "\"enabled\":"; s += f.agc?"true":"false"; s += ",";
+        s += "\"gain\":"; s += String(f.agcGain,2); s += ",";
+        s += "\"gain_db\":"; s += String(20.0f*log10f(f.agcGain),1); s += ",";
+        s += "\"floor\":"; s += String(f.noiseFloor,4); s += ",";
+        s += "\"dc\":"; s += String(f.dcOffset,1); s += ",";
+        s += "\"band_floor\":[";
+        for (uint8_t i = 0; i < f.bandCount; i++) { if (i) s += ","; s += String((int)f.bandFloor[i]); }
+        s += "]";
+      s += "},";
+      s += "\"task\":{";
+        s += "\"active\":"; s += audioTask.active()?"true":"false"; s += ",";
+        s += "\"period_ms\":"; s += String((unsigned long)audioTask.periodMs()); s += ",";
+        s += "\"cycles\":"; s += String((unsigned long)audioTask.cycles()); s += ",";
+        s += "\"overruns\":"; s += String((unsigned long)audioTask.overruns()); s += ",";
+        s += "\"last_us\":"; s += String((unsigned long)audioTask.lastCycleUs()); s += ",";
+        s += "\"max_us\":"; s += String((unsigned long)audioTask.maxCycleUs());
+      s += "}";
     s += "},";
     s += "\"tcm\":"; s += gTcmMode?"true":"false"; s += ",";
     s += "\"pitchmap\":{";
@@ -400,27 +643,44 @@ poll();
 
   // removed flow config and point endpoints
 
-  server.on("/api/brightness", HTTP_GET, [&]()
-            {
-    if (!server.hasArg("value")) { sendJson(server, 400, "{\"ok\":false,\"error\":\"value required\"}"); return; }
-    int v = server.arg("value").toInt();
-    if (v < 0) v = 0; if (v > 255) v = 255;
-    gBrightness = (uint8_t)v;
-    sendJson(server, 200, String("{\"ok\":true,\"brightness\":") + String((int)gBrightness) + "}"); });
-
-  server.on("/api/power", HTTP_GET, [&]()
+  // 图层混合：/api/layer?layer=flow|audio|point&blend=alpha|add|max|multiply&opacity=0..255，不带参数时返回全部图层
+  server.on("/api/layer", HTTP_GET, [&]()
             {
-    bool changed = false;
-    if (server.hasArg("limit_ma")) { int v = server.arg("limit_ma").toInt(); if (v<0) v=0; if (v>100000) v=100000; powerLimit_mA = (uint16_t)v; changed = true; }
-    if (server.hasArg("led_full_ma")) { int v = server.arg("led_full_ma").toInt(); if (v<=0) v=60; if (v>120) v=120; ledFull_mA = (uint8_t)v; changed = true; }
-    String s = "{";
-    s += "\"ok\":true,\"changed\":"; s += changed?"true":"false"; s += ",";
-    s += "\"limit_ma\":"; s += String((int)powerLimit_mA); s += ",";
-    s += "\"led_full_ma\":"; s += String((int)ledFull_mA); s += ",";
-    s += "\"estimated_ma\":"; s += String((int)lastCurrentEst_mA);
-    s += "}";
+    EnhancedLEDEffect* effs[3] = { &ctrl.flow(), &ctrl.audioEffect(), &ctrl.point() };
+    const char* names[3] = { "flow", "audio", "point" };
+    if (server.hasArg("layer")) {
+      String which = server.arg("layer");
+      int li = -1;
+      for (int i = 0; i < 3; i++) if (which == names[i]) li = i;
+      if (li < 0) { sendJson(server, 400, "{\"ok\":false,\"error\":\"layer must be flow|audio|point\"}"); return; }
+      EnhancedLEDLayer::BlendMode m = effs[li]->layer().blendMode();
+      if (server.hasArg("blend")) {
+        String b = server.arg("blend");
+        if (b == "alpha") m = EnhancedLEDLayer::BLEND_ALPHA;
+        else if (b == "add") m = EnhancedLEDLayer::BLEND_ADD;
+        else if (b == "max") m = EnhancedLEDLayer::BLEND_MAX;
+        else if (b == "multiply") m = EnhancedLEDLayer::BLEND_MULTIPLY;
+        else { sendJson(server, 400, "{\"ok\":false,\"error\":\"blend must be alpha|add|max|multiply\"}"); return; }
+      }
+      int op = effs[li]->layer().opacity();
+      if (server.hasArg("opacity")) { op = server.arg("opacity").toInt(); if (op < 0) op = 0; if (op > 255) op = 255; }
+      effs[li]->setBlend(m, (uint8_t)op);
+    }
+    String s = "{\"ok\":true,\"layers\":[";
+    for (int i = 0; i < 3; i++) {
+      const EnhancedLEDLayer& l = effs[i]->layer();
+      if (i) s += ",";
+      s += "{\"name\":\""; s += names[i]; s += "\",";
+      s += "\"blend\":\""; s += EnhancedLEDLayer::blendName(l.blendMode()); s += "\",";
+      s += "\"opacity\":"; s += String((int)l.opacity()); s += ",";
+      s += "\"lo\":"; s += String((int)l.lo()); s += ",";
+      s += "\"hi\":"; s += String((int)l.hi()); s += "}";
+    }
+    s += "]}";
     sendJson(server, 200, s); });
 
+  registerOutputRoutes(server, ctrl, gBrightness, powerLimit_mA, ledFull_mA, lastCurrentEst_mA);
+
   // Noise handlers
   server.on("/favicon.ico", HTTP_GET, [&server]()
             { server.send(204); });
@@ -438,3 +698,91 @@ poll();
   server.begin();
   Serial.printf("HTTP server started on %s\n", WiFi.softAPIP().toString().c_str());
 }
+
+// 录音与回放：/api/audio/capture
+//   record=1&seconds=10&file=/rec.wav  开始录音（1..30 秒，写入 SPIFFS）；record=0 立即停止
+//   replay=1&file=/rec.wav&realtime=1&loop=0  用录音替换麦克风输入；replay=0 回到实时输入
+//   不带参数时只返回状态
+inline void registerAudioCaptureRoutes(WebServer &server, CaptureSource &capture)
+{
+  server.on("/api/audio/capture", HTTP_GET, [&server, &capture]()
+            {
+    String file = server.hasArg("file") ? server.arg("file") : String("/rec.wav");
+    if (!file.startsWith("/")) { sendJson(server,400,"{\"ok\":false,\"error\":\"file must start with /\"}"); return; }
+
+    if (server.hasArg("record")) {
+      if (server.arg("record").toInt() != 0) {
+        int seconds = server.hasArg("seconds") ? server.arg("seconds").toInt() : 10;
+        seconds = constrain(seconds, 1, 30); // 8kHz 16 位约 16KB/s，30 秒约占 480KB SPIFFS
+        if (!capture.startRecording(file.c_str(), (uint32_t)seconds * capture.sampleRate())) {
+          sendJson(server,500,"{\"ok\":false,\"error\":\"cannot open file\"}"); return;
+        }
+      } else {
+        capture.stopRecording();
+      }
+    }
+    if (server.hasArg("replay")) {
+      bool ok;
+      if (server.arg("replay").toInt() != 0) {
+        bool realtime = !server.hasArg("realtime") || server.arg("realtime").toInt() != 0;
+        bool loop = server.hasArg("loop") && server.arg("loop").toInt() != 0;
+        ok = capture.startReplay(file.c_str(), realtime, loop);
+      } else {
+        ok = capture.stopReplay();
+      }
+      if (!ok) { sendJson(server,409,"{\"ok\":false,\"error\":\"previous switch pending\"}"); return; }
+    }
+
+    // 回放切换在分析任务下一次读取样本时生效，文件无效时 replay 为 failed
+    const char *replay = capture.replaying() ? "replay" : capture.replayFinished() ? "finished" : capture.replayFailed() ? "failed" : "live";
+    String s = "{\"ok\":true,";
+    s += "\"recording\":"; s += capture.recording()?"true":"false"; s += ",";
+    s += "\"recorded\":"; s += String((unsigned long)capture.recordedSamples()); s += ",";
+    s += "\"record_dropped\":"; s += String((unsigned long)capture.recordDropped()); s += ",";
+    s += "\"replay\":\""; s += replay; s += "\",";
+    s += "\"pending\":"; s += capture.requestPending()?"true":"false";
+    s += "}";
+    sendJson(server,200,s); });
+}
+
+// 帧调度：/api/frame
+//   fps=60            设置目标帧率（1..500）
+//   deadline_us=8000  设置单帧渲染期限，0 回到帧周期
+//   不带参数时只返回统计：实际帧率、帧耗时百分位（最近约 2 秒）、超期与丢弃的帧、各作业耗时
+inline void registerFrameRoutes(WebServer &server, FrameScheduler &scheduler)
+{
+  server.on("/api/frame", HTTP_GET, [&server, &scheduler]()
+            {
+    if (server.hasArg("fps")) {
+      int fps = server.arg("fps").toInt();
+      if (fps < 1 || fps > 500) { sendJson(server,400,"{\"ok\":false,\"error\":\"fps must be 1..500\"}"); return; }
+      scheduler.setTargetFps((uint16_t)fps);
+    }
+    if (server.hasArg("deadline_us")) scheduler.setDeadlineUs((uint32_t)server.arg("deadline_us").toInt());
+
+    const FrameScheduler::Stats &st = scheduler.stats();
+    String s = "{\"ok\":true,";
+    s += "\"target_fps\":"; s += String((unsigned)scheduler.targetFps()); s += ",";
+    s += "\"fps\":"; s += String(st.fps, 1); s += ",";
+    s += "\"deadline_us\":"; s += String((unsigned long)scheduler.deadlineUs()); s += ",";
+    s += "\"frame_us\":{";
+      s += "\"p50\":"; s += String((unsigned long)st.p50Us); s += ",";
+      s += "\"p95\":"; s += String((unsigned long)st.p95Us); s += ",";
+      s += "\"p99\":"; s += String((unsigned long)st.p99Us); s += ",";
+      s += "\"max\":"; s += String((unsigned long)st.maxUs);
+    s += "},";
+    s += "\"max_late_us\":"; s += String((unsigned long)st.maxLateUs); s += ",";
+    s += "\"frames\":"; s += String((unsigned long)st.frames); s += ",";
+    s += "\"missed\":"; s += String((unsigned long)st.missed); s += ",";
+    s += "\"skipped\":"; s += String((unsigned long)st.skipped); s += ",";
+    s += "\"jobs\":[";
+    for (uint8_t i = 0; i < scheduler.jobCount(); i++) {
+      if (i) s += ",";
+      s += "{\"name\":\""; s += scheduler.jobName(i); s += "\",";
+      s += "\"enabled\":"; s += scheduler.jobEnabled(i)?"true":"false"; s += ",";
+      s += "\"last_us\":"; s += String((unsigned long)scheduler.jobLastUs(i)); s += ",";
+      s += "\"max_us\":"; s += String((unsigned long)scheduler.jobMaxUs(i)); s += "}";
+    }
+    s += "]}";
+    sendJson(server,200,s); });
+}
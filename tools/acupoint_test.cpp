@@ -0,0 +1,125 @@
+/**
+ * 穴位与灯珠映射的主机端测试
+ *
+ * 用 tools/host 下的 SPIFFS/ArduinoJson 兼容层按设备路径加载 data/ 里的经络配置（TCMMeridianSystem::initFromConfig），
+ * 再用内置经络表（initMeridians + initAcupoints）各跑一遍，检查：
+ *   - 有灯珠的穴位（mapped()）都落在所属经络的区间内，且不超出灯带
+ *   - 未启用经络上的配置穴位（随仓库的配置只启用肺经，足三里在胃经）仍能按英文名、中文名查到，
+ *     但没有灯珠，blinkAcupoint 返回 false；内置的同名示意穴位不会顶替它
+ *   - 局部索引超出经络长度的穴位同样没有灯珠，不会落到相邻经络上
+ *   - 有灯珠的穴位能正常闪烁
+ *   - 经络渐亮（showMeridian 带 fade，/api/show?fade=）：未启用的经络没有灯珠、返回 false，动画队列满时返回 false
+ * 任一检查失败时返回 1。
+ *
+ * 编译（仓库根目录）：
+ *   g++ -O2 -std=gnu++11 -Itools/host -Isrc tools/acupoint_test.cpp src/meridian_tcm.cpp -o acupoint_test
+ *
+ * 用法：
+ *   acupoint_test [DATA_DIR]     配置文件所在目录，默认 data
+ */
+#include <Arduino.h>
+#include "meridian_tcm.hpp"
+
+static const uint16_t NUM_LEDS = 160; // 与 LED_CAPACITY 一致
+static CRGB leds[NUM_LEDS];
+static unsigned failed = 0;
+
+static void check(bool ok, const char* what) {
+  printf("  %-64s %s\n", what, ok ? "ok" : "FAIL");
+  if (!ok) failed++;
+}
+
+// 所有有灯珠的穴位都在所属经络区间内；返回没有灯珠的穴位个数
+static size_t checkLayout(const TCMMeridianSystem& sys, const char* label) {
+  size_t unmapped = 0, outside = 0;
+  for (const auto& ap : sys.getAcupoints()) {
+    if (!ap.mapped()) {
+      unmapped++;
+      continue;
+    }
+    bool inside = false;
+    for (const auto& m : sys.getMeridians()) {
+      if (m.type != ap.meridian) continue;
+      inside = ap.globalIndex >= m.startIndex && ap.globalIndex < m.startIndex + m.length && ap.globalIndex < NUM_LEDS &&
+               ap.globalIndex == m.startIndex + ap.localIndex;
+      break;
+    }
+    if (!inside) {
+      outside++;
+      printf("    %s: %s led %u local %u outside its meridian\n", label, ap.name, (unsigned)ap.globalIndex,
+             (unsigned)ap.localIndex);
+    }
+  }
+  printf("  %s: %u acupoints, %u without an LED\n", label, (unsigned)sys.getAcupoints().size(), (unsigned)unmapped);
+  check(outside == 0, "mapped acupoints lie inside their own meridian");
+  return unmapped;
+}
+
+static void testConfig() {
+  printf("config (%s/meridians*.json, %u LEDs)\n", SPIFFS.root, (unsigned)NUM_LEDS);
+  TCMMeridianSystem sys(leds, NUM_LEDS);
+  bool loaded = sys.initFromConfig();
+  check(loaded, "initFromConfig");
+  if (!loaded) return;
+
+  size_t unmapped = checkLayout(sys, "config");
+  check(unmapped > 0, "acupoints on disabled meridians are kept without an LED");
+
+  // 胃经在配置中未启用：足三里保留供查询，但不能闪到肺经的灯珠上
+  const AcupointInfo* zusanli = sys.findAcupoint("Zusanli");
+  check(zusanli != nullptr && zusanli == sys.findAcupoint("足三里"), "Zusanli is found by name and Chinese name");
+  if (zusanli) {
+    check(zusanli->meridian == STOMACH && !zusanli->mapped(), "Zusanli (disabled stomach meridian) has no LED");
+    check(!sys.blinkAcupoint(*zusanli), "blinkAcupoint(Zusanli) returns false");
+    check(zusanli->location && zusanli->location[0], "Zusanli keeps the configured details");
+  }
+  check(!sys.blinkAcupoint("Zusanli"), "blinkAcupoint(\"Zusanli\") returns false");
+
+  // 启用的肺经上的穴位照常闪烁
+  const AcupointInfo* lung = nullptr;
+  for (const auto& ap : sys.getAcupoints()) {
+    if (ap.meridian == LUNG && ap.mapped()) {
+      lung = &ap;
+      break;
+    }
+  }
+  check(lung != nullptr && sys.blinkAcupoint(*lung), "acupoint on the enabled lung meridian blinks");
+  sys.stopFlow();
+
+  // 经络渐亮：胃经没有灯珠，肺经可以；队列占满后渐亮入队失败
+  check(!sys.meridianHasLeds(STOMACH) && !sys.showMeridian(STOMACH, 500), "fading in the disabled stomach meridian fails");
+  check(sys.meridianHasLeds(LUNG) && sys.showMeridian(LUNG, 500), "fading in the lung meridian is queued");
+  // 同一经络的新渐亮会先结束旧的、腾出槽位，所以先清空队列，再用闪烁占满
+  sys.stopFlow();
+  uint16_t blinks = 0;
+  for (const auto& ap : sys.getAcupoints()) {
+    if (ap.mapped() && sys.blinkAcupoint(ap, 50)) blinks++;
+  }
+  check(blinks > 0 && !sys.showMeridian(LUNG, 500), "fade is refused while the animation queue is full");
+  sys.stopFlow();
+}
+
+static void testBuiltin(uint16_t numLeds) {
+  printf("built-in layout (%u LEDs)\n", (unsigned)numLeds);
+  TCMMeridianSystem sys(leds, numLeds);
+  sys.initMeridians();
+  sys.initAcupoints();
+  checkLayout(sys, "built-in");
+
+  // 均分后肺经只有 numLeds/12 左右颗灯，局部索引 27 的示意穴位不应落到后面的经络上
+  const AcupointInfo* far = sys.findAcupoint("Lung Meridian_point_27");
+  check(far != nullptr && !far->mapped() && !sys.blinkAcupoint(*far), "lung point 27 beyond the meridian has no LED");
+
+  const AcupointInfo* zusanli = sys.findAcupoint("Zusanli");
+  check(zusanli != nullptr && zusanli->mapped() && sys.blinkAcupoint(*zusanli), "built-in Zusanli blinks");
+  sys.stopFlow();
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) SPIFFS.root = argv[1];
+  testConfig();
+  testBuiltin(NUM_LEDS);
+  testBuiltin(24);
+  printf("# %u checks failed\n", failed);
+  return failed ? 1 : 0;
+}
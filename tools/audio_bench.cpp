@@ -0,0 +1,164 @@
+/**
+ * 音频分析主机端基准程序
+ *
+ * 用录音文件（设备端 /api/audio/capture 录下的 WAV，或本程序生成的合成录音）驱动
+ * OptimizedAudioAnalyzer，输出逐帧特征轨迹与分阶段耗时，用于复现音频相关问题和回归对比。
+ *
+ * 编译（仓库根目录）：
+ *   g++ -O2 -std=gnu++11 -DAUDIO_STAGE_PROFILE=1 -Itools/host -Isrc tools/audio_bench.cpp -o audio_bench
+ *
+ * 用法：
+ *   audio_bench record <out.wav> [--tone HZ] [--amp A] [--noise A] [--seconds S]
+ *   audio_bench replay <in.wav> [--demand all|level,bands,spectrum,onset,pitch,chroma] [--window N] [--hop N]
+ *                               [--pitch yin|acf] [--target HZ] [--tol CENTS] [--agc 0|1] [--trace] [--realtime]
+ *
+ * --trace 时每个分析帧输出一行 CSV（stdout），汇总以 # 开头。
+ */
+#include <Arduino.h>
+#include <stdlib.h>
+#include "optimized_audio.hpp"
+#include "audio_capture.hpp"
+
+static const char* argValue(int argc, char** argv, const char* name, const char* def) {
+  for (int i = 3; i < argc - 1; i++) {
+    if (strcmp(argv[i], name) == 0) return argv[i + 1];
+  }
+  return def;
+}
+
+static bool argFlag(int argc, char** argv, const char* name) {
+  for (int i = 3; i < argc; i++) {
+    if (strcmp(argv[i], name) == 0) return true;
+  }
+  return false;
+}
+
+static uint8_t parseDemand(const char* s) {
+  if (strcmp(s, "all") == 0) return AudioFeatures::FEAT_ALL;
+  static const struct { const char* name; uint8_t bit; } names[] = {
+    {"level", AudioFeatures::FEAT_LEVEL}, {"bands", AudioFeatures::FEAT_BANDS},
+    {"spectrum", AudioFeatures::FEAT_SPECTRUM}, {"onset", AudioFeatures::FEAT_ONSET},
+    {"pitch", AudioFeatures::FEAT_PITCH}, {"chroma", AudioFeatures::FEAT_CHROMA},
+  };
+  uint8_t mask = 0;
+  for (const char* p = s; *p;) {
+    const char* end = strchr(p, ',');
+    size_t len = end ? (size_t)(end - p) : strlen(p);
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+      if (strlen(names[i].name) == len && strncmp(p, names[i].name, len) == 0) mask |= names[i].bit;
+    }
+    p += len + (end ? 1 : 0);
+  }
+  return mask;
+}
+
+// 合成信号经 CaptureSource 录成 WAV，与设备端录音走同一条路径
+static int record(int argc, char** argv) {
+  SyntheticSampleSource synth(8000);
+  synth.setTone((float)atof(argValue(argc, argv, "--tone", "440")), (float)atof(argValue(argc, argv, "--amp", "600")));
+  synth.setNoise((float)atof(argValue(argc, argv, "--noise", "20")));
+  synth.begin();
+  uint32_t total = (uint32_t)(atof(argValue(argc, argv, "--seconds", "5")) * synth.sampleRate());
+
+  CaptureSource capture;
+  capture.attach(&synth);
+  if (!capture.startRecording(argv[2], total)) {
+    fprintf(stderr, "cannot create %s\n", argv[2]);
+    return 1;
+  }
+  int16_t buf[256];
+  while (capture.recording()) {
+    capture.read(buf, 256);
+    capture.service();
+  }
+  printf("# recorded %u samples to %s\n", (unsigned)capture.recordedSamples(), argv[2]);
+  return 0;
+}
+
+static int replay(int argc, char** argv) {
+  static ReplaySource src;
+  if (!src.open(argv[2])) {
+    fprintf(stderr, "cannot open %s (16-bit mono WAV expected)\n", argv[2]);
+    return 1;
+  }
+  // 设备录音的文件头是实测采样率，分析器按它换算频率；只接受标称 8kHz 附近的文件
+  if (src.sampleRate() < 7600 || src.sampleRate() > 8400) {
+    fprintf(stderr, "%s: sample rate %u, analyzer expects 8000 +/-5%%\n", argv[2], (unsigned)src.sampleRate());
+    return 1;
+  }
+  src.setRealtime(argFlag(argc, argv, "--realtime"));
+  src.setLoop(false);
+
+  static OptimizedAudioAnalyzer analyzer(0);
+  analyzer.setSource(&src);
+  if (!analyzer.setWindow((uint16_t)atoi(argValue(argc, argv, "--window", "128")), (uint16_t)atoi(argValue(argc, argv, "--hop", "32")))) {
+    fprintf(stderr, "invalid --window/--hop\n");
+    return 1;
+  }
+  if (strcmp(argValue(argc, argv, "--pitch", "yin"), "acf") == 0) analyzer.setPitchMethod(OptimizedAudioAnalyzer::PITCH_ACF);
+  uint8_t demand = parseDemand(argValue(argc, argv, "--demand", "all"));
+  analyzer.setDemand(OptimizedAudioAnalyzer::CONSUMER_EFFECT, demand);
+  float target = (float)atof(argValue(argc, argv, "--target", "0"));
+  if (target > 0) analyzer.setPitchMatch(true, target, (float)atof(argValue(argc, argv, "--tol", "50")));
+  analyzer.setAgc(atoi(argValue(argc, argv, "--agc", "1")) != 0);
+  analyzer.begin();
+
+  bool trace = argFlag(argc, argv, "--trace");
+  if (trace) printf("frame,t_s,level,low,mid,high,pitch_hz,pitch_conf,beats,bpm,beat_phase,pitch_hits,gain,floor,note,key,bands\n");
+
+  uint32_t t0 = micros();
+  for (;;) {
+    bool analyzed = analyzer.tick();
+    if (!analyzed) {
+      if (src.finished()) break;
+      continue;
+    }
+    if (!trace) continue;
+    AudioFeatures f;
+    analyzer.readFeatures(f);
+    printf("%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.2f,%.3f,%u,%.1f,%.3f,%u,%.3f,%.5f,%s,%s,",
+           (unsigned)f.frames, (double)src.delivered() / src.sampleRate(), f.level, f.low, f.mid, f.high,
+           f.pitchHz, f.pitchConf, (unsigned)f.beatCount, f.bpm, f.beatPhase, (unsigned)f.pitchHits,
+           f.agcGain, f.noiseFloor, AudioFeatures::noteName(f.note), AudioFeatures::keyName(f.key));
+    for (uint8_t b = 0; b < f.bandCount; b++) printf(b ? " %u" : "%u", (unsigned)f.bands[b]);
+    printf("\n");
+  }
+  uint32_t wallUs = micros() - t0;
+
+  AudioFeatures f;
+  analyzer.readFeatures(f);
+  double audioS = (double)src.delivered() / src.sampleRate();
+  printf("# file=%s samples=%u audio=%.2fs frames=%u wall=%.1fms (%.0fx realtime) demand=0x%02x\n",
+         argv[2], (unsigned)src.delivered(), audioS, (unsigned)f.frames, wallUs / 1000.0,
+         wallUs ? audioS * 1e6 / wallUs : 0.0, (unsigned)f.demand);
+  printf("# final level=%.3f pitch=%.1fHz conf=%.2f beats=%u bpm=%.1f pitch_hits=%u note=%s key=%s (%.2f)\n",
+         f.level, f.pitchHz, f.pitchConf, (unsigned)f.beatCount, f.bpm, (unsigned)f.pitchHits,
+         AudioFeatures::noteName(f.note), AudioFeatures::keyName(f.key), f.keyConf);
+  printf("# sample_rate file=%u analysis=%.2f\n", (unsigned)src.sampleRate(), f.sampleRate);
+  printf("# agc=%s gain=%.2f (%.1fdB) floor=%.5f dc=%.1f\n", f.agc ? "on" : "off", f.agcGain,
+         20.0 * log10(f.agcGain), f.noiseFloor, f.dcOffset);
+#if AUDIO_STAGE_PROFILE
+  printf("# %-9s %8s %10s %8s %10s %8s\n", "stage", "runs", "mean_us", "max_us", "total_ms", "skipped");
+  for (uint8_t i = 0; i < OptimizedAudioAnalyzer::PROFILE_SLOTS; i++) {
+    const OptimizedAudioAnalyzer::StageProfile& p = analyzer.stageProfile(i);
+    unsigned skipped = i < AudioFeatures::STAGE_COUNT ? (unsigned)f.skipped[i] : 0;
+    printf("# %-9s %8u %10.2f %8u %10.2f %8u\n", OptimizedAudioAnalyzer::profileName(i), (unsigned)p.runs,
+           p.runs ? (double)p.totalUs / p.runs : 0.0, (unsigned)p.maxUs, p.totalUs / 1000.0, skipped);
+  }
+#else
+  printf("# build with -DAUDIO_STAGE_PROFILE=1 for per-stage timings\n");
+#endif
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 3 && strcmp(argv[1], "record") == 0) return record(argc, argv);
+  if (argc >= 3 && strcmp(argv[1], "replay") == 0) return replay(argc, argv);
+  fprintf(stderr,
+          "usage:\n"
+          "  %s record <out.wav> [--tone HZ] [--amp A] [--noise A] [--seconds S]\n"
+          "  %s replay <in.wav> [--demand all|level,bands,spectrum,onset,pitch,chroma] [--window N] [--hop N]\n"
+          "                     [--pitch yin|acf] [--target HZ] [--tol CENTS] [--agc 0|1] [--trace] [--realtime]\n",
+          argv[0], argv[0]);
+  return 2;
+}
@@ -0,0 +1,230 @@
+/**
+ * 定点 FFT 主机端基准程序
+ *
+ * 对比 FixedRealFFT（Q15，分析器默认后端）与 ArduinoFFT（double，AUDIO_FIXED_POINT_FFT=0 时的后端）
+ * 在同一帧输入上的幅度谱误差与每帧耗时。输入为分析器看到的去直流 ADC 计数：
+ * 不同幅度的正弦（含接近量化噪声的小信号）、双音与白噪声，窗口 128/256/512。
+ *
+ * 误差按每帧最强 bin 归一：先求两者之间的最小二乘比例（窗函数系数不同只体现为比例偏离 1），
+ * 再报告扣除比例后的最大/均方根误差（dB，相对峰值）与峰值 bin 是否一致。
+ *
+ * ArduinoFFT 不随仓库提供：编译时把库的 src 目录加入 -I 即直接对比库本身；找不到 arduinoFFT.h 时
+ * 使用本文件中按 ArduinoFFT 1.x 算法（对称窗、位反转、递推旋转因子的基 2 蝶形、开方求幅度）写的 double 参考实现。
+ * 主机有硬件浮点，double 的耗时远低于 ESP32-C3 上的软件模拟，耗时一列只用于定点实现自身的回归对比。
+ *
+ * 编译（仓库根目录）：
+ *   g++ -O2 -std=gnu++11 -Itools/host -Isrc tools/fft_bench.cpp -o fft_bench
+ *   g++ -O2 -std=gnu++11 -Itools/host -Isrc -I<ArduinoFFT>/src tools/fft_bench.cpp -o fft_bench   # 对比库本身
+ *
+ * 用法：
+ *   fft_bench [ITERATIONS]     每种输入的计时次数，默认 2000
+ */
+#include <Arduino.h>
+#include <stdlib.h>
+#include "fixed_fft.hpp"
+
+#if defined(__has_include)
+#if __has_include(<arduinoFFT.h>)
+#include <arduinoFFT.h>
+#define HAVE_ARDUINO_FFT 1
+#endif
+#endif
+
+#ifndef HAVE_ARDUINO_FFT
+#define FFT_FORWARD 0x01
+#define FFT_WIN_TYP_HANN 0x02
+
+// ArduinoFFT 1.x 接口与算法的 double 参考实现（只含分析器用到的三个调用）
+class arduinoFFT {
+public:
+  arduinoFFT(double* vReal, double* vImag, uint16_t samples, double samplingFrequency)
+    : vReal_(vReal), vImag_(vImag), samples_(samples) {
+    (void)samplingFrequency;
+    power_ = 0;
+    while ((1u << power_) < samples_) power_++;
+  }
+
+  void Windowing(uint8_t windowType, uint8_t dir) {
+    (void)windowType;
+    (void)dir;
+    double samplesMinusOne = (double)samples_ - 1.0;
+    for (uint16_t i = 0; i < (samples_ >> 1); i++) {
+      double w = 0.5 * (1.0 - cos(2.0 * M_PI * (double)i / samplesMinusOne));
+      vReal_[i] *= w;
+      vReal_[samples_ - (i + 1)] *= w;
+    }
+  }
+
+  void Compute(uint8_t dir) {
+    uint16_t j = 0;
+    for (uint16_t i = 0; i < samples_ - 1; i++) {
+      if (i < j) {
+        swap(vReal_[i], vReal_[j]);
+        swap(vImag_[i], vImag_[j]);
+      }
+      uint16_t k = samples_ >> 1;
+      while (k <= j) {
+        j -= k;
+        k >>= 1;
+      }
+      j += k;
+    }
+    double c1 = -1.0, c2 = 0.0;
+    uint16_t l2 = 1;
+    for (uint8_t l = 0; l < power_; l++) {
+      uint16_t l1 = l2;
+      l2 <<= 1;
+      double u1 = 1.0, u2 = 0.0;
+      for (j = 0; j < l1; j++) {
+        for (uint16_t i = j; i < samples_; i += l2) {
+          uint16_t i1 = i + l1;
+          double t1 = u1 * vReal_[i1] - u2 * vImag_[i1];
+          double t2 = u1 * vImag_[i1] + u2 * vReal_[i1];
+          vReal_[i1] = vReal_[i] - t1;
+          vImag_[i1] = vImag_[i] - t2;
+          vReal_[i] += t1;
+          vImag_[i] += t2;
+        }
+        double z = u1 * c1 - u2 * c2;
+        u2 = u1 * c2 + u2 * c1;
+        u1 = z;
+      }
+      c2 = sqrt((1.0 - c1) / 2.0);
+      if (dir == FFT_FORWARD) c2 = -c2;
+      c1 = sqrt((1.0 + c1) / 2.0);
+    }
+  }
+
+  void ComplexToMagnitude() {
+    for (uint16_t i = 0; i < samples_; i++) vReal_[i] = sqrt(vReal_[i] * vReal_[i] + vImag_[i] * vImag_[i]);
+  }
+
+private:
+  static void swap(double& a, double& b) {
+    double t = a;
+    a = b;
+    b = t;
+  }
+
+  double* vReal_;
+  double* vImag_;
+  uint16_t samples_;
+  uint8_t power_;
+};
+#endif
+
+static const uint16_t MAX_N = 512;
+static const uint32_t FS = 8000;
+static volatile uint32_t sink;
+
+struct Signal {
+  const char* name;
+  float hz1, amp1, hz2, amp2, noise;
+};
+
+// 幅度为 ADC 计数（12 位，满量程 ±2048）
+static const Signal SIGNALS[] = {
+  {"sine 440Hz a=1500", 440.0f, 1500.0f, 0.0f, 0.0f, 0.0f},
+  {"sine 440Hz a=200", 440.0f, 200.0f, 0.0f, 0.0f, 0.0f},
+  {"sine 440Hz a=20", 440.0f, 20.0f, 0.0f, 0.0f, 0.0f},
+  {"sine 1234Hz a=600", 1234.0f, 600.0f, 0.0f, 0.0f, 0.0f},
+  {"sine 3900Hz a=600", 3900.0f, 600.0f, 0.0f, 0.0f, 0.0f},
+  {"two-tone 220+2500Hz", 220.0f, 800.0f, 2500.0f, 40.0f, 0.0f},
+  {"tone 660Hz + noise", 660.0f, 400.0f, 0.0f, 0.0f, 30.0f},
+  {"white noise a=300", 0.0f, 0.0f, 0.0f, 0.0f, 300.0f},
+};
+
+static void synth(const Signal& s, int16_t* x, uint16_t n) {
+  uint32_t seed = 12345;
+  for (uint16_t i = 0; i < n; i++) {
+    seed = seed * 1103515245u + 12345u;
+    float r = (float)((seed >> 16) & 0x7FFF) / 16383.5f - 1.0f;
+    float t = (float)i / FS;
+    float v = s.amp1 * sinf(2.0f * (float)M_PI * s.hz1 * t + 0.3f) + s.amp2 * sinf(2.0f * (float)M_PI * s.hz2 * t) +
+              s.noise * r;
+    x[i] = (int16_t)lroundf(v);
+  }
+}
+
+int main(int argc, char** argv) {
+  uint32_t iterations = argc > 1 ? (uint32_t)atoi(argv[1]) : 2000;
+  if (iterations == 0) iterations = 1;
+
+#ifdef HAVE_ARDUINO_FFT
+  printf("# reference: ArduinoFFT library\n");
+#else
+  printf("# reference: built-in double implementation of the ArduinoFFT 1.x algorithm (arduinoFFT.h not found)\n");
+#endif
+  printf("# %-22s %5s %7s %9s %9s %6s %10s %10s %7s\n", "signal", "n", "scale", "max_dB", "rms_dB", "peak",
+         "fixed_us", "double_us", "ratio");
+
+  static FixedRealFFT<MAX_N> fixedFft;
+  static int16_t x[MAX_N];
+  static uint32_t fixedMag[MAX_N / 2];
+  static double vReal[MAX_N], vImag[MAX_N];
+
+  double worstMax = -200.0;
+  for (uint16_t n = 128; n <= MAX_N; n <<= 1) {
+    fixedFft.begin(n);
+    arduinoFFT refFft(vReal, vImag, n, FS);
+    const uint16_t bins = n / 2;
+    for (size_t s = 0; s < sizeof(SIGNALS) / sizeof(SIGNALS[0]); s++) {
+      synth(SIGNALS[s], x, n);
+
+      fixedFft.magnitude(x, fixedMag);
+      for (uint16_t i = 0; i < n; i++) {
+        vReal[i] = x[i];
+        vImag[i] = 0.0;
+      }
+      refFft.Windowing(FFT_WIN_TYP_HANN, FFT_FORWARD);
+      refFft.Compute(FFT_FORWARD);
+      refFft.ComplexToMagnitude();
+
+      // 最小二乘比例与扣除比例后的误差（bin 0 为直流，分析器不使用）
+      double num = 0.0, den = 0.0, peak = 0.0;
+      uint16_t refPeak = 1, fixedPeak = 1;
+      for (uint16_t k = 1; k < bins; k++) {
+        num += fixedMag[k] * vReal[k];
+        den += vReal[k] * vReal[k];
+        if (vReal[k] > peak) { peak = vReal[k]; refPeak = k; }
+        if (fixedMag[k] > fixedMag[fixedPeak]) fixedPeak = k;
+      }
+      double scale = den > 0.0 ? num / den : 1.0;
+      double maxErr = 0.0, sq = 0.0;
+      for (uint16_t k = 1; k < bins; k++) {
+        double e = fabs(fixedMag[k] - scale * vReal[k]);
+        if (e > maxErr) maxErr = e;
+        sq += e * e;
+      }
+      double ref = scale * peak;
+      double maxDb = 20.0 * log10(maxErr / ref + 1e-12);
+      double rmsDb = 20.0 * log10(sqrt(sq / (bins - 1)) / ref + 1e-12);
+      if (maxDb > worstMax) worstMax = maxDb;
+
+      uint32_t t0 = micros();
+      for (uint32_t it = 0; it < iterations; it++) {
+        fixedFft.magnitude(x, fixedMag);
+        sink += fixedMag[it % bins];
+      }
+      double fixedUs = (double)(micros() - t0) / iterations;
+      t0 = micros();
+      for (uint32_t it = 0; it < iterations; it++) {
+        for (uint16_t i = 0; i < n; i++) {
+          vReal[i] = x[i];
+          vImag[i] = 0.0;
+        }
+        refFft.Windowing(FFT_WIN_TYP_HANN, FFT_FORWARD);
+        refFft.Compute(FFT_FORWARD);
+        refFft.ComplexToMagnitude();
+        sink += (uint32_t)vReal[it % bins];
+      }
+      double refUs = (double)(micros() - t0) / iterations;
+
+      printf("  %-22s %5u %7.4f %9.1f %9.1f %6s %10.2f %10.2f %7.2f\n", SIGNALS[s].name, (unsigned)n, scale, maxDb,
+             rmsDb, refPeak == fixedPeak ? "same" : "DIFF", fixedUs, refUs, fixedUs > 0.0 ? refUs / fixedUs : 0.0);
+    }
+  }
+  printf("# worst max error %.1f dB re peak; timings are host-side (double has hardware FP here, not on ESP32-C3)\n",
+         worstMax);
+  return 0;
+}
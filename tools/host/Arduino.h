@@ -0,0 +1,50 @@
+#pragma once
+// 主机端最小 Arduino 兼容层：只提供音频分析与灯效头文件（optimized_audio.hpp、audio_visualizer.hpp 等）用到的部分，
+// 供 tools/ 下的基准程序在 Linux/macOS 上编译
+#include <stdint.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+
+inline unsigned long micros() {
+  static const auto start = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long millis() { return micros() / 1000; }
+
+template <typename T>
+inline T constrain(T x, T lo, T hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+struct HostSerial {
+  void begin(unsigned long) {}
+  __attribute__((format(printf, 2, 3))) int printf(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    return n;
+  }
+  void print(const char* s) { fputs(s, stderr); }
+  void print(size_t n) { fprintf(stderr, "%zu", n); }
+  void println(const char* s = "") { fprintf(stderr, "%s\n", s); }
+};
+
+static HostSerial Serial __attribute__((unused));
+
+// 只含经络配置加载（meridian_config.hpp）用到的几个方法
+class String {
+public:
+  String(const char* s = "") : s_(s ? s : "") {}
+  const char* c_str() const { return s_.c_str(); }
+  unsigned int length() const { return (unsigned int)s_.size(); }
+  bool startsWith(const char* prefix) const { return s_.compare(0, strlen(prefix), prefix) == 0; }
+
+private:
+  std::string s_;
+};
@@ -0,0 +1,242 @@
+#pragma once
+// 主机端最小 ArduinoJson 兼容层：递归下降解析整份 JSON 到内存树，只提供经络配置加载（meridian_config.hpp）
+// 用到的 ArduinoJson 6 接口——DynamicJsonDocument、deserializeJson(doc, File)、下标、as<T>()、containsKey
+// 与 JsonArray/JsonObject 的遍历。缺失的键与类型不符时同库一样返回 0/false/nullptr
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <stdlib.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct HostJsonValue {
+  enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } type = NUL;
+  bool b = false;
+  double num = 0.0;
+  std::string str;
+  std::vector<HostJsonValue> items;                              // ARRAY
+  std::vector<std::pair<std::string, HostJsonValue> > members;  // OBJECT（保持原顺序）
+
+  const HostJsonValue* member(const char* key) const {
+    if (type != OBJECT) return nullptr;
+    for (size_t i = 0; i < members.size(); i++) {
+      if (members[i].first == key) return &members[i].second;
+    }
+    return nullptr;
+  }
+};
+
+class JsonObject;
+
+class JsonVariant {
+public:
+  JsonVariant(const HostJsonValue* v = nullptr) : v_(v) {}
+
+  JsonVariant operator[](const char* key) const { return JsonVariant(v_ ? v_->member(key) : nullptr); }
+  bool containsKey(const char* key) const { return v_ && v_->member(key); }
+  bool isNull() const { return !v_ || v_->type == HostJsonValue::NUL; }
+
+  template <typename T>
+  T as() const;
+
+  const HostJsonValue* raw() const { return v_; }
+
+protected:
+  const HostJsonValue* v_;
+};
+
+template <typename T>
+inline T JsonVariant::as() const {
+  if (!v_) return T();
+  if (v_->type == HostJsonValue::NUMBER) return (T)v_->num;
+  if (v_->type == HostJsonValue::BOOL) return (T)v_->b;
+  return T();
+}
+template <>
+inline bool JsonVariant::as<bool>() const {
+  return v_ && v_->type == HostJsonValue::BOOL && v_->b;
+}
+template <>
+inline const char* JsonVariant::as<const char*>() const {
+  return v_ && v_->type == HostJsonValue::STRING ? v_->str.c_str() : nullptr;
+}
+template <>
+inline String JsonVariant::as<String>() const {
+  if (!v_ || v_->type != HostJsonValue::STRING) return String("null");
+  return String(v_->str.c_str());
+}
+
+class JsonObject : public JsonVariant {
+public:
+  JsonObject(const JsonVariant& v = JsonVariant())
+    : JsonVariant(v.raw() && v.raw()->type == HostJsonValue::OBJECT ? v.raw() : nullptr) {}
+};
+
+class JsonArray {
+public:
+  JsonArray(const JsonVariant& v = JsonVariant())
+    : v_(v.raw() && v.raw()->type == HostJsonValue::ARRAY ? v.raw() : nullptr) {}
+
+  class iterator {
+  public:
+    explicit iterator(const HostJsonValue* p) : p_(p) {}
+    JsonVariant operator*() const { return JsonVariant(p_); }
+    iterator& operator++() {
+      ++p_;
+      return *this;
+    }
+    bool operator!=(const iterator& o) const { return p_ != o.p_; }
+
+  private:
+    const HostJsonValue* p_;
+  };
+
+  iterator begin() const { return iterator(v_ && !v_->items.empty() ? &v_->items[0] : nullptr); }
+  iterator end() const { return iterator(v_ && !v_->items.empty() ? &v_->items[0] + v_->items.size() : nullptr); }
+  size_t size() const { return v_ ? v_->items.size() : 0; }
+
+private:
+  const HostJsonValue* v_;
+};
+
+class DeserializationError {
+public:
+  DeserializationError(const char* msg = nullptr) : msg_(msg) {}
+  explicit operator bool() const { return msg_ != nullptr; }
+  const char* c_str() const { return msg_ ? msg_ : "Ok"; }
+
+private:
+  const char* msg_;
+};
+
+class DynamicJsonDocument {
+public:
+  explicit DynamicJsonDocument(size_t) {}
+  JsonVariant operator[](const char* key) const { return JsonVariant(&root_)[key]; }
+
+  HostJsonValue root_;
+};
+
+namespace host_json {
+
+struct Parser {
+  const char* p;
+  const char* end;
+
+  void ws() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+  }
+  bool lit(const char* s) {
+    size_t n = strlen(s);
+    if ((size_t)(end - p) < n || strncmp(p, s, n) != 0) return false;
+    p += n;
+    return true;
+  }
+  static void utf8(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+      out += (char)cp;
+    } else if (cp < 0x800) {
+      out += (char)(0xC0 | (cp >> 6));
+      out += (char)(0x80 | (cp & 0x3F));
+    } else {
+      out += (char)(0xE0 | (cp >> 12));
+      out += (char)(0x80 | ((cp >> 6) & 0x3F));
+      out += (char)(0x80 | (cp & 0x3F));
+    }
+  }
+  bool string(std::string& out) {
+    if (p >= end || *p != '"') return false;
+    p++;
+    while (p < end && *p != '"') {
+      char c = *p++;
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (p >= end) return false;
+      c = *p++;
+      switch (c) {
+        case 'n': out += '\n'; break;
+        case 't': out += '\t'; break;
+        case 'r': out += '\r'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'u': {
+          if (end - p < 4) return false;
+          char hex[5] = {p[0], p[1], p[2], p[3], 0};
+          p += 4;
+          utf8(out, (unsigned)strtoul(hex, nullptr, 16));
+          break;
+        }
+        default: out += c; break; // \" \\ \/
+      }
+    }
+    if (p >= end) return false;
+    p++;
+    return true;
+  }
+  bool value(HostJsonValue& v, int depth) {
+    if (depth > 32) return false;
+    ws();
+    if (p >= end) return false;
+    if (*p == '{') {
+      p++;
+      v.type = HostJsonValue::OBJECT;
+      ws();
+      if (p < end && *p == '}') { p++; return true; }
+      for (;;) {
+        ws();
+        std::pair<std::string, HostJsonValue> m;
+        if (!string(m.first)) return false;
+        ws();
+        if (p >= end || *p++ != ':') return false;
+        if (!value(m.second, depth + 1)) return false;
+        v.members.push_back(m);
+        ws();
+        if (p < end && *p == ',') { p++; continue; }
+        if (p < end && *p == '}') { p++; return true; }
+        return false;
+      }
+    }
+    if (*p == '[') {
+      p++;
+      v.type = HostJsonValue::ARRAY;
+      ws();
+      if (p < end && *p == ']') { p++; return true; }
+      for (;;) {
+        v.items.push_back(HostJsonValue());
+        if (!value(v.items.back(), depth + 1)) return false;
+        ws();
+        if (p < end && *p == ',') { p++; continue; }
+        if (p < end && *p == ']') { p++; return true; }
+        return false;
+      }
+    }
+    if (*p == '"') {
+      v.type = HostJsonValue::STRING;
+      return string(v.str);
+    }
+    if (lit("true")) { v.type = HostJsonValue::BOOL; v.b = true; return true; }
+    if (lit("false")) { v.type = HostJsonValue::BOOL; v.b = false; return true; }
+    if (lit("null")) return true;
+    char* stop = nullptr;
+    v.num = strtod(p, &stop);
+    if (stop == p) return false;
+    v.type = HostJsonValue::NUMBER;
+    p = stop;
+    return true;
+  }
+};
+
+} // namespace host_json
+
+inline DeserializationError deserializeJson(DynamicJsonDocument& doc, File& file) {
+  std::string text;
+  for (int c = file.read(); c >= 0; c = file.read()) text += (char)c;
+  doc.root_ = HostJsonValue();
+  host_json::Parser parser = {text.c_str(), text.c_str() + text.size()};
+  if (!parser.value(doc.root_, 0)) return DeserializationError("InvalidInput");
+  parser.ws();
+  if (parser.p != parser.end) return DeserializationError("InvalidInput");
+  return DeserializationError();
+}
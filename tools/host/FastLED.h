@@ -0,0 +1,118 @@
+#pragma once
+// 主机端最小 FastLED 兼容层：只提供灯效头文件（audio_visualizer.hpp、led_palette.hpp）用到的颜色类型与换算，
+// 供 tools/palette_bench.cpp 编译；hsv2rgb_rainbow 与 scale8 按 FastLED 的算法实现，结果逐位一致。
+// FastLED 对象只为 meridian_tcm 编译通过（tools/acupoint_test.cpp），不输出任何东西
+#include <stdint.h>
+
+inline uint8_t scale8(uint8_t i, uint8_t scale) { return (uint8_t)(((uint16_t)i * (1 + (uint16_t)scale)) >> 8); }
+
+inline uint8_t scale8_video(uint8_t i, uint8_t scale) {
+  return (uint8_t)((((int)i * (int)scale) >> 8) + ((i && scale) ? 1 : 0));
+}
+
+struct CHSV {
+  uint8_t hue, sat, val;
+  CHSV() : hue(0), sat(0), val(0) {}
+  CHSV(uint8_t h, uint8_t s, uint8_t v) : hue(h), sat(s), val(v) {}
+};
+
+struct CRGB;
+inline void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb);
+
+struct CRGB {
+  union {
+    struct { uint8_t r, g, b; };
+    uint8_t raw[3];
+  };
+
+  enum HTMLColorCode : uint32_t {
+    Black = 0x000000, White = 0xFFFFFF, Red = 0xFF0000, Green = 0x008000, Blue = 0x0000FF, Orange = 0xFFA500,
+    Yellow = 0xFFFF00, Purple = 0x800080, Magenta = 0xFF00FF, Pink = 0xFFC0CB
+  };
+
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(uint32_t code) : r((code >> 16) & 0xFF), g((code >> 8) & 0xFF), b(code & 0xFF) {}
+  CRGB(HTMLColorCode code) : CRGB((uint32_t)code) {}
+  CRGB(const CHSV& hsv) { hsv2rgb_rainbow(hsv, *this); }
+
+  CRGB& nscale8(uint8_t s) {
+    r = scale8(r, s); g = scale8(g, s); b = scale8(b, s);
+    return *this;
+  }
+  CRGB& nscale8_video(uint8_t s) {
+    r = scale8_video(r, s); g = scale8_video(g, s); b = scale8_video(b, s);
+    return *this;
+  }
+  CRGB& operator|=(const CRGB& o) {
+    if (o.r > r) r = o.r;
+    if (o.g > g) g = o.g;
+    if (o.b > b) b = o.b;
+    return *this;
+  }
+  bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+  bool operator!=(const CRGB& o) const { return !(*this == o); }
+};
+
+inline void fill_solid(CRGB* leds, int n, const CRGB& c) {
+  for (int i = 0; i < n; i++) leds[i] = c;
+}
+
+struct WS2812B {};
+
+struct HostFastLED {
+  template <typename CHIPSET, uint8_t PIN>
+  void addLeds(CRGB*, int) {}
+  void setBrightness(uint8_t) {}
+  void show() {}
+};
+
+static HostFastLED FastLED __attribute__((unused));
+
+// FastLED 的“彩虹”色轮：黄色区域加宽，饱和度与亮度按视频曲线缩放
+inline void hsv2rgb_rainbow(const CHSV& hsv, CRGB& rgb) {
+  uint8_t hue = hsv.hue, sat = hsv.sat, val = hsv.val;
+  uint8_t offset8 = (uint8_t)((hue & 0x1F) << 3);
+  uint8_t third = scale8(offset8, 256 / 3);
+  uint8_t r, g, b;
+  if (!(hue & 0x80)) {
+    if (!(hue & 0x40)) {
+      if (!(hue & 0x20)) { r = 255 - third; g = third; b = 0; }
+      else { r = 171; g = 85 + third; b = 0; }
+    } else {
+      if (!(hue & 0x20)) { uint8_t twothirds = scale8(offset8, (256 * 2) / 3); r = 171 - twothirds; g = 170 + third; b = 0; }
+      else { r = 0; g = 255 - third; b = third; }
+    }
+  } else {
+    if (!(hue & 0x40)) {
+      if (!(hue & 0x20)) { uint8_t twothirds = scale8(offset8, (256 * 2) / 3); r = 0; g = 171 - twothirds; b = 85 + twothirds; }
+      else { r = third; g = 0; b = 255 - third; }
+    } else {
+      if (!(hue & 0x20)) { r = 85 + third; g = 0; b = 171 - third; }
+      else { r = 170 + third; g = 0; b = 85 - third; }
+    }
+  }
+  if (sat != 255) {
+    if (sat == 0) {
+      r = g = b = 255;
+    } else {
+      uint8_t desat = scale8_video(255 - sat, 255 - sat);
+      uint8_t satscale = 255 - desat;
+      if (r) r = scale8(r, satscale) + 1;
+      if (g) g = scale8(g, satscale) + 1;
+      if (b) b = scale8(b, satscale) + 1;
+      r += desat; g += desat; b += desat;
+    }
+  }
+  if (val != 255) {
+    val = scale8_video(val, val);
+    if (val == 0) {
+      r = g = b = 0;
+    } else {
+      if (r) r = scale8(r, val) + 1;
+      if (g) g = scale8(g, val) + 1;
+      if (b) b = scale8(b, val) + 1;
+    }
+  }
+  rgb.r = r; rgb.g = g; rgb.b = b;
+}
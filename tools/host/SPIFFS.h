@@ -0,0 +1,68 @@
+#pragma once
+// 主机端最小 SPIFFS 兼容层：把 "/xxx" 映射到主机目录 root 下的普通文件（默认 data/，与上传到设备的文件系统镜像相同），
+// 只提供经络配置加载（meridian_config.hpp）用到的打开、读取与列目录
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <string>
+
+class File {
+public:
+  File() {}
+  File(FILE* f, const std::string& path, const std::string& name) : f_(f), path_(path), name_(name) {}
+  File(DIR* d, const std::string& path) : d_(d), path_(path), name_("/") {}
+
+  explicit operator bool() const { return f_ || d_; }
+  void close() {
+    if (f_) fclose(f_);
+    if (d_) closedir(d_);
+    f_ = nullptr;
+    d_ = nullptr;
+  }
+  const char* name() const { return name_.c_str(); }
+  size_t size() const {
+    if (!f_) return 0;
+    long pos = ftell(f_);
+    fseek(f_, 0, SEEK_END);
+    long n = ftell(f_);
+    fseek(f_, pos, SEEK_SET);
+    return (size_t)n;
+  }
+  int read() { return f_ ? fgetc(f_) : -1; }
+
+  // 目录：依次返回其中的普通文件（句柄由调用方 close，或随程序退出释放）
+  File openNextFile() {
+    if (!d_) return File();
+    while (struct dirent* e = readdir(d_)) {
+      if (e->d_name[0] == '.') continue;
+      std::string path = path_ + "/" + e->d_name;
+      FILE* f = fopen(path.c_str(), "rb");
+      if (f) return File(f, path, std::string("/") + e->d_name);
+    }
+    return File();
+  }
+
+private:
+  FILE* f_ = nullptr;
+  DIR* d_ = nullptr;
+  std::string path_;
+  std::string name_;
+};
+
+class HostSPIFFS {
+public:
+  const char* root = "data";
+
+  bool begin(bool = false) { return true; }
+  File open(const char* path, const char* = "r") {
+    std::string full = std::string(root) + path;
+    if (strcmp(path, "/") == 0) {
+      DIR* d = opendir(root);
+      return d ? File(d, root) : File();
+    }
+    FILE* f = fopen(full.c_str(), "rb");
+    return f ? File(f, full, path) : File();
+  }
+};
+
+static HostSPIFFS SPIFFS __attribute__((unused));
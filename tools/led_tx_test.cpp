@@ -0,0 +1,166 @@
+/**
+ * 灯带异步发送（LedTransmitter）的主机端测试
+ *
+ * 用 std::thread 实现 led_transmitter.hpp 用到的几个 FreeRTOS 接口（任务、任务通知、二值信号量），
+ * 按 ESP32 路径编译，由模拟的 sink 代替 FastLED.show()：发送期间先后两次读取前台缓冲并比较，
+ * 同时记录每帧的序号与亮度。生产者按画布 show() 的顺序 waitIdle() → 写前台缓冲 → submit()，
+ * 渲染耗时随机，发送与渲染有时重叠、有时需要等待。检查：
+ *   - 发送期间前台缓冲从未被改写（生产者写入时 sink 不在发送中，sink 前后两次读到的内容一致）
+ *   - 每帧恰好送出一次，且按提交顺序，亮度随帧传递
+ *   - 统计：帧数、等待次数与重叠率
+ * 任一检查失败时返回 1。--no-wait 故意跳过 waitIdle()，用来确认测试能发现违反交接协议的写入。
+ *
+ * 编译（仓库根目录）：
+ *   g++ -O2 -std=gnu++11 -pthread -Itools/host -Isrc tools/led_tx_test.cpp -o led_tx_test
+ *
+ * 用法：
+ *   led_tx_test [frames] [--no-wait]
+ */
+#include <Arduino.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ---- FreeRTOS 接口的线程实现（只覆盖 LedTransmitter 用到的部分，1 tick = 1ms）----
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef void (*TaskFunction_t)(void*);
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+// 计数等待：信号量为 0/1，任务通知为计数值；对象不释放，程序退出时发送线程仍可安全阻塞在上面
+struct HostWaitable {
+  std::mutex m;
+  std::condition_variable cv;
+  uint32_t count = 0;
+
+  void give(uint32_t max) {
+    std::lock_guard<std::mutex> lock(m);
+    if (count < max) count++;
+    cv.notify_all();
+  }
+
+  // 超时返回 0；clear 时取走全部计数（ulTaskNotifyTake 的 pdTRUE），否则取 1
+  uint32_t take(bool clear, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(m);
+    if (ticks == portMAX_DELAY) {
+      cv.wait(lock, [this] { return count > 0; });
+    } else if (!cv.wait_for(lock, std::chrono::milliseconds(ticks), [this] { return count > 0; })) {
+      return 0;
+    }
+    uint32_t n = count;
+    count = clear ? 0 : count - 1;
+    return clear ? n : 1;
+  }
+};
+
+struct HostTask {
+  HostWaitable notify;
+  std::thread thread;
+};
+typedef HostTask* TaskHandle_t;
+typedef HostWaitable* SemaphoreHandle_t;
+
+static thread_local HostTask* currentTask = nullptr;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return new HostWaitable(); }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) { return s->take(false, ticks) ? pdTRUE : pdFALSE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) { s->give(1); return pdTRUE; }
+
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char*, uint32_t, void* arg, uint32_t, TaskHandle_t* handle) {
+  HostTask* task = new HostTask();
+  *handle = task;
+  task->thread = std::thread([task, fn, arg] {
+    currentTask = task;
+    fn(arg);
+  });
+  task->thread.detach();
+  return pdPASS;
+}
+inline void xTaskNotifyGive(TaskHandle_t task) { task->notify.give(0xFFFFFFFFu); }
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) { return currentTask->notify.take(clear != pdFALSE, ticks); }
+
+#define ARDUINO_ARCH_ESP32 1
+#include "led_transmitter.hpp"
+
+// ---- 模拟灯带 ----
+static const uint16_t NUM_LEDS = 160;
+static const uint32_t TX_US = 400;       // 模拟的发送时间（实际 160 颗约 5ms，这里缩短以多跑几帧）
+static const uint32_t MAX_RENDER_US = 800;
+
+static uint32_t front[NUM_LEDS];         // 前台缓冲：每颗灯写入帧序号
+static std::atomic<bool> inFlight{false};
+static std::vector<uint32_t> delivered;  // 只由发送线程写，生产者在 waitIdle() 之后读
+static uint32_t torn = 0;                // 发送期间前台缓冲内容发生变化（发送线程计数）
+static uint32_t mixed = 0;               // 一帧里混有不同序号（发送线程计数）
+static uint32_t badBrightness = 0;
+
+static void mockSink(void*, uint8_t brightness) {
+  inFlight.store(true, std::memory_order_seq_cst);
+  uint32_t seq = front[0];
+  for (uint16_t i = 1; i < NUM_LEDS; i++) {
+    if (front[i] != seq) { mixed++; break; }
+  }
+  if (brightness != (uint8_t)seq) badBrightness++;
+  usleep(TX_US);
+  for (uint16_t i = 0; i < NUM_LEDS; i++) {
+    if (front[i] != seq) { torn++; break; }
+  }
+  delivered.push_back(seq);
+  inFlight.store(false, std::memory_order_seq_cst);
+}
+
+int main(int argc, char** argv) {
+  uint32_t frames = 2000;
+  bool noWait = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--no-wait") == 0) noWait = true;
+    else frames = (uint32_t)atoi(argv[i]);
+  }
+
+  static LedTransmitter tx;
+  if (!tx.begin(mockSink, nullptr)) {
+    fprintf(stderr, "begin failed\n");
+    return 1;
+  }
+
+  uint32_t writesInFlight = 0; // 生产者写前台缓冲时发送仍在进行
+  uint32_t seed = 1;
+  for (uint32_t seq = 1; seq <= frames; seq++) {
+    // 渲染下一帧（与上一帧的发送重叠）
+    seed = seed * 1103515245u + 12345u;
+    usleep((seed >> 16) % MAX_RENDER_US);
+
+    if (!noWait) tx.waitIdle();
+    if (inFlight.load(std::memory_order_seq_cst) || tx.busy()) writesInFlight++;
+    for (uint16_t i = 0; i < NUM_LEDS; i++) front[i] = seq;
+    tx.submit((uint8_t)seq);
+  }
+  tx.waitIdle();
+
+  uint32_t outOfOrder = 0;
+  for (size_t i = 0; i < delivered.size(); i++) {
+    if (delivered[i] != i + 1) outOfOrder++;
+  }
+  const LedTransmitter::Stats& s = tx.stats();
+  printf("frames submitted=%u delivered=%u out_of_order=%u\n", (unsigned)frames, (unsigned)delivered.size(),
+         (unsigned)outOfOrder);
+  printf("front buffer: writes during send=%u torn sends=%u mixed frames=%u bad brightness=%u\n",
+         (unsigned)writesInFlight, (unsigned)torn, (unsigned)mixed, (unsigned)badBrightness);
+  printf("stats: frames=%u waits=%u tx mean=%.0fus max=%uus wait max=%uus overlap=%.0f%%\n", (unsigned)s.frames,
+         (unsigned)s.waits, s.frames ? (double)s.txUs / s.frames : 0.0, (unsigned)s.maxTxUs, (unsigned)s.maxWaitUs,
+         100.0 * s.overlap());
+
+  bool ok = delivered.size() == frames && outOfOrder == 0 && writesInFlight == 0 && torn == 0 && mixed == 0 &&
+            badBrightness == 0 && s.frames == frames && s.waits > 0 && s.overlap() > 0.0f && s.overlap() <= 1.0f;
+  printf("# %s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+/**
+ * 起音检测与速度估计的主机端回归测试
+ *
+ * 合成带标注的点击音轨（已知起音时刻与 BPM）和持续音（不应有任何起音），逐帧驱动
+ * OptimizedAudioAnalyzer，统计起音的 F 值、最终 BPM 与持续音上的误报；任一用例不达标时返回 1。
+ *
+ * 编译（仓库根目录）：
+ *   g++ -O2 -std=gnu++11 -Itools/host -Isrc tools/onset_test.cpp -o onset_test
+ *
+ * 用法：
+ *   onset_test [--window N] [--hop N] [--verbose]
+ *
+ * --verbose 时逐个列出检测到的起音时刻，未匹配到标注的标为 false。
+ */
+#include <Arduino.h>
+#include <stdlib.h>
+#include "optimized_audio.hpp"
+
+static const uint32_t FS = 8000;
+static const float SECONDS = 10.0f;
+static const float FIRST_CLICK_S = 0.5f;  // 第一个点击的时刻，避开分析器启动
+static const float SETTLE_S = 1.0f;       // 持续音用例：此后不允许任何起音或节拍
+static const float MATCH_S = 0.05f;       // 起音与标注的匹配容差
+static const float MIN_F = 0.9f;
+static const float BPM_TOL = 0.03f;       // 最终 BPM 的相对误差上限（半速、倍速同样接受并标注）
+
+/**
+ * 合成采样源：底噪 + 可选持续音 + 按固定速度出现的点击（指数衰减的噪声脉冲）
+ * 输出与 SyntheticSampleSource 相同的 12 位无符号样本（中点 2048）
+ */
+class ClickTrackSource : public SampleSource {
+public:
+  ClickTrackSource(float bpm, float toneHz, float toneAmp)
+    : period_(bpm > 0.0f ? (uint32_t)(FS * 60.0f / bpm + 0.5f) : 0), toneHz_(toneHz), toneAmp_(toneAmp) {}
+
+  bool begin() override { return true; }
+
+  size_t read(int16_t* dst, size_t maxCount) override {
+    const float inc = 2.0f * (float)M_PI * toneHz_ / (float)FS;
+    const uint32_t first = (uint32_t)(FIRST_CLICK_S * FS);
+    for (size_t i = 0; i < maxCount; i++, n_++) {
+      float v = 2048.0f + noise() * NOISE_AMP;
+      if (toneAmp_ > 0.0f) {
+        v += toneAmp_ * sinf(phase_);
+        phase_ += inc;
+        if (phase_ > 2.0f * (float)M_PI) phase_ -= 2.0f * (float)M_PI;
+      }
+      if (period_ && n_ >= first) {
+        uint32_t since = (n_ - first) % period_;
+        if (since < CLICK_LEN) v += noise() * CLICK_AMP * expf(-(float)since / (CLICK_TAU_S * FS));
+      }
+      if (v < 0.0f) v = 0.0f;
+      if (v > 4095.0f) v = 4095.0f;
+      dst[i] = (int16_t)v;
+    }
+    return maxCount;
+  }
+
+  uint32_t sampleRate() const override { return FS; }
+  const char* name() const override { return "clicktrack"; }
+
+  uint32_t delivered() const { return n_; }
+
+  // 第 i 个点击的时刻（秒），超出音轨时返回负数
+  float clickTime(uint32_t i) const {
+    if (!period_) return -1.0f;
+    float t = FIRST_CLICK_S + (float)(i * period_) / FS;
+    return t < SECONDS ? t : -1.0f;
+  }
+
+private:
+  static constexpr float NOISE_AMP = 20.0f;
+  static constexpr float CLICK_AMP = 1500.0f;
+  static constexpr float CLICK_TAU_S = 0.01f;
+  static const uint32_t CLICK_LEN = 400; // 50ms
+
+  // 线性同余噪声，-1..1，保证多次运行结果一致
+  float noise() {
+    seed_ = seed_ * 1103515245u + 12345u;
+    return (float)((seed_ >> 16) & 0x7FFF) / 16383.5f - 1.0f;
+  }
+
+  uint32_t period_;
+  float toneHz_, toneAmp_;
+  float phase_ = 0.0f;
+  uint32_t n_ = 0;
+  uint32_t seed_ = 1;
+};
+
+struct TestCase {
+  const char* name;
+  float bpm;      // 点击速度，0 = 无点击（持续音负例）
+  float toneHz;
+  float toneAmp;
+};
+
+static const TestCase CASES[] = {
+  {"click 90bpm", 90.0f, 0.0f, 0.0f},
+  {"click 120bpm", 120.0f, 0.0f, 0.0f},
+  {"click 150bpm", 150.0f, 0.0f, 0.0f},
+  {"click 170bpm", 170.0f, 0.0f, 0.0f},
+  {"click 120bpm + 220Hz", 120.0f, 220.0f, 400.0f},
+  {"noise only", 0.0f, 0.0f, 0.0f},
+  {"tone 110Hz", 0.0f, 110.0f, 600.0f},
+  {"tone 220Hz", 0.0f, 220.0f, 600.0f},
+  {"tone 440Hz", 0.0f, 440.0f, 600.0f},
+  {"tone 1000Hz", 0.0f, 1000.0f, 600.0f},
+  {"tone 440Hz loud", 0.0f, 440.0f, 1500.0f},
+};
+
+static bool runCase(const TestCase& c, uint16_t window, uint16_t hop, bool verbose) {
+  static const uint16_t MAX_ONSETS = 256;
+  static ClickTrackSource* src = nullptr;
+  static OptimizedAudioAnalyzer* analyzer = nullptr;
+  delete src;
+  delete analyzer;
+  src = new ClickTrackSource(c.bpm, c.toneHz, c.toneAmp);
+  analyzer = new OptimizedAudioAnalyzer(0);
+  analyzer->setSource(src);
+  if (!analyzer->setWindow(window, hop)) {
+    fprintf(stderr, "invalid --window/--hop\n");
+    exit(2);
+  }
+  analyzer->setDemand(OptimizedAudioAnalyzer::CONSUMER_EFFECT, AudioFeatures::FEAT_LEVEL | AudioFeatures::FEAT_ONSET);
+  analyzer->begin();
+
+  // 起音判定有一帧延迟，检测时刻取上一帧窗口的末尾
+  const float latency = (float)hop / FS;
+  float onsets[MAX_ONSETS];
+  uint16_t found = 0;
+  uint32_t lateOnsets = 0, lateBeats = 0, beatsAtSettle = 0;
+  bool locked = false, settled = false;
+  while (src->delivered() < (uint32_t)(SECONDS * FS)) {
+    if (!analyzer->tick()) continue;
+    float t = (float)src->delivered() / FS;
+    if (!settled && t >= SETTLE_S) {
+      settled = true;
+      beatsAtSettle = analyzer->beatCount();
+    }
+    if (analyzer->bpm() > 0.0f) locked = true;
+    if (!analyzer->onset()) continue;
+    if (found < MAX_ONSETS) onsets[found++] = t - latency;
+    if (settled) lateOnsets++;
+  }
+  lateBeats = analyzer->beatCount() - beatsAtSettle;
+  float bpm = analyzer->bpm();
+
+  if (c.bpm <= 0.0f) {
+    bool ok = lateOnsets == 0 && lateBeats == 0 && !locked;
+    printf("%-24s onsets=%u (after %.1fs: %u) beats after %.1fs=%u tempo_locked=%s  %s\n", c.name, (unsigned)found,
+           (double)SETTLE_S, (unsigned)lateOnsets, (double)SETTLE_S, (unsigned)lateBeats, locked ? "yes" : "no",
+           ok ? "ok" : "FAIL");
+    return ok;
+  }
+
+  // 贪心匹配：每个标注最多对应一个检测结果
+  bool used[MAX_ONSETS] = {false};
+  uint32_t labels = 0, hits = 0;
+  float offsetSum = 0.0f;
+  for (uint32_t i = 0;; i++) {
+    float ref = src->clickTime(i);
+    if (ref < 0.0f) break;
+    labels++;
+    for (uint16_t j = 0; j < found; j++) {
+      if (used[j] || fabsf(onsets[j] - ref) > MATCH_S) continue;
+      used[j] = true;
+      hits++;
+      offsetSum += onsets[j] - ref;
+      break;
+    }
+  }
+  if (verbose) {
+    for (uint16_t j = 0; j < found; j++) printf("  %.3fs%s\n", (double)onsets[j], used[j] ? "" : " (false)");
+  }
+  float precision = found ? (float)hits / found : 0.0f;
+  float recall = labels ? (float)hits / labels : 0.0f;
+  float f = precision + recall > 0.0f ? 2.0f * precision * recall / (precision + recall) : 0.0f;
+  // 120BPM 先验两侧等距的速度（如 170 与 85）本身有倍频歧义
+  bool tempoOk = fabsf(bpm - c.bpm) <= c.bpm * BPM_TOL;
+  bool octave = !tempoOk && (fabsf(bpm * 2.0f - c.bpm) <= c.bpm * BPM_TOL || fabsf(bpm - c.bpm * 2.0f) <= c.bpm * 2.0f * BPM_TOL);
+  bool ok = f >= MIN_F && (tempoOk || octave);
+  printf("%-24s labels=%u onsets=%u hits=%u F=%.3f offset=%+.1fms bpm=%.1f%s  %s\n", c.name, (unsigned)labels,
+         (unsigned)found, (unsigned)hits, (double)f, hits ? 1000.0 * offsetSum / hits : 0.0, (double)bpm,
+         octave ? " (octave)" : "", ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static const char* argValue(int argc, char** argv, const char* name, const char* def) {
+  for (int i = 1; i < argc - 1; i++) {
+    if (strcmp(argv[i], name) == 0) return argv[i + 1];
+  }
+  return def;
+}
+
+int main(int argc, char** argv) {
+  uint16_t window = (uint16_t)atoi(argValue(argc, argv, "--window", "128"));
+  uint16_t hop = (uint16_t)atoi(argValue(argc, argv, "--hop", "32"));
+  bool verbose = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--verbose") == 0) verbose = true;
+  }
+  unsigned failed = 0;
+  for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++) {
+    if (!runCase(CASES[i], window, hop, verbose)) failed++;
+  }
+  printf("# %u/%u cases failed\n", failed, (unsigned)(sizeof(CASES) / sizeof(CASES[0])));
+  return failed ? 1 : 0;
+}
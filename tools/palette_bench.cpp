@@ -0,0 +1,171 @@
+/**
+ * 调色板主机端基准程序
+ *
+ * 对比灯效中逐像素计算颜色（色轮分支、浮点除法、CHSV 转换）与查调色板/渐变缓存的每帧耗时，
+ * 并逐像素核对两种做法的输出是否一致。
+ *
+ * 编译（仓库根目录）：
+ *   g++ -O2 -std=gnu++11 -Itools/host -Isrc tools/palette_bench.cpp -o palette_bench
+ *
+ * 用法：
+ *   palette_bench [LEDS] [FRAMES]     默认 160 颗灯、20000 帧
+ */
+#include <Arduino.h>
+#include <stdlib.h>
+#include "audio_visualizer.hpp"
+#include "led_palette.hpp"
+
+// ---- 改动前的逐像素实现 ----
+
+static uint32_t refWheel(uint8_t wheelPos) {
+  wheelPos = 255 - wheelPos;
+  if (wheelPos < 85) {
+    return ((uint32_t)(255 - wheelPos * 3) << 16) | ((uint32_t)(wheelPos * 3) << 8);
+  } else if (wheelPos < 170) {
+    wheelPos -= 85;
+    return ((uint32_t)(wheelPos * 3) << 8) | (255 - wheelPos * 3);
+  } else {
+    wheelPos -= 170;
+    return ((uint32_t)(255 - wheelPos * 3) | ((uint32_t)wheelPos * 3 << 16));
+  }
+}
+
+static void refFlow(CRGB* leds, int n, uint8_t hue, uint8_t tail) {
+  for (uint16_t k = 0; k <= tail; ++k) {
+    uint8_t brightness = 255 - (255 * k) / (tail + 1);
+    uint32_t color = refWheel(hue + (k * 2));
+    uint8_t r = ((color >> 16) & 0xFF) * brightness / 255;
+    uint8_t g = ((color >> 8) & 0xFF) * brightness / 255;
+    uint8_t b = (color & 0xFF) * brightness / 255;
+    leds[k % n] = CRGB(r, g, b);
+  }
+}
+
+static void refVu(CRGB* leds, int n, int active) {
+  for (int i = 0; i < n; i++) {
+    if (i < active) {
+      float hue = 160.0f - (i * 160.0f / n);
+      leds[i] = CHSV((int)hue, 255, 255);
+    } else {
+      leds[i] = CRGB::Black;
+    }
+  }
+}
+
+static void refSpectrumColors(CRGB* out, uint8_t count) {
+  for (uint8_t b = 0; b < count; b++) out[b] = CHSV((uint8_t)(160 - b * 160 / count), 255, 255);
+}
+
+// ---- 查表实现（与 EnhancedFlowEffect::render 的内层循环相同）----
+
+static void lutFlow(CRGB* leds, int n, uint8_t hue, uint8_t tail, const uint8_t* fade) {
+  const LedPalette& wheel = LedPalette::wheel();
+  for (uint16_t k = 0; k <= tail; ++k) {
+    CRGB c = wheel[(uint8_t)(hue + k * 2)];
+    uint8_t brightness = fade[k];
+    c.r = c.r * brightness / 255;
+    c.g = c.g * brightness / 255;
+    c.b = c.b * brightness / 255;
+    leds[k % n] = c;
+  }
+}
+
+static void lutSpectrumColors(CRGB* out, uint8_t count) {
+  for (uint8_t b = 0; b < count; b++) out[b] = LedPalette::rainbow()[(uint8_t)(160 - b * 160 / count)];
+}
+
+static uint32_t checksum(const CRGB* leds, int n) {
+  uint32_t h = 2166136261u;
+  for (int i = 0; i < n; i++) h = (h ^ leds[i].r ^ (leds[i].g << 8) ^ (leds[i].b << 16)) * 16777619u;
+  return h;
+}
+
+static volatile uint32_t sink;
+
+template <typename F>
+static double nsPerFrame(uint32_t frames, F fn) {
+  uint32_t t0 = micros();
+  for (uint32_t f = 0; f < frames; f++) fn(f);
+  return (micros() - t0) * 1000.0 / frames;
+}
+
+static void report(const char* name, double before, double after, bool same) {
+  printf("%-16s %10.1f %10.1f %7.1fx  %s\n", name, before, after, after > 0 ? before / after : 0.0, same ? "match" : "MISMATCH");
+}
+
+int main(int argc, char** argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 160;
+  uint32_t frames = argc > 2 ? (uint32_t)atoi(argv[2]) : 20000;
+  if (n < 1 || n > 1000 || frames == 0) {
+    fprintf(stderr, "usage: %s [LEDS 1..1000] [FRAMES]\n", argv[0]);
+    return 2;
+  }
+  CRGB* a = new CRGB[n];
+  CRGB* b = new CRGB[n];
+  bool ok = true;
+
+  printf("# leds=%d frames=%u (ns per frame)\n", n, (unsigned)frames);
+  printf("%-16s %10s %10s %8s\n", "effect", "before", "after", "speedup");
+
+  // 流动拖尾：默认 8 颗与最长 255 颗
+  static const uint8_t tails[2] = {8, 255};
+  for (uint8_t t = 0; t < 2; t++) {
+    uint8_t tail = tails[t];
+    uint8_t fade[256];
+    for (uint16_t k = 0; k <= tail; k++) fade[k] = (uint8_t)(255 - (255 * k) / (tail + 1));
+    bool same = true;
+    for (uint16_t hue = 0; hue < 256; hue++) {
+      refFlow(a, n, (uint8_t)hue, tail);
+      lutFlow(b, n, (uint8_t)hue, tail, fade);
+      same = same && checksum(a, n) == checksum(b, n);
+    }
+    double before = nsPerFrame(frames, [&](uint32_t f) { refFlow(a, n, (uint8_t)f, tail); sink += a[0].r; });
+    double after = nsPerFrame(frames, [&](uint32_t f) { lutFlow(b, n, (uint8_t)f, tail, fade); sink += b[0].r; });
+    char name[24];
+    snprintf(name, sizeof(name), "flow tail=%u", (unsigned)tail);
+    report(name, before, after, same);
+    ok = ok && same;
+  }
+
+  // 音量条：满幅（每颗灯都要算颜色）
+  {
+    VUMeterEffect vu;
+    AudioFeatures f;
+    f.level = 1.0f;
+    refVu(a, n, n);
+    vu.render(b, n, f);
+    bool same = checksum(a, n) == checksum(b, n);
+    double before = nsPerFrame(frames, [&](uint32_t) { refVu(a, n, n); sink += a[0].r; });
+    double after = nsPerFrame(frames, [&](uint32_t) { vu.render(b, n, f); sink += b[0].r; });
+    report("vu full", before, after, same);
+    ok = ok && same;
+  }
+
+  // 频谱：每段一次颜色换算
+  {
+    CRGB ca[16], cb[16];
+    refSpectrumColors(ca, 16);
+    lutSpectrumColors(cb, 16);
+    bool same = checksum(ca, 16) == checksum(cb, 16);
+    double before = nsPerFrame(frames, [&](uint32_t) { refSpectrumColors(ca, 16); sink += ca[0].r; });
+    double after = nsPerFrame(frames, [&](uint32_t) { lutSpectrumColors(cb, 16); sink += cb[0].r; });
+    report("spectrum colors", before, after, same);
+    ok = ok && same;
+  }
+
+  // 整个调色板与逐项换算一致
+  {
+    bool same = true;
+    for (uint16_t i = 0; i < 256; i++) {
+      CRGB c = CHSV((uint8_t)i, 255, 255);
+      same = same && c == LedPalette::rainbow()[(uint8_t)i];
+      same = same && CRGB(refWheel((uint8_t)i)) == LedPalette::wheel()[(uint8_t)i];
+    }
+    printf("# palettes rainbow/wheel: %s\n", same ? "match" : "MISMATCH");
+    ok = ok && same;
+  }
+
+  delete[] a;
+  delete[] b;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/**
+ * 音高估计主机端基准程序
+ *
+ * 在 80Hz–1kHz 范围内按对数间隔扫频，合成带谐波的音（基频 + 2~4 次谐波 + 底噪），
+ * 以分析器的参数（256 个样本，默认 8kHz）分别交给 YinPitchEstimator 与 AcfPitchEstimator，
+ * 统计音分误差（平均、95 分位、最大）、粗差（误差超过 50 音分，多为倍频/半频）、
+ * 未检出的帧数与每帧耗时，并按频段分组列出平均误差。
+ *
+ * 编译（仓库根目录）：
+ *   g++ -O2 -std=gnu++11 -Itools/host -Isrc tools/pitch_bench.cpp -o pitch_bench
+ *
+ * 用法：
+ *   pitch_bench [STEPS] [--noise A] [--fs HZ] [--pure]
+ *     STEPS    扫频点数（默认 240，约每 1/5 个半音一点），每个频率取 4 个起始相位
+ *     --noise  底噪幅度（ADC 计数，默认 20）
+ *     --fs     采样率（默认 8000）；设备实测采样率略低时，80Hz 的周期落在最大滞后处
+ *     --pure   只用正弦，不加谐波
+ */
+#include <Arduino.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include "pitch_estimator.hpp"
+
+static const uint16_t N = 256;       // 与分析器的 PITCH_WINDOW 一致
+static const uint16_t ACF_N = 512;   // 自相关补零到 2N
+static const float MIN_HZ = 80.0f;
+static const float MAX_HZ = 1000.0f;
+static const uint8_t PHASES = 4;
+static const float GROSS_CENTS = 50.0f;
+static volatile float sink;
+
+struct Result {
+  const char* name;
+  std::vector<float> cents;    // 每个检出帧的绝对音分误差
+  uint32_t missed = 0;
+  uint32_t gross = 0;
+  double us = 0.0;
+  uint32_t frames = 0;
+  double groupSum[4] = {0, 0, 0, 0};
+  uint32_t groupCount[4] = {0, 0, 0, 0};
+};
+
+// 频段分组：80–160、160–320、320–640、640–1000Hz
+static uint8_t groupOf(float hz) {
+  uint8_t g = 0;
+  for (float edge = 160.0f; hz >= edge && g < 3; edge *= 2.0f) g++;
+  return g;
+}
+
+static float FS = 8000.0f;
+
+static void synth(float hz, float phase, float noise, bool pure, int16_t* x, uint32_t& seed) {
+  for (uint16_t i = 0; i < N; i++) {
+    float a = 2.0f * (float)M_PI * hz * (float)i / FS + phase;
+    float v = 600.0f * sinf(a);
+    if (!pure) v += 300.0f * sinf(2.0f * a + 0.7f) + 150.0f * sinf(3.0f * a + 1.3f) + 80.0f * sinf(4.0f * a + 2.1f);
+    seed = seed * 1103515245u + 12345u;
+    v += ((float)((seed >> 16) & 0x7FFF) / 16383.5f - 1.0f) * noise;
+    x[i] = (int16_t)lroundf(v);
+  }
+}
+
+static void run(PitchEstimator& est, Result& r, const int16_t* x, float hz) {
+  PitchEstimate out;
+  uint32_t t0 = micros();
+  const int REPEAT = 20; // 单帧耗时只有几十微秒，重复取平均
+  bool ok = false;
+  for (int i = 0; i < REPEAT; i++) {
+    ok = est.estimate(x, N, FS, out);
+    sink = out.hz;
+  }
+  r.us += (double)(micros() - t0) / REPEAT;
+  r.frames++;
+  if (!ok || out.hz <= 0.0f) {
+    r.missed++;
+    return;
+  }
+  float c = fabsf(1200.0f * log2f(out.hz / hz));
+  if (c > GROSS_CENTS) {
+    r.gross++;
+    return;
+  }
+  r.cents.push_back(c);
+  uint8_t g = groupOf(hz);
+  r.groupSum[g] += c;
+  r.groupCount[g]++;
+}
+
+static void report(Result& r) {
+  std::vector<float>& c = r.cents;
+  std::sort(c.begin(), c.end());
+  double sum = 0.0;
+  for (size_t i = 0; i < c.size(); i++) sum += c[i];
+  float p95 = c.empty() ? 0.0f : c[(size_t)(0.95 * (c.size() - 1))];
+  printf("%-4s frames=%u mean=%.2f p95=%.2f max=%.2f cents  gross=%u missed=%u  %.1f us/frame\n", r.name,
+         (unsigned)r.frames, c.empty() ? 0.0 : sum / c.size(), (double)p95, c.empty() ? 0.0 : (double)c.back(),
+         (unsigned)r.gross, (unsigned)r.missed, r.frames ? r.us / r.frames : 0.0);
+  printf("     mean cents by band:");
+  static const char* names[4] = {"80-160", "160-320", "320-640", "640-1k"};
+  for (int g = 0; g < 4; g++) {
+    printf("  %s %.2f", names[g], r.groupCount[g] ? r.groupSum[g] / r.groupCount[g] : 0.0);
+  }
+  printf("\n");
+}
+
+int main(int argc, char** argv) {
+  uint16_t steps = 240;
+  float noise = 20.0f;
+  bool pure = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--noise") == 0 && i + 1 < argc) noise = (float)atof(argv[++i]);
+    else if (strcmp(argv[i], "--fs") == 0 && i + 1 < argc) FS = (float)atof(argv[++i]);
+    else if (strcmp(argv[i], "--pure") == 0) pure = true;
+    else steps = (uint16_t)atoi(argv[i]);
+  }
+  if (steps < 2) steps = 2;
+
+  static FixedRealFFT<ACF_N> fft;
+  static YinPitchEstimator<N> yin;
+  static AcfPitchEstimator<ACF_N> acf(fft);
+  yin.setRange(MIN_HZ, MAX_HZ);
+  acf.setRange(MIN_HZ, MAX_HZ);
+
+  Result ry, ra;
+  ry.name = "yin";
+  ra.name = "acf";
+  static int16_t x[N];
+  uint32_t seed = 1;
+  for (uint16_t s = 0; s < steps; s++) {
+    float hz = MIN_HZ * powf(MAX_HZ / MIN_HZ, (float)s / (steps - 1));
+    for (uint8_t p = 0; p < PHASES; p++) {
+      synth(hz, 2.0f * (float)M_PI * p / PHASES, noise, pure, x, seed);
+      run(yin, ry, x, hz);
+      run(acf, ra, x, hz);
+    }
+  }
+  printf("# sweep %.0f-%.0fHz, %u steps x %u phases, n=%u fs=%.0f, %s, noise %.0f\n", (double)MIN_HZ, (double)MAX_HZ,
+         (unsigned)steps, (unsigned)PHASES, (unsigned)N, (double)FS, pure ? "pure sine" : "harmonic tone",
+         (double)noise);
+  report(ry);
+  report(ra);
+  return 0;
+}
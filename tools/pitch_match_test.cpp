@@ -0,0 +1,87 @@
+/**
+ * 目标音匹配（GoertzelBank）的主机端测试
+ *
+ * 分析器只武装目标音匹配时（特征需求为空）每次 tick 最多处理 512 个样本，容差较宽时 Goertzel 块只有一百多个样本，
+ * 一次 tick 会跨过多块、产生多个命中。检查：
+ *   - 滤波器组直接连续喂两块目标音，能按顺序取出两个命中，之后为空；偏离两倍容差的音不命中
+ *   - 经分析器驱动时，至少有一次 tick 内产生两个以上命中，且快照的 pitchHits 与滤波器组的累计命中数一致（没有合并或丢失）
+ * 任一检查失败时返回 1。
+ *
+ * 编译（仓库根目录）：
+ *   g++ -O2 -std=gnu++11 -Itools/host -Isrc tools/pitch_match_test.cpp -o pitch_match_test
+ *
+ * 用法：
+ *   pitch_match_test [--tol CENTS]     默认 100（块长约 150 个样本，每次 tick 约 3 块）
+ */
+#include <Arduino.h>
+#include <stdlib.h>
+#include "optimized_audio.hpp"
+
+static const uint32_t FS = 8000;
+static const float TARGET_HZ = 440.0f;
+static unsigned failed = 0;
+
+static void check(bool ok, const char* what) {
+  printf("  %-60s %s\n", what, ok ? "ok" : "FAIL");
+  if (!ok) failed++;
+}
+
+static void pushTone(GoertzelBank& bank, float hz, uint32_t samples) {
+  for (uint32_t i = 0; i < samples; i++) bank.push((int16_t)lroundf(600.0f * sinf(2.0f * (float)M_PI * hz * i / FS)));
+}
+
+static void testBank(float tol) {
+  printf("bank (target %.0fHz, tol %.0f cents)\n", (double)TARGET_HZ, (double)tol);
+  GoertzelBank bank;
+  bank.tune(TARGET_HZ, tol, (float)FS);
+  pushTone(bank, TARGET_HZ, 2u * bank.blockLen());
+  GoertzelBank::Hit a, b, c;
+  bool first = bank.takeHit(a);
+  bool second = bank.takeHit(b);
+  check(first && second && !bank.takeHit(c), "two blocks on target give two hits, then none");
+  check(first && second && a.confidence > 0.5f && b.confidence > 0.5f, "both hits carry their confidence");
+
+  GoertzelBank off;
+  off.tune(TARGET_HZ, tol, (float)FS);
+  pushTone(off, TARGET_HZ * powf(2.0f, 2.0f * tol / 1200.0f), 4u * off.blockLen());
+  check(!off.takeHit(c) && off.hits() == 0, "tone two tolerances away gives no hit");
+}
+
+static void testAnalyzer(float tol) {
+  printf("analyzer (pitch match only, tol %.0f cents)\n", (double)tol);
+  static SyntheticSampleSource src(FS);
+  src.setTone(TARGET_HZ, 600.0f);
+  src.setNoise(20.0f);
+  src.begin();
+  static OptimizedAudioAnalyzer analyzer(0);
+  analyzer.setSource(&src);
+  analyzer.setPitchMatch(true, TARGET_HZ, tol);
+  analyzer.begin();
+
+  uint32_t prev = 0, multi = 0, ticks = 200;
+  AudioFeatures f;
+  for (uint32_t t = 0; t < ticks; t++) {
+    analyzer.tick();
+    analyzer.readFeatures(f);
+    if (f.pitchHits - prev >= 2) multi++;
+    prev = f.pitchHits;
+  }
+  const GoertzelBank& bank = analyzer.pitchMatcher();
+  printf("  %u ticks: blocks=%u bank hits=%u snapshot hits=%u, ticks with >=2 hits=%u, dropped=%u\n", (unsigned)ticks,
+         (unsigned)bank.blocks(), (unsigned)bank.hits(), (unsigned)f.pitchHits, (unsigned)multi,
+         (unsigned)bank.hitsDropped());
+  check(multi > 0, "some ticks cover two or more hits");
+  check(f.pitchHits == bank.hits() && bank.hitsDropped() == 0, "every hit reaches the snapshot count");
+  check(bank.hits() + 1 >= bank.blocks(), "steady target tone hits every block");
+}
+
+int main(int argc, char** argv) {
+  float tol = 100.0f;
+  for (int i = 1; i < argc - 1; i++) {
+    if (strcmp(argv[i], "--tol") == 0) tol = (float)atof(argv[i + 1]);
+  }
+  testBank(tol);
+  testAnalyzer(tol);
+  printf("# %u checks failed\n", failed);
+  return failed ? 1 : 0;
+}